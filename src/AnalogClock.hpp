@@ -0,0 +1,907 @@
+/**
+ * @file AnalogClock.hpp
+ * @author Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Copyright (c) 2026 Daniel Starke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ANALOG_CLOCK_HPP_
+#define _ANALOG_CLOCK_HPP_
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Board independent renderer of the analog clock in RGB565 based on NanoSVG.
+ * The static clock face is rendered once into an optional background cache.
+ * Afterwards, only the screen regions of the moved clock hands are redrawn.
+ * In arena mode the parsed image, the clock hand paths and the rasterizer
+ * buffers are placed into a single region which is sized once at startup.
+ * Alternatively, a constant pre-parsed image can be used without parsing.
+ * Only its shape list and clock hand paths are copied then.
+ * The SVG image needs to provide the shapes `circle` (clock face color) and
+ * `hour`, `min` and `sec` (clock hands pointing to 12 o'clock). The clock hands
+ * are rotated around the center of `circle`.
+ *
+ * The output is passed in bands to a sink with the following interface:
+ * ```cpp
+ * struct Sink {
+ *     size_t capacity() const; // number of pixels per band buffer
+ *     uint16_t * buffer(const size_t band); // band buffer 0 or 1
+ *     void begin(); // called before the first band of a region
+ *     void push(const int x, const int y, const int w, const int h, uint16_t * buf); // called for each band
+ *     void end(); // called after the last band of a region
+ * };
+ * ```
+ * Alternating between two band buffers allows the sink to transfer one band
+ * while the next one is rendered.
+ *
+ * @remarks The NanoSVG implementation (`NANOSVG_IMPLEMENTATION` and `NANOSVGRAST_IMPLEMENTATION`)
+ * needs to be included within the same translation unit before this file.
+ */
+class AnalogClock {
+public:
+	enum {
+		WIDTH = 320, /**< Image width in pixels. */
+		HEIGHT = 240 /**< Image height in pixels. */
+	};
+
+	/**
+	 * Allocates memory for large buffers which are released via `free()`.
+	 *
+	 * @param[in] size - number of bytes to allocate
+	 * @return allocated memory or `NULL` if not available
+	 */
+	typedef void * (*Allocator)(size_t size);
+private:
+	/** SVG shape layers. */
+	enum Layer {
+		LAYER_ALL,     /**< All shapes. */
+		LAYER_STATIC,  /**< Shapes which are not animated (clock face). */
+		LAYER_DYNAMIC  /**< Animated shapes (clock hands). */
+	};
+
+	NSVGimage * img; /**< Parsed SVG data. */
+	NSVGrasterizer * rast; /**< SVG image rasterizer instance. */
+	NSVGpath * pathsHour; /**< Initial paths of the hour clock hand. */
+	NSVGpath * pathsMin; /**< Initial paths of the minute clock hand. */
+	NSVGpath * pathsSec; /**< Initial paths of the seconds clock hand. */
+	uint16_t * bgBuf; /**< Pre-rendered static layer in RGB565 or `NULL` if not available. */
+	void * arenaMem; /**< Memory of `arena` or `NULL` if not used. */
+	NSVGarena arena; /**< Holds the image, clock hand paths and possibly the rasterizer. */
+	Allocator cacheAlloc; /**< Allocator for the clock hand cache or `NULL` if disabled. */
+	bool secVisible; /**< True if the seconds clock hand is shown, else false. */
+	float center[2]; /**< Rotation center of the clock hands. */
+	NSVGshapeEdges * edgesHour[12 * 60]; /**< Pre-flattened edges of the hour clock hand for every minute within 12 hours or `NULL`. */
+	NSVGshapeEdges * edgesMin[60]; /**< Pre-flattened edges of the minute clock hand for every minute or `NULL`. */
+	NSVGshapeEdges * edgesSec[60]; /**< Pre-flattened edges of the seconds clock hand for every full second or `NULL`. */
+	int lastHands[3][4]; /**< Screen regions of the hour, minute and seconds clock hands within the last frame. */
+	int32_t lastPos[3]; /**< Positions of the hour, minute and seconds clock hands within the last frame. */
+	int32_t lastColor; /**< Clock face color of the last frame in RGB565 or -1 if the full image needs to be redrawn. */
+	const char * lastError; /**< Description of the last error or `NULL`. */
+public:
+	/**
+	 * Constructor.
+	 */
+	AnalogClock() noexcept:
+		img(NULL),
+		rast(NULL),
+		pathsHour(NULL),
+		pathsMin(NULL),
+		pathsSec(NULL),
+		bgBuf(NULL),
+		arenaMem(NULL),
+		cacheAlloc(NULL),
+		secVisible(false),
+		lastColor(-1),
+		lastError(NULL)
+	{
+		nsvgArenaInit(&this->arena, NULL, 0);
+		this->center[0] = 0.0f;
+		this->center[1] = 0.0f;
+		memset(this->edgesHour, 0, sizeof(this->edgesHour));
+		memset(this->edgesMin, 0, sizeof(this->edgesMin));
+		memset(this->edgesSec, 0, sizeof(this->edgesSec));
+		memset(this->lastHands, 0, sizeof(this->lastHands));
+		for (size_t i = 0; i < 3; i++) {
+			this->lastPos[i] = -1;
+		}
+	}
+
+	AnalogClock(const AnalogClock &) = delete;
+	AnalogClock & operator= (const AnalogClock &) = delete;
+
+	/**
+	 * Destructor.
+	 */
+	~AnalogClock() noexcept {
+		this->clearCache();
+		free(this->bgBuf);
+		if (this->rast != NULL) {
+			nsvgDeleteRasterizer(this->rast); /* no-op within the arena */
+		}
+		if (this->arenaMem != NULL) {
+			free(this->arenaMem); /* holds all other SVG objects */
+			return;
+		}
+		nsvg__deletePaths(this->pathsHour);
+		nsvg__deletePaths(this->pathsMin);
+		nsvg__deletePaths(this->pathsSec);
+		if (this->img != NULL) {
+			nsvgDelete(this->img);
+		}
+	}
+
+	/**
+	 * Parses the SVG image and allocates all objects needed for rendering.
+	 * This is done once to avoid sporadic issues during memory allocations later on.
+	 *
+	 * @param[in] svg - null-terminated SVG image
+	 * @param[in] bgAlloc - allocator for the background cache or `NULL` to render without
+	 * @param[in] handAlloc - allocator for the pre-flattened clock hand edges or `NULL` to flatten each frame
+	 * @param[in] arenaAlloc - allocator for the arena or `NULL` to allocate all SVG objects separately
+	 * @return true on success, else false (see `error()`)
+	 */
+	bool begin(const char * svg, Allocator bgAlloc = NULL, Allocator handAlloc = NULL, Allocator arenaAlloc = NULL) noexcept {
+		const size_t len = strlen(svg);
+		char * svgStr = static_cast<char *>(malloc(len + 1));
+		if (svgStr == NULL) {
+			return this->fail("Memory exhausted while trying to allocate analog clock data.");
+		}
+		memcpy(svgStr, svg, len + 1);
+		this->img = nsvgParse(svgStr, "px", 96);
+		free(svgStr);
+		if (this->img == NULL) {
+			return this->fail("Failed to parse analog clock data.");
+		}
+		this->pathsHour = this->duplicateShapePaths("hour");
+		if (this->pathsHour == NULL) {
+			return this->fail("Failed to copy SVG paths for hour clock hand.");
+		}
+		this->pathsMin = this->duplicateShapePaths("min");
+		if (this->pathsMin == NULL) {
+			return this->fail("Failed to copy SVG paths for minutes clock hand.");
+		}
+		this->pathsSec = this->duplicateShapePaths("sec");
+		if (this->pathsSec == NULL) {
+			return this->fail("Failed to copy SVG paths for seconds clock hand.");
+		}
+		if (arenaAlloc != NULL) {
+			if ( ! this->moveToArena(arenaAlloc) ) {
+				return false;
+			}
+		} else {
+			this->rast = nsvgCreateRasterizer();
+			if (this->rast == NULL) {
+				return this->fail("Memory exhausted while trying to allocate SVG rasterizer instance.");
+			}
+		}
+		return this->finishBegin(bgAlloc, handAlloc);
+	}
+
+	/**
+	 * Uses the given pre-parsed SVG image and allocates all objects needed for rendering.
+	 * The image is only read and needs to stay valid until destruction. Its shape list
+	 * and clock hand paths are copied into a single allocation as these change while drawing.
+	 *
+	 * @param[in] image - pre-parsed SVG image (e.g. `svgImage` from the generated `SvgImage.hpp`)
+	 * @param[in] bgAlloc - allocator for the background cache or `NULL` to render without
+	 * @param[in] handAlloc - allocator for the pre-flattened clock hand edges or `NULL` to flatten each frame
+	 * @param[in] arenaAlloc - allocator for the shapes and rasterizer or `NULL` to allocate the shapes
+	 * via `malloc()` and the rasterizer separately
+	 * @return true on success, else false (see `error()`)
+	 */
+	bool begin(const NSVGimage & image, Allocator bgAlloc = NULL, Allocator handAlloc = NULL, Allocator arenaAlloc = NULL) noexcept {
+		static const char * const hands[3] = {"hour", "min", "sec"};
+		NSVGpath * paths[3];
+		size_t size = nsvgShapesSize(&image);
+		for (size_t i = 0; i < 3; i++) {
+			const NSVGshape * shape = AnalogClock::findShape(&image, hands[i]);
+			if (shape == NULL) {
+				return this->fail("Failed to find SVG paths for the clock hands.");
+			}
+			paths[i] = shape->paths;
+			size += nsvgPathsSize(paths[i]);
+		}
+		if (arenaAlloc != NULL) {
+			const size_t rastSize = nsvgRasterizerSize(const_cast<NSVGimage *>(&image), 1, WIDTH);
+			if (rastSize == 0) {
+				return this->fail("Memory exhausted while trying to measure the SVG rasterizer.");
+			}
+			size += rastSize;
+		}
+		void * mem = (arenaAlloc != NULL) ? arenaAlloc(size) : malloc(size);
+		if (mem == NULL) {
+			return this->fail("Memory exhausted while trying to allocate analog clock arena.");
+		}
+		this->arenaMem = mem;
+		nsvgArenaInit(&this->arena, mem, size);
+		this->img = nsvgCopyShapes(&image, &this->arena);
+		if (this->img == NULL) {
+			return this->fail("Failed to copy SVG shapes.");
+		}
+		/* draw rotated copies of the clock hands and keep the constant paths as initial paths */
+		for (size_t i = 0; i < 3; i++) {
+			NSVGshape * shape = this->getShape(hands[i]);
+			shape->paths = nsvgCopyPaths(paths[i], &this->arena);
+			if (shape->paths == NULL) {
+				return this->fail("Failed to copy SVG paths for the clock hands.");
+			}
+		}
+		this->pathsHour = paths[0];
+		this->pathsMin = paths[1];
+		this->pathsSec = paths[2];
+		this->rast = (arenaAlloc != NULL) ? nsvgCreateRasterizerInArena(&this->arena, this->img, 1, WIDTH) : nsvgCreateRasterizer();
+		if (this->rast == NULL) {
+			return this->fail("Memory exhausted while trying to allocate SVG rasterizer instance.");
+		}
+		return this->finishBegin(bgAlloc, handAlloc);
+	}
+
+	/**
+	 * Returns the description of the last error.
+	 *
+	 * @return null-terminated error description or `NULL`
+	 */
+	inline const char * error() const noexcept {
+		return this->lastError;
+	}
+
+	/**
+	 * Returns the size of the arena.
+	 *
+	 * @return arena size in bytes or 0 if not used
+	 */
+	inline size_t arenaSize() const noexcept {
+		return this->arena.size;
+	}
+
+	/**
+	 * Returns the number of bytes used within the arena.
+	 *
+	 * @return used arena bytes
+	 */
+	inline size_t arenaUsed() const noexcept {
+		return this->arena.used;
+	}
+
+	/**
+	 * Checks whether the background cache is used.
+	 *
+	 * @return true if used, else false
+	 */
+	inline bool hasBackground() const noexcept {
+		return this->bgBuf != NULL;
+	}
+
+	/**
+	 * Releases all pre-flattened clock hand edges.
+	 */
+	void clearCache() noexcept {
+		for (NSVGshapeEdges *& edges : this->edgesHour) {
+			free(edges);
+			edges = NULL;
+		}
+		for (NSVGshapeEdges *& edges : this->edgesMin) {
+			free(edges);
+			edges = NULL;
+		}
+		for (NSVGshapeEdges *& edges : this->edgesSec) {
+			free(edges);
+			edges = NULL;
+		}
+	}
+
+	/**
+	 * Draws the analog clock.
+	 * Only the regions of the moved clock hands are redrawn unless `full` is
+	 * set or the clock color changed.
+	 *
+	 * @param[in,out] sink - output sink (see `AnalogClock`)
+	 * @param[in] minute - time in minutes since midnight (0..1439)
+	 * @param[in] secPos - position of the seconds clock hand in milliseconds within the minute or -1 to hide it
+	 * @param[in] color - clock face color in RGB565
+	 * @param[in] full - true to redraw the whole image, else false
+	 * @return true on success, false if the rasterizer memory was exhausted (see `error()`)
+	 * @tparam Sink - output sink type
+	 */
+	template <typename Sink>
+	bool draw(Sink & sink, const int minute, const int32_t secPos, const uint16_t color, const bool full) noexcept {
+		const int min = minute % 60;
+		const size_t hourPos = size_t(minute % (12 * 60));
+		const float hourAngle = float(hourPos) * 0.5f;
+		const float minAngle = float(min) * 6.0f;
+		const float secAngle = float(secPos) * 0.006f;
+		const NSVGshapeEdges * hourEdges = NULL;
+		const NSVGshapeEdges * minEdges = NULL;
+		const NSVGshapeEdges * secEdges = NULL;
+		if (this->cacheAlloc != NULL) {
+			if (this->edgesHour[hourPos] == NULL) {
+				this->edgesHour[hourPos] = this->createHandEdges("hour", this->pathsHour, hourAngle);
+			}
+			if (this->edgesMin[min] == NULL) {
+				this->edgesMin[min] = this->createHandEdges("min", this->pathsMin, minAngle);
+			}
+			hourEdges = this->edgesHour[hourPos];
+			minEdges = this->edgesMin[min];
+			if (secPos >= 0 && (secPos % 1000) == 0) {
+				/* only full seconds are cached as the sweeping hand rarely hits the same position twice */
+				const size_t sec = size_t(secPos / 1000);
+				if (this->edgesSec[sec] == NULL) {
+					this->edgesSec[sec] = this->createHandEdges("sec", this->pathsSec, secAngle);
+				}
+				secEdges = this->edgesSec[sec];
+			}
+		}
+		/* adjust angle of clock hands */
+		const int32_t pos[3] = {int32_t(hourPos), int32_t(min), secPos};
+		int hands[3][4];
+		this->setHand("hour", hourAngle, hourEdges, hands[0]);
+		this->setHand("min", minAngle, minEdges, hands[1]);
+		if (this->secVisible != (secPos >= 0)) {
+			this->secVisible = (secPos >= 0);
+			this->selectLayer(LAYER_ALL); /* show or hide the seconds clock hand */
+		}
+		if ( this->secVisible ) {
+			this->setHand("sec", secAngle, secEdges, hands[2]);
+		} else {
+			memset(hands[2], 0, sizeof(hands[2])); /* empty region */
+		}
+		/* set colors */
+		this->setFill("circle", AnalogClock::fromRgb565(color));
+		/* redraw only the regions of the moved clock hands if possible */
+		bool ok = true;
+		if (full || this->lastColor != int32_t(color)) {
+			static const int screen[4] = {0, 0, WIDTH, HEIGHT};
+			ok = this->updateBackground();
+			ok = this->drawRegion(sink, screen) && ok;
+		} else {
+			int dirty[3][4];
+			size_t count = 0;
+			for (size_t i = 0; i < 3; i++) {
+				if (pos[i] == this->lastPos[i]) {
+					continue; /* not moved */
+				}
+				memcpy(dirty[count], hands[i], sizeof(dirty[count]));
+				AnalogClock::regionUnion(dirty[count], this->lastHands[i]);
+				count++;
+			}
+			/* merge overlapping regions to draw each pixel only once */
+			for (size_t i = 0; i < count; i++) {
+				for (size_t j = i + 1; j < count; j++) {
+					if ( AnalogClock::regionOverlaps(dirty[i], dirty[j]) ) {
+						AnalogClock::regionUnion(dirty[i], dirty[j]);
+						count--;
+						memcpy(dirty[j], dirty[count], sizeof(dirty[j]));
+						j = i; /* check the grown region again */
+					}
+				}
+			}
+			for (size_t i = 0; i < count; i++) {
+				ok = this->drawRegion(sink, dirty[i]) && ok;
+			}
+		}
+		memcpy(this->lastHands, hands, sizeof(this->lastHands));
+		memcpy(this->lastPos, pos, sizeof(this->lastPos));
+		this->lastColor = ok ? int32_t(color) : -1; /* redraw everything next time on error */
+		/* restore clock hands angle */
+		this->resetHand("hour", this->pathsHour);
+		this->resetHand("min", this->pathsMin);
+		if ( this->secVisible ) {
+			this->resetHand("sec", this->pathsSec);
+		}
+		if ( ! ok ) {
+			this->fail("Memory exhausted while rasterizing the analog clock.");
+		}
+		return ok;
+	}
+private:
+	/**
+	 * Records the given error.
+	 *
+	 * @param[in] msg - null-terminated error description
+	 * @return false
+	 */
+	inline bool fail(const char * msg) noexcept {
+		this->lastError = msg;
+		return false;
+	}
+
+	/**
+	 * Moves the parsed image and clock hand paths into a newly allocated arena
+	 * which also holds the rasterizer. The arena fits the copied data exactly
+	 * while the rasterizer buffers get 25% headroom over the flattened shapes
+	 * (see `nsvgRasterizerSize()`).
+	 *
+	 * @param[in] arenaAlloc - allocator for the arena
+	 * @return true on success, else false
+	 */
+	bool moveToArena(Allocator arenaAlloc) noexcept {
+		const size_t rastSize = nsvgRasterizerSize(this->img, 1, WIDTH);
+		if (rastSize == 0) {
+			return this->fail("Memory exhausted while trying to measure the SVG rasterizer.");
+		}
+		const size_t size = nsvgImageSize(this->img) + nsvgPathsSize(this->pathsHour) + nsvgPathsSize(this->pathsMin) + nsvgPathsSize(this->pathsSec) + rastSize;
+		void * mem = arenaAlloc(size);
+		if (mem == NULL) {
+			return this->fail("Memory exhausted while trying to allocate analog clock arena.");
+		}
+		NSVGarena newArena;
+		nsvgArenaInit(&newArena, mem, size);
+		NSVGimage * newImg = nsvgCopyImage(this->img, &newArena);
+		NSVGpath * newHour = nsvgCopyPaths(this->pathsHour, &newArena);
+		NSVGpath * newMin = nsvgCopyPaths(this->pathsMin, &newArena);
+		NSVGpath * newSec = nsvgCopyPaths(this->pathsSec, &newArena);
+		NSVGrasterizer * newRast = nsvgCreateRasterizerInArena(&newArena, newImg, 1, WIDTH);
+		if (newImg == NULL || newHour == NULL || newMin == NULL || newSec == NULL || newRast == NULL) {
+			free(mem);
+			return this->fail("Failed to move analog clock data into the arena.");
+		}
+		/* release the separately allocated objects */
+		nsvg__deletePaths(this->pathsHour);
+		nsvg__deletePaths(this->pathsMin);
+		nsvg__deletePaths(this->pathsSec);
+		nsvgDelete(this->img);
+		this->img = newImg;
+		this->pathsHour = newHour;
+		this->pathsMin = newMin;
+		this->pathsSec = newSec;
+		this->rast = newRast;
+		this->arenaMem = mem;
+		this->arena = newArena;
+		return true;
+	}
+
+	/**
+	 * Completes the initialization after the image and rasterizer have been set up.
+	 *
+	 * @param[in] bgAlloc - allocator for the background cache or `NULL` to render without
+	 * @param[in] handAlloc - allocator for the pre-flattened clock hand edges or `NULL` to flatten each frame
+	 * @return true on success, else false
+	 */
+	bool finishBegin(Allocator bgAlloc, Allocator handAlloc) noexcept {
+		const NSVGshape * circle = this->getShape("circle");
+		if (circle == NULL) {
+			return this->fail("Failed to find SVG shape for the clock face.");
+		}
+		this->center[0] = (circle->bounds[0] + circle->bounds[2]) * 0.5f;
+		this->center[1] = (circle->bounds[1] + circle->bounds[3]) * 0.5f;
+		if (bgAlloc != NULL) {
+			this->bgBuf = static_cast<uint16_t *>(bgAlloc(WIDTH * HEIGHT * sizeof(uint16_t)));
+		}
+		this->cacheAlloc = handAlloc;
+		this->selectLayer(LAYER_ALL); /* hide seconds clock hand */
+		this->lastError = NULL;
+		return true;
+	}
+
+	/**
+	 * Returns the SVG shape with the given ID from the passed image.
+	 *
+	 * @param[in] image - SVG image
+	 * @param[in] id - shape ID
+	 * @return shape or `NULL` if not found
+	 */
+	static NSVGshape * findShape(const NSVGimage * image, const char * id) noexcept {
+		NSVGshape * shape;
+		for (shape = image->shapes; shape != NULL; shape = shape->next) {
+			if (strcmp(shape->id, id) == 0) {
+				break;
+			}
+		}
+		return shape;
+	}
+
+	/**
+	 * Returns the SVG shape with the given ID
+	 *
+	 * @param[in] id - shape ID
+	 * @return shape or `NULL` if not found
+	 */
+	inline NSVGshape * getShape(const char * id) const noexcept {
+		return AnalogClock::findShape(this->img, id);
+	}
+
+	/**
+	 * Creates a copy of all paths from the SVG shape of the given ID.
+	 *
+	 * @param[in] id - shape ID
+	 * @return allocated paths or `NULL` on allocation error
+	 */
+	NSVGpath * duplicateShapePaths(const char * id) const noexcept {
+		NSVGshape * shape = this->getShape(id);
+		if (shape == NULL) {
+			return NULL; /* ID not found */
+		}
+		NSVGpath * res = NULL, * ptr = NULL;
+		for (NSVGpath * path = shape->paths; path != NULL; path = path->next) {
+			if (res == NULL) {
+				res = nsvgDuplicatePath(path);
+				ptr = res;
+			} else {
+				ptr->next = nsvgDuplicatePath(path);
+				ptr = ptr->next;
+			}
+			if (ptr == NULL) {
+				nsvg__deletePaths(res);
+				return NULL;
+			}
+		}
+		return res;
+	}
+
+	/**
+	 * Sets the paths for the SVG shape with the given ID to the
+	 * passed path list. Both lists much match in size.
+	 *
+	 * @param[in] id - shape ID
+	 * @param[in] p - path list
+	 * @return true on success, else false
+	 */
+	bool setPaths(const char * id, NSVGpath * p) noexcept {
+		NSVGshape * shape = this->getShape(id);
+		if (shape == NULL) {
+			return false; /* ID not found */
+		}
+		for (NSVGpath * path = shape->paths; path != NULL; path = path->next) {
+			if (p == NULL || p->npts != path->npts) {
+				return false;
+			}
+			memcpy(path->pts, p->pts, size_t(p->npts) * sizeof(float) * 2);
+			memcpy(path->bounds, p->bounds, sizeof(p->bounds));
+			p = p->next;
+		}
+		return p == NULL;
+	}
+
+	/**
+	 * Converts an RGB565 value to an SVG RGBA32 value.
+	 *
+	 * @param[in] val - RGB565 value
+	 * @return SVG RGBA32 value
+	 */
+	static inline uint32_t fromRgb565(const uint32_t val) noexcept {
+		const uint32_t r = (val >> 8) & 0xF8UL;
+		const uint32_t g = (val << 5) & 0xFC00UL;
+		const uint32_t b = (val << 19) & 0xF80000UL;
+		const uint32_t a = 0xFF000000UL;
+		return r | g | b | a;
+	}
+
+	/**
+	 * Sets the fill color of the SVG shape with the given ID.
+	 *
+	 * @param[in] id - shape ID
+	 * @param[in] color - SVG RGBA32 color
+	 * @return true on success, else false
+	 */
+	bool setFill(const char * id, const uint32_t color) noexcept {
+		NSVGshape * shape = this->getShape(id);
+		if (shape == NULL) {
+			return false; /* ID not found */
+		}
+		if (shape->fill.type != NSVG_PAINT_COLOR) {
+			return false; /* not a simple color fill */
+		}
+		shape->fill.color = static_cast<unsigned int>(color);
+		return true;
+	}
+
+	/**
+	 * Transforms the SVG shape of the given ID by the passed angle
+	 * around the clock center.
+	 *
+	 * @param[in] id - shape ID
+	 * @param[in] angle - angle in degrees
+	 * @return true on success, else false
+	 */
+	bool rotateShape(const char * id, float angle) noexcept {
+		NSVGshape * shape = this->getShape(id);
+		if (shape == NULL) {
+			return false; /* ID not found */
+		}
+		/* calculate root transformation matrix */
+		float m[6];
+		float t[6];
+		NSVGpath * path;
+		float bounds[4];
+		float * curve;
+		int i;
+		nsvg__xformIdentity(m);
+		nsvg__xformSetTranslation(t, -this->center[0], -this->center[1]);
+		nsvg__xformMultiply(m, t);
+		nsvg__xformSetRotation(t, angle / 180.0f * NSVG_PI);
+		nsvg__xformMultiply(m, t);
+		nsvg__xformSetTranslation(t, this->center[0], this->center[1]);
+		nsvg__xformMultiply(m, t);
+		/* recalculate shape bounds */
+		for (path = shape->paths; path != NULL; path = path->next) {
+			/* apply transformation to paths */
+			for (i = 0; i < path->npts; i++) {
+				nsvg__xformPoint(&path->pts[i * 2], &path->pts[(i * 2) + 1], path->pts[i * 2], path->pts[(i * 2) + 1], m);
+			}
+			for (i = 0; i < (path->npts - 1); i += 3) {
+				curve = &path->pts[i * 2];
+				nsvg__curveBounds(bounds, curve);
+				if (i == 0) {
+					path->bounds[0] = bounds[0];
+					path->bounds[1] = bounds[1];
+					path->bounds[2] = bounds[2];
+					path->bounds[3] = bounds[3];
+				} else {
+					path->bounds[0] = nsvg__minf(path->bounds[0], bounds[0]);
+					path->bounds[1] = nsvg__minf(path->bounds[1], bounds[1]);
+					path->bounds[2] = nsvg__maxf(path->bounds[2], bounds[2]);
+					path->bounds[3] = nsvg__maxf(path->bounds[3], bounds[3]);
+				}
+			}
+			if (path == shape->paths) {
+				shape->bounds[0] = shape->paths->bounds[0];
+				shape->bounds[1] = shape->paths->bounds[1];
+				shape->bounds[2] = shape->paths->bounds[2];
+				shape->bounds[3] = shape->paths->bounds[3];
+			} else {
+				shape->bounds[0] = nsvg__minf(shape->bounds[0], path->bounds[0]);
+				shape->bounds[1] = nsvg__minf(shape->bounds[1], path->bounds[1]);
+				shape->bounds[2] = nsvg__maxf(shape->bounds[2], path->bounds[2]);
+				shape->bounds[3] = nsvg__maxf(shape->bounds[3], path->bounds[3]);
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Makes only the SVG shapes of the given layer visible.
+	 * The seconds clock hand stays hidden unless `secVisible` is set.
+	 *
+	 * @param[in] layer - layer to show
+	 */
+	void selectLayer(const Layer layer) noexcept {
+		for (NSVGshape * shape = this->img->shapes; shape != NULL; shape = shape->next) {
+			const bool sec = strcmp(shape->id, "sec") == 0;
+			const bool dynamic = sec || strcmp(shape->id, "hour") == 0 || strcmp(shape->id, "min") == 0;
+			if ((layer == LAYER_ALL || dynamic == (layer == LAYER_DYNAMIC)) && (this->secVisible || ( ! sec ))) {
+				shape->flags = static_cast<unsigned char>(shape->flags | NSVG_FLAGS_VISIBLE);
+			} else {
+				shape->flags = static_cast<unsigned char>(shape->flags & ~NSVG_FLAGS_VISIBLE);
+			}
+		}
+	}
+
+	/**
+	 * Renders the static layer of the analog clock into the background cache.
+	 * Needs to be called whenever the clock face changes.
+	 *
+	 * @return true on success, false if the rasterizer memory was exhausted
+	 */
+	bool updateBackground() noexcept {
+		if (this->bgBuf == NULL) {
+			return true; /* no background cache */
+		}
+		this->selectLayer(LAYER_STATIC);
+		const bool res = nsvgRasterizeRegion(this->rast, this->img, 0, 0, 1, reinterpret_cast<unsigned char *>(this->bgBuf), 0, 0, WIDTH, HEIGHT, WIDTH * 2, NSVG_PIXEL_RGB565, 0) != 0;
+		this->selectLayer(LAYER_ALL);
+		return res;
+	}
+
+	/**
+	 * Converts the given bounds into a screen region clamped to the screen.
+	 *
+	 * @param[in] bounds - min x, min y, max x, max y
+	 * @param[in] pad - padding to add on each side
+	 * @param[out] region - x0, y0, x1 (exclusive), y1 (exclusive)
+	 */
+	static void regionFromBounds(const float (&bounds)[4], const float pad, int (&region)[4]) noexcept {
+		const int x0 = int(floorf(bounds[0] - pad));
+		const int y0 = int(floorf(bounds[1] - pad));
+		const int x1 = int(ceilf(bounds[2] + pad)) + 1;
+		const int y1 = int(ceilf(bounds[3] + pad)) + 1;
+		region[0] = (x0 < 0) ? 0 : x0;
+		region[1] = (y0 < 0) ? 0 : y0;
+		region[2] = (x1 > WIDTH) ? int(WIDTH) : x1;
+		region[3] = (y1 > HEIGHT) ? int(HEIGHT) : y1;
+	}
+
+	/**
+	 * Returns the screen region covered by the SVG shape with the given ID.
+	 * This includes the stroke and anti-aliased border. The region is clamped to the screen.
+	 *
+	 * @param[in] id - shape ID
+	 * @param[out] region - x0, y0, x1 (exclusive), y1 (exclusive)
+	 * @return true on success, else false
+	 */
+	bool getShapeRegion(const char * id, int (&region)[4]) const noexcept {
+		NSVGshape * shape = this->getShape(id);
+		if (shape == NULL) {
+			return false; /* ID not found */
+		}
+		float pad = 1.0f; /* anti-aliasing */
+		if (shape->stroke.type != NSVG_PAINT_NONE) {
+			/* miter joins may exceed half the line width up to the miter limit */
+			pad += shape->strokeWidth * 0.5f * nsvg__maxf(shape->miterLimit, 1.5f);
+		}
+		AnalogClock::regionFromBounds(shape->bounds, pad, region);
+		return true;
+	}
+
+	/**
+	 * Creates the pre-flattened edges of the clock hand with the given SVG shape ID
+	 * at the passed angle via `cacheAlloc`.
+	 *
+	 * @param[in] id - shape ID
+	 * @param[in] paths - initial paths of the clock hand
+	 * @param[in] angle - angle in degrees
+	 * @return pre-flattened edges or `NULL` on error
+	 */
+	NSVGshapeEdges * createHandEdges(const char * id, NSVGpath * paths, const float angle) noexcept {
+		NSVGshape * shape = this->getShape(id);
+		if (shape == NULL) {
+			return NULL; /* ID not found */
+		}
+		NSVGshapeEdges edges;
+		NSVGshapeEdges * res = NULL;
+		this->rotateShape(id, angle);
+		if ( nsvgFlattenShapeEdges(this->rast, shape, 0, 0, 1, &edges) ) {
+			const size_t count = size_t(edges.nfill + edges.nstroke);
+			res = static_cast<NSVGshapeEdges *>(this->cacheAlloc(sizeof(NSVGshapeEdges) + (count * sizeof(NSVGedge))));
+			if (res != NULL) {
+				memcpy(res, &edges, sizeof(edges));
+				res->edges = reinterpret_cast<NSVGedge *>(res + 1);
+				memcpy(res->edges, edges.edges, count * sizeof(NSVGedge));
+			}
+		}
+		this->setPaths(id, paths);
+		return res;
+	}
+
+	/**
+	 * Moves the clock hand with the given SVG shape ID to the passed angle.
+	 * The pre-flattened edges of the given hand cache entry are used instead
+	 * of the rotated paths if available.
+	 *
+	 * @param[in] id - shape ID
+	 * @param[in] angle - angle in degrees
+	 * @param[in] edges - pre-flattened edges for this angle or `NULL`
+	 * @param[out] region - screen region covered by the clock hand (see `getShapeRegion()`)
+	 */
+	void setHand(const char * id, const float angle, const NSVGshapeEdges * edges, int (&region)[4]) noexcept {
+		NSVGshape * shape = this->getShape(id);
+		if (shape == NULL) {
+			memset(region, 0, sizeof(region)); /* ID not found */
+			return;
+		}
+		if (edges != NULL && nsvgSetShapeEdges(this->rast, shape, edges)) {
+			AnalogClock::regionFromBounds(edges->bounds, 1.0f, region); /* edges include the stroke */
+		} else {
+			this->rotateShape(id, angle);
+			this->getShapeRegion(id, region);
+		}
+	}
+
+	/**
+	 * Restores the initial position of the clock hand with the given SVG shape ID.
+	 *
+	 * @param[in] id - shape ID
+	 * @param[in] paths - initial paths of the clock hand
+	 */
+	void resetHand(const char * id, NSVGpath * paths) noexcept {
+		NSVGshape * shape = this->getShape(id);
+		if (shape == NULL) {
+			return; /* ID not found */
+		}
+		nsvgSetShapeEdges(this->rast, shape, NULL);
+		this->setPaths(id, paths);
+	}
+
+	/**
+	 * Extends the given screen region to include the passed one.
+	 *
+	 * @param[in,out] region - region to extend
+	 * @param[in] other - region to include
+	 */
+	static inline void regionUnion(int (&region)[4], const int (&other)[4]) noexcept {
+		if (other[0] >= other[2] || other[1] >= other[3]) {
+			return; /* nothing to include */
+		}
+		if (region[0] >= region[2] || region[1] >= region[3]) {
+			memcpy(region, other, sizeof(region));
+			return;
+		}
+		if (other[0] < region[0]) {
+			region[0] = other[0];
+		}
+		if (other[1] < region[1]) {
+			region[1] = other[1];
+		}
+		if (other[2] > region[2]) {
+			region[2] = other[2];
+		}
+		if (other[3] > region[3]) {
+			region[3] = other[3];
+		}
+	}
+
+	/**
+	 * Checks whether the given screen regions overlap.
+	 *
+	 * @param[in] a - first region
+	 * @param[in] b - second region
+	 * @return true if overlapping, else false
+	 */
+	static inline bool regionOverlaps(const int (&a)[4], const int (&b)[4]) noexcept {
+		return a[0] < b[2] && b[0] < a[2] && a[1] < b[3] && b[1] < a[3];
+	}
+
+	/**
+	 * Rasterizes the given screen region and passes it in bands to the sink.
+	 * Narrow regions fit more lines into a band buffer.
+	 *
+	 * @param[in,out] sink - output sink
+	 * @param[in] region - x0, y0, x1 (exclusive), y1 (exclusive)
+	 * @return true on success, false if the rasterizer memory was exhausted
+	 * @tparam Sink - output sink type
+	 */
+	template <typename Sink>
+	bool drawRegion(Sink & sink, const int (&region)[4]) noexcept {
+		const int w = region[2] - region[0];
+		const int h = region[3] - region[1];
+		if (w <= 0 || h <= 0) {
+			return true; /* empty region */
+		}
+		bool res = true;
+		int lines = int(sink.capacity() / size_t(w));
+		if (lines > h) {
+			lines = h;
+		}
+		int flags = 0;
+		if (this->bgBuf != NULL) {
+			/* start from the cached static layer and compose only the clock hands on top */
+			this->selectLayer(LAYER_DYNAMIC);
+			flags = NSVG_RASTER_COMPOSE;
+		}
+		sink.begin();
+		for (int y = region[1], band = 0; y < region[3]; y += lines, band ^= 1) {
+			const int bandLines = (y + lines > region[3]) ? (region[3] - y) : lines;
+			uint16_t * buf = sink.buffer(size_t(band));
+			if (this->bgBuf != NULL) {
+				for (int i = 0; i < bandLines; i++) {
+					memcpy(buf + (i * w), this->bgBuf + ((y + i) * WIDTH) + region[0], size_t(w) * sizeof(uint16_t));
+				}
+			}
+			/* raster SVG */
+			if ( ! nsvgRasterizeRegion(this->rast, this->img, 0, 0, 1, reinterpret_cast<unsigned char *>(buf), region[0], y, w, bandLines, w * 2, NSVG_PIXEL_RGB565, flags) ) {
+				res = false;
+			}
+			sink.push(region[0], y, w, bandLines, buf);
+		}
+		this->selectLayer(LAYER_ALL);
+		sink.end();
+		return res;
+	}
+};
+
+
+#endif /* _ANALOG_CLOCK_HPP_ */
@@ -0,0 +1,321 @@
+/**
+ * @file DigitalClock.hpp
+ * @author Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Copyright (c) 2026 Daniel Starke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _DIGITAL_CLOCK_HPP_
+#define _DIGITAL_CLOCK_HPP_
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Board independent renderer of the digital clock in RGB565 based on NanoSVG.
+ * The glyphs are rasterized anti-aliased once per clock color into a glyph
+ * atlas. Afterwards, only the cells of the changed characters are copied to
+ * the output sink. The time is centered on the screen in the format `HH:MM`.
+ * The SVG image holds the glyphs side by side in cells of `GLYPH_HEIGHT` lines:
+ * `0` to `9` with `DIGIT_WIDTH` pixels followed by `:` with `COLON_WIDTH` pixels.
+ * All shapes are painted in the clock color on black.
+ *
+ * The output is passed in bands to a sink with the same interface as used
+ * by `AnalogClock`.
+ *
+ * @remarks The NanoSVG implementation (`NANOSVG_IMPLEMENTATION` and `NANOSVGRAST_IMPLEMENTATION`)
+ * needs to be included within the same translation unit before this file.
+ */
+class DigitalClock {
+public:
+	enum {
+		WIDTH = 320, /**< Screen width in pixels. */
+		HEIGHT = 240, /**< Screen height in pixels. */
+		DIGIT_WIDTH = 48, /**< Cell width of a digit in pixels. */
+		COLON_WIDTH = 24, /**< Cell width of the colon in pixels. */
+		GLYPH_HEIGHT = 80, /**< Cell height in pixels. */
+		ATLAS_WIDTH = (10 * DIGIT_WIDTH) + COLON_WIDTH, /**< Glyph atlas width in pixels. */
+		CELLS = 5, /**< Number of character cells (`HH:MM`). */
+		TEXT_WIDTH = (4 * DIGIT_WIDTH) + COLON_WIDTH, /**< Width of all character cells in pixels. */
+		TEXT_X = (WIDTH - TEXT_WIDTH) / 2, /**< Left screen coordinate of the first cell. */
+		TEXT_Y = (HEIGHT - GLYPH_HEIGHT) / 2, /**< Top screen coordinate of all cells. */
+		ATLASES = 2 /**< Number of glyph atlases kept (passing and failing color). */
+	};
+
+	/**
+	 * Allocates memory for large buffers which are released via `free()`.
+	 *
+	 * @param[in] size - number of bytes to allocate
+	 * @return allocated memory or `NULL` if not available
+	 */
+	typedef void * (*Allocator)(size_t size);
+private:
+	NSVGimage * img; /**< Copy of the glyph image shapes for coloring. */
+	NSVGrasterizer * rast; /**< SVG image rasterizer instance within `arena`. */
+	void * arenaMem; /**< Memory of `arena` or `NULL` if not allocated. */
+	NSVGarena arena; /**< Holds the image shapes and the rasterizer. */
+	uint16_t * atlas[ATLASES]; /**< Rendered glyph atlases in RGB565. */
+	int32_t atlasColor[ATLASES]; /**< Clock color of each glyph atlas in RGB565 or -1 if not rendered. */
+	size_t lastAtlas; /**< Index of the glyph atlas used last. */
+	char lastText[CELLS]; /**< Characters drawn within the last frame. */
+	int32_t lastColor; /**< Clock color of the last frame in RGB565 or -1 if all cells need to be redrawn. */
+	size_t atlasRenders; /**< Number of glyph atlases rendered. */
+	const char * lastError; /**< Description of the last error or `NULL`. */
+public:
+	/**
+	 * Constructor.
+	 */
+	DigitalClock() noexcept:
+		img(NULL),
+		rast(NULL),
+		arenaMem(NULL),
+		lastAtlas(0),
+		lastColor(-1),
+		atlasRenders(0),
+		lastError(NULL)
+	{
+		nsvgArenaInit(&this->arena, NULL, 0);
+		for (size_t i = 0; i < ATLASES; i++) {
+			this->atlas[i] = NULL;
+			this->atlasColor[i] = -1;
+		}
+		memset(this->lastText, 0, sizeof(this->lastText));
+	}
+
+	DigitalClock(const DigitalClock &) = delete;
+	DigitalClock & operator= (const DigitalClock &) = delete;
+
+	/**
+	 * Destructor.
+	 */
+	~DigitalClock() noexcept {
+		for (uint16_t * buf : this->atlas) {
+			free(buf);
+		}
+		if (this->rast != NULL) {
+			nsvgDeleteRasterizer(this->rast); /* no-op within the arena */
+		}
+		free(this->arenaMem); /* holds all other SVG objects */
+	}
+
+	/**
+	 * Uses the given pre-parsed glyph image and allocates all objects needed for rendering.
+	 * The image is only read and needs to stay valid until destruction.
+	 *
+	 * @param[in] image - pre-parsed glyph image (e.g. `svgDigits` from the generated `SvgDigits.hpp`)
+	 * @param[in] atlasAlloc - allocator for the glyph atlases
+	 * @return true on success, else false (see `error()`)
+	 */
+	bool begin(const NSVGimage & image, Allocator atlasAlloc) noexcept {
+		if (image.width != float(ATLAS_WIDTH) || image.height != float(GLYPH_HEIGHT)) {
+			return this->fail("Unexpected size of the digital clock glyph image.");
+		}
+		const size_t rastSize = nsvgRasterizerSize(const_cast<NSVGimage *>(&image), 1, ATLAS_WIDTH);
+		if (rastSize == 0) {
+			return this->fail("Memory exhausted while trying to measure the SVG rasterizer.");
+		}
+		const size_t size = nsvgShapesSize(&image) + rastSize;
+		this->arenaMem = malloc(size);
+		if (this->arenaMem == NULL) {
+			return this->fail("Memory exhausted while trying to allocate digital clock arena.");
+		}
+		nsvgArenaInit(&this->arena, this->arenaMem, size);
+		this->img = nsvgCopyShapes(&image, &this->arena);
+		if (this->img == NULL) {
+			return this->fail("Failed to copy SVG shapes.");
+		}
+		this->rast = nsvgCreateRasterizerInArena(&this->arena, this->img, 1, ATLAS_WIDTH);
+		if (this->rast == NULL) {
+			return this->fail("Memory exhausted while trying to allocate SVG rasterizer instance.");
+		}
+		for (uint16_t *& buf : this->atlas) {
+			buf = static_cast<uint16_t *>(atlasAlloc(ATLAS_WIDTH * GLYPH_HEIGHT * sizeof(uint16_t)));
+			if (buf == NULL) {
+				return this->fail("Memory exhausted while trying to allocate digital clock glyph atlas.");
+			}
+		}
+		this->lastError = NULL;
+		return true;
+	}
+
+	/**
+	 * Returns the description of the last error.
+	 *
+	 * @return null-terminated error description or `NULL`
+	 */
+	inline const char * error() const noexcept {
+		return this->lastError;
+	}
+
+	/**
+	 * Returns the number of glyph atlases rendered since `begin()`.
+	 *
+	 * @return render count
+	 */
+	inline size_t renders() const noexcept {
+		return this->atlasRenders;
+	}
+
+	/**
+	 * Draws the digital clock.
+	 * Only the cells of the changed characters are redrawn unless `full` is
+	 * set or the clock color changed. Missing and unknown characters are
+	 * drawn as empty cells.
+	 *
+	 * @param[in,out] sink - output sink (see `DigitalClock`)
+	 * @param[in] text - null-terminated time string as `HH:MM` or empty
+	 * @param[in] color - clock color in RGB565
+	 * @param[in] full - true to redraw all cells, else false
+	 * @return true on success, false if the glyph atlas could not be rendered (see `error()`)
+	 * @tparam Sink - output sink type
+	 */
+	template <typename Sink>
+	bool draw(Sink & sink, const char * text, const uint16_t color, const bool full) noexcept {
+		const uint16_t * glyphs = this->getAtlas(color);
+		if (glyphs == NULL) {
+			this->lastColor = -1;
+			return this->fail("Memory exhausted while rasterizing the digital clock glyphs.");
+		}
+		const bool all = full || this->lastColor != int32_t(color);
+		bool end = false;
+		int x = TEXT_X;
+		for (size_t i = 0; i < CELLS; i++) {
+			const char c = end ? 0 : text[i];
+			const int w = (i == 2) ? COLON_WIDTH : DIGIT_WIDTH;
+			end = end || c == 0;
+			if (all || c != this->lastText[i]) {
+				this->drawCell(sink, glyphs, c, x, w);
+				this->lastText[i] = c;
+			}
+			x += w;
+		}
+		this->lastColor = int32_t(color);
+		return true;
+	}
+private:
+	/**
+	 * Records the given error.
+	 *
+	 * @param[in] msg - null-terminated error description
+	 * @return false
+	 */
+	inline bool fail(const char * msg) noexcept {
+		this->lastError = msg;
+		return false;
+	}
+
+	/**
+	 * Converts an RGB565 value to an SVG RGBA32 value.
+	 *
+	 * @param[in] val - RGB565 value
+	 * @return SVG RGBA32 value
+	 */
+	static inline uint32_t fromRgb565(const uint32_t val) noexcept {
+		const uint32_t r = (val >> 8) & 0xF8UL;
+		const uint32_t g = (val << 5) & 0xFC00UL;
+		const uint32_t b = (val << 19) & 0xF80000UL;
+		const uint32_t a = 0xFF000000UL;
+		return r | g | b | a;
+	}
+
+	/**
+	 * Returns the glyph atlas of the given color. The atlas used least
+	 * recently is rendered again in this color if none matches.
+	 *
+	 * @param[in] color - clock color in RGB565
+	 * @return glyph atlas or `NULL` on error
+	 */
+	const uint16_t * getAtlas(const uint16_t color) noexcept {
+		if (this->img == NULL) {
+			return NULL; /* not initialized */
+		}
+		for (size_t i = 0; i < ATLASES; i++) {
+			if (this->atlasColor[i] == int32_t(color)) {
+				this->lastAtlas = i;
+				return this->atlas[i];
+			}
+		}
+		const size_t i = (this->atlasColor[0] < 0) ? 0 : ((this->lastAtlas + 1) % ATLASES);
+		const unsigned int rgba = static_cast<unsigned int>(DigitalClock::fromRgb565(color));
+		for (NSVGshape * shape = this->img->shapes; shape != NULL; shape = shape->next) {
+			if (shape->fill.type == NSVG_PAINT_COLOR) {
+				shape->fill.color = rgba;
+			}
+			if (shape->stroke.type == NSVG_PAINT_COLOR) {
+				shape->stroke.color = rgba;
+			}
+		}
+		this->atlasColor[i] = -1;
+		if ( ! nsvgRasterizeRegion(this->rast, this->img, 0, 0, 1, reinterpret_cast<unsigned char *>(this->atlas[i]), 0, 0, ATLAS_WIDTH, GLYPH_HEIGHT, ATLAS_WIDTH * 2, NSVG_PIXEL_RGB565, 0) ) {
+			return NULL;
+		}
+		this->atlasRenders++;
+		this->atlasColor[i] = int32_t(color);
+		this->lastAtlas = i;
+		return this->atlas[i];
+	}
+
+	/**
+	 * Copies the glyph of the given character into the passed screen cell in
+	 * bands to the sink. The cell is left empty if the glyph does not match.
+	 *
+	 * @param[in,out] sink - output sink
+	 * @param[in] glyphs - glyph atlas
+	 * @param[in] c - character to draw
+	 * @param[in] x - left screen coordinate of the cell
+	 * @param[in] w - cell width in pixels
+	 * @tparam Sink - output sink type
+	 */
+	template <typename Sink>
+	static void drawCell(Sink & sink, const uint16_t * glyphs, const char c, const int x, const int w) noexcept {
+		const uint16_t * glyph = NULL;
+		if (c >= '0' && c <= '9' && w == DIGIT_WIDTH) {
+			glyph = glyphs + ((c - '0') * DIGIT_WIDTH);
+		} else if (c == ':' && w == COLON_WIDTH) {
+			glyph = glyphs + (10 * DIGIT_WIDTH);
+		}
+		int lines = int(sink.capacity() / size_t(w));
+		if (lines > GLYPH_HEIGHT) {
+			lines = GLYPH_HEIGHT;
+		}
+		sink.begin();
+		for (int y = 0, band = 0; y < GLYPH_HEIGHT; y += lines, band ^= 1) {
+			const int bandLines = (y + lines > GLYPH_HEIGHT) ? (GLYPH_HEIGHT - y) : lines;
+			uint16_t * buf = sink.buffer(size_t(band));
+			for (int i = 0; i < bandLines; i++) {
+				if (glyph != NULL) {
+					memcpy(buf + (i * w), glyph + ((y + i) * ATLAS_WIDTH), size_t(w) * sizeof(uint16_t));
+				} else {
+					memset(buf + (i * w), 0, size_t(w) * sizeof(uint16_t));
+				}
+			}
+			sink.push(x, TEXT_Y + y, w, bandLines, buf);
+		}
+		sink.end();
+	}
+};
+
+
+#endif /* _DIGITAL_CLOCK_HPP_ */
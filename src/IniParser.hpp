@@ -2,7 +2,7 @@
  * @file IniParser.hpp
  * @author Daniel Starke
  * @date 2024-04-21
- * @version 2024-05-05
+ * @version 2026-10-14
  *
  * Copyright (c) 2024 Daniel Starke
  *
@@ -30,19 +30,34 @@
 #include <new>
 extern "C" {
 #include <ctype.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 }
 
 
+#ifndef INI_PARSER_CHUNK_SIZE
+/** Number of bytes requested at once from chunk data providers. */
+#define INI_PARSER_CHUNK_SIZE 64
+#endif /* INI_PARSER_CHUNK_SIZE */
+
+
+#ifndef INI_PARSER_MAX_FUNCTION_OBJECT_SIZE
+/** Default number of bytes reserved for the mapping provider function object in `IniParserSized`. */
+#define INI_PARSER_MAX_FUNCTION_OBJECT_SIZE 32
+#endif /* INI_PARSER_MAX_FUNCTION_OBJECT_SIZE */
+
+
 /* forward declaration */
-template <size_t MaxId, size_t N>
+template <size_t MaxId, size_t N = INI_PARSER_MAX_FUNCTION_OBJECT_SIZE>
 class IniParserSized;
 
 
 /**
  * Streaming INI parser.
  * The mapping provider is being used to obtain the parsed values.
+ * This is the common base of `IniParserSized`, which provides the storage.
+ * No heap memory is allocated.
  *
  * Example:
  * ```cpp
@@ -58,7 +73,7 @@ class IniParserSized;
  * 	}
  * 	return true;
  * };
- * IniParser ini(mapping);
+ * IniParserSized<16> ini(mapping);
  * int ch;
  * do {
  * 	ch = Serial.read();
@@ -373,6 +388,408 @@ public:
 			this->val.num.max.i32 = valMax;
 		}
 	};
+
+	/** Value type of a declarative key mapping (see `Mapping`). */
+	enum MappingType {
+		MT_STRING,  /**< Character array. */
+		MT_U32,     /**< Unsigned decimal number. */
+		MT_I32,     /**< Signed decimal number. */
+		MT_HEX_U32, /**< Unsigned hexadecimal number. */
+		MT_HEX_I32  /**< Signed hexadecimal number. */
+	};
+
+	/**
+	 * Returns the hash of the given string.
+	 * This is FNV-1a with 32 bits.
+	 *
+	 * @param[in] str - null-terminated string to hash
+	 * @param[in] hash - initial hash value
+	 * @return hash value
+	 */
+	static constexpr uint32_t hashString(const char * str, const uint32_t hash = 2166136261UL) noexcept {
+		return (*str == 0) ? hash : hashString(str + 1, (hash ^ uint32_t(static_cast<unsigned char>(*str))) * 16777619UL);
+	}
+
+	/**
+	 * Returns the hash of the given group/key pair.
+	 * This is the same as hashing `group.key`.
+	 *
+	 * @param[in] group - null-terminated group string
+	 * @param[in] key - null-terminated key string
+	 * @return hash value
+	 */
+	static constexpr uint32_t hashKey(const char * group, const char * key) noexcept {
+		return hashString(key, (hashString(group) ^ uint32_t('.')) * 16777619UL);
+	}
+
+	/**
+	 * Declarative mapping of an INI group/key pair to a member variable of `T`.
+	 * Use the static factory functions to create constant mapping tables and
+	 * `KeyMap` to use them.
+	 *
+	 * Example:
+	 * ```cpp
+	 * struct Example {
+	 * 	char str[16];
+	 * 	uint32_t num;
+	 * };
+	 * static constexpr IniParser::Mapping<Example> mappings[] = {
+	 * 	IniParser::Mapping<Example>::string("EXAMPLE", "STRING", offsetof(Example, str), sizeof(Example::str)),
+	 * 	IniParser::Mapping<Example>::u32("EXAMPLE", "NUMBER", offsetof(Example, num), 0, 100)
+	 * };
+	 * ```
+	 *
+	 * @tparam T - structure type holding the mapped variables
+	 */
+	template <typename T>
+	struct Mapping {
+		const char * group; /**< INI group. */
+		const char * key; /**< INI key. */
+		uint32_t hash; /**< Hash of group and key (see `hashKey()`). */
+		MappingType type; /**< Value type. */
+		size_t offset; /**< Byte offset of the variable within `T`. */
+		size_t size; /**< Size of the variable in bytes. */
+		uint32_t min; /**< Minimum allowed number value (inclusive). */
+		uint32_t max; /**< Maximum allowed number value (inclusive). */
+		uint32_t flags; /**< User defined flags. */
+		bool (T::* checker)() const; /**< Optional value verification function or `NULL`. */
+
+		/**
+		 * Creates a mapping to a character array.
+		 *
+		 * @param[in] g - INI group
+		 * @param[in] k - INI key
+		 * @param[in] offset - byte offset of the variable within `T`
+		 * @param[in] size - maximum number of characters including null-terminator
+		 * @param[in] flags - user defined flags
+		 * @param[in] checker - optional value verification function
+		 * @return mapping
+		 */
+		static constexpr Mapping string(const char * g, const char * k, const size_t offset, const size_t size,
+			const uint32_t flags = 0, bool (T::* checker)() const = NULL) noexcept {
+			return Mapping{g, k, hashKey(g, k), MT_STRING, offset, size, 0, 0, flags, checker};
+		}
+
+		/**
+		 * Creates a mapping to an unsigned number (`uint32_t`).
+		 *
+		 * @param[in] g - INI group
+		 * @param[in] k - INI key
+		 * @param[in] offset - byte offset of the variable within `T`
+		 * @param[in] valMin - minimum allowed value (inclusive)
+		 * @param[in] valMax - maximum allowed value (inclusive)
+		 * @param[in] flags - user defined flags
+		 * @param[in] checker - optional value verification function
+		 * @return mapping
+		 */
+		static constexpr Mapping u32(const char * g, const char * k, const size_t offset,
+			const uint32_t valMin = 0, const uint32_t valMax = 0xFFFFFFFFUL,
+			const uint32_t flags = 0, bool (T::* checker)() const = NULL) noexcept {
+			return Mapping{g, k, hashKey(g, k), MT_U32, offset, sizeof(uint32_t), valMin, valMax, flags, checker};
+		}
+
+		/**
+		 * Creates a mapping to a signed number (`int32_t`).
+		 *
+		 * @param[in] g - INI group
+		 * @param[in] k - INI key
+		 * @param[in] offset - byte offset of the variable within `T`
+		 * @param[in] valMin - minimum allowed value (inclusive)
+		 * @param[in] valMax - maximum allowed value (inclusive)
+		 * @param[in] flags - user defined flags
+		 * @param[in] checker - optional value verification function
+		 * @return mapping
+		 */
+		static constexpr Mapping i32(const char * g, const char * k, const size_t offset,
+			const int32_t valMin = -0x7FFFFFFFL - 1, const int32_t valMax = 0x7FFFFFFFL,
+			const uint32_t flags = 0, bool (T::* checker)() const = NULL) noexcept {
+			return Mapping{g, k, hashKey(g, k), MT_I32, offset, sizeof(int32_t), uint32_t(valMin), uint32_t(valMax), flags, checker};
+		}
+
+		/**
+		 * Creates a mapping to an unsigned number (`uint32_t`) from hex value.
+		 *
+		 * @param[in] g - INI group
+		 * @param[in] k - INI key
+		 * @param[in] offset - byte offset of the variable within `T`
+		 * @param[in] valMin - minimum allowed value (inclusive)
+		 * @param[in] valMax - maximum allowed value (inclusive)
+		 * @param[in] flags - user defined flags
+		 * @param[in] checker - optional value verification function
+		 * @return mapping
+		 */
+		static constexpr Mapping hexU32(const char * g, const char * k, const size_t offset,
+			const uint32_t valMin = 0, const uint32_t valMax = 0xFFFFFFFFUL,
+			const uint32_t flags = 0, bool (T::* checker)() const = NULL) noexcept {
+			return Mapping{g, k, hashKey(g, k), MT_HEX_U32, offset, sizeof(uint32_t), valMin, valMax, flags, checker};
+		}
+
+		/**
+		 * Creates a mapping to a signed number (`int32_t`) from hex value.
+		 *
+		 * @param[in] g - INI group
+		 * @param[in] k - INI key
+		 * @param[in] offset - byte offset of the variable within `T`
+		 * @param[in] valMin - minimum allowed value (inclusive)
+		 * @param[in] valMax - maximum allowed value (inclusive)
+		 * @param[in] flags - user defined flags
+		 * @param[in] checker - optional value verification function
+		 * @return mapping
+		 */
+		static constexpr Mapping hexI32(const char * g, const char * k, const size_t offset,
+			const int32_t valMin = -0x7FFFFFFFL - 1, const int32_t valMax = 0x7FFFFFFFL,
+			const uint32_t flags = 0, bool (T::* checker)() const = NULL) noexcept {
+			return Mapping{g, k, hashKey(g, k), MT_HEX_I32, offset, sizeof(int32_t), uint32_t(valMin), uint32_t(valMax), flags, checker};
+		}
+	};
+
+	/**
+	 * Hash based lookup of group/key pairs within a constant `Mapping` table.
+	 * Keeps track of the found keys as bitmask in the order of the table.
+	 *
+	 * Example:
+	 * ```cpp
+	 * static const IniParser::KeyMap<Example> keys(mappings);
+	 * Example example;
+	 * uint32_t found = 0;
+	 * const size_t res = iniParseString<16>(str, keys.mapper(example, found));
+	 * ```
+	 *
+	 * @tparam T - structure type holding the mapped variables
+	 */
+	template <typename T>
+	class KeyMap {
+	public:
+		enum {
+			MAX_KEYS = 32 /**< Maximum number of mappings as limited by the found bitmask. */
+		};
+
+		/**
+		 * Mapping provider function object for `IniParser` (see `KeyMap::mapper()`).
+		 */
+		class Mapper {
+			friend class KeyMap;
+		private:
+			const KeyMap * map; /**< Associated key map. */
+			T * obj; /**< Variables to map to. */
+			uint32_t * found; /**< Bitmask of the found keys. */
+			uint32_t mask; /**< Bitmask of the keys to map. */
+			int current; /**< Index of the currently mapped key or -1. */
+
+			/**
+			 * Constructor.
+			 *
+			 * @param[in] m - associated key map
+			 * @param[out] o - variables to map to
+			 * @param[out] f - bitmask of the found keys
+			 * @param[in] msk - bitmask of the keys to map
+			 */
+			inline explicit Mapper(const KeyMap * m, T * o, uint32_t * f, const uint32_t msk) noexcept:
+				map(m),
+				obj(o),
+				found(f),
+				mask(msk),
+				current(-1)
+			{}
+		public:
+			/**
+			 * Maps the current key and verifies its value once parsed.
+			 * Unknown keys are ignored.
+			 *
+			 * @param[in,out] ctx - parsing context
+			 * @param[in] parsed - true if the value has been parsed, false if it needs to be mapped
+			 * @return true on success, else false
+			 */
+			bool operator() (Context & ctx, const bool parsed) noexcept {
+				if ( ! parsed ) {
+					this->current = this->map->find(ctx.group, ctx.key);
+					if (this->current >= 0 && (this->mask & (uint32_t(1) << this->current)) == 0) {
+						this->current = -1; /* ignore excluded key */
+					}
+					if (this->current >= 0) {
+						*(this->found) |= uint32_t(1) << this->current;
+						this->map->map(ctx, *(this->obj), size_t(this->current));
+					}
+					return true;
+				}
+				if (this->current < 0) {
+					return true;
+				}
+				bool (T::* checker)() const = this->map->entries[this->current].checker;
+				return checker == NULL || (this->obj->*checker)();
+			}
+		};
+	private:
+		enum {
+			SLOTS = 2 * MAX_KEYS /**< Number of hash table slots (power of two). */
+		};
+		const Mapping<T> * entries; /**< Mapping table. */
+		size_t count; /**< Number of entries in `entries`. */
+		uint8_t slots[SLOTS]; /**< Hash table with entry index plus one or 0 if unused. */
+	public:
+		/**
+		 * Constructor.
+		 *
+		 * @param[in] m - mapping table which needs to outlive this object
+		 * @tparam N - number of entries in the mapping table
+		 */
+		template <size_t N>
+		explicit KeyMap(const Mapping<T> (& m)[N]) noexcept:
+			entries(m),
+			count(N)
+		{
+			static_assert(N <= MAX_KEYS, "Too many mappings for the found bitmask.");
+			memset(this->slots, 0, sizeof(this->slots));
+			for (size_t i = 0; i < N; i++) {
+				size_t slot = size_t(m[i].hash & (SLOTS - 1));
+				while (this->slots[slot] != 0) {
+					slot = (slot + 1) & (SLOTS - 1);
+				}
+				this->slots[slot] = uint8_t(i + 1);
+			}
+		}
+
+		/**
+		 * Returns the number of mappings.
+		 *
+		 * @return mapping count
+		 */
+		inline size_t size() const noexcept {
+			return this->count;
+		}
+
+		/**
+		 * Returns the mapping at the given index.
+		 *
+		 * @param[in] i - mapping index
+		 * @return mapping
+		 */
+		inline const Mapping<T> & operator[] (const size_t i) const noexcept {
+			return this->entries[i];
+		}
+
+		/**
+		 * Returns the bitmask of all mappings.
+		 *
+		 * @return bitmask
+		 */
+		inline uint32_t all() const noexcept {
+			return (this->count >= 32) ? uint32_t(0xFFFFFFFFUL) : uint32_t((uint32_t(1) << this->count) - 1);
+		}
+
+		/**
+		 * Returns the bitmask of all mappings with any of the given flags.
+		 *
+		 * @param[in] flags - flags to select
+		 * @return bitmask
+		 */
+		uint32_t select(const uint32_t flags) const noexcept {
+			uint32_t res = 0;
+			for (size_t i = 0; i < this->count; i++) {
+				if ((this->entries[i].flags & flags) != 0) {
+					res |= uint32_t(1) << i;
+				}
+			}
+			return res;
+		}
+
+		/**
+		 * Returns the index of the mapping for the given group/key pair.
+		 *
+		 * @param[in] group - null-terminated group string
+		 * @param[in] key - null-terminated key string
+		 * @return mapping index or -1 if not found
+		 */
+		int find(const char * group, const char * key) const noexcept {
+			const uint32_t hash = hashKey(group, key);
+			size_t slot = size_t(hash & (SLOTS - 1));
+			while (this->slots[slot] != 0) {
+				const size_t i = size_t(this->slots[slot] - 1);
+				const Mapping<T> & m = this->entries[i];
+				if (m.hash == hash && strcmp(m.group, group) == 0 && strcmp(m.key, key) == 0) {
+					return int(i);
+				}
+				slot = (slot + 1) & (SLOTS - 1);
+			}
+			return -1;
+		}
+
+		/**
+		 * Maps the variable of the given mapping to the parsing context.
+		 *
+		 * @param[in,out] ctx - parsing context
+		 * @param[out] obj - variables to map to
+		 * @param[in] i - mapping index
+		 */
+		void map(Context & ctx, T & obj, const size_t i) const noexcept {
+			const Mapping<T> & m = this->entries[i];
+			char * var = reinterpret_cast<char *>(&obj) + m.offset;
+			switch (m.type) {
+			case MT_STRING:
+				ctx.mapString(var, m.size);
+				break;
+			case MT_U32:
+				ctx.mapNumber(*reinterpret_cast<uint32_t *>(var), m.min, m.max);
+				break;
+			case MT_I32:
+				ctx.mapNumber(*reinterpret_cast<int32_t *>(var), int32_t(m.min), int32_t(m.max));
+				break;
+			case MT_HEX_U32:
+				ctx.mapHexNumber(*reinterpret_cast<uint32_t *>(var), m.min, m.max);
+				break;
+			case MT_HEX_I32:
+				ctx.mapHexNumber(*reinterpret_cast<int32_t *>(var), int32_t(m.min), int32_t(m.max));
+				break;
+			}
+		}
+
+		/**
+		 * Compares the variable of the given mapping in `a` and `b`.
+		 *
+		 * @param[in] a - variables to compare
+		 * @param[in] b - variables to compare with
+		 * @param[in] i - mapping index
+		 * @return true if equal, else false
+		 */
+		bool equal(const T & a, const T & b, const size_t i) const noexcept {
+			const Mapping<T> & m = this->entries[i];
+			const char * va = reinterpret_cast<const char *>(&a) + m.offset;
+			const char * vb = reinterpret_cast<const char *>(&b) + m.offset;
+			if (m.type == MT_STRING) {
+				return strncmp(va, vb, m.size) == 0;
+			}
+			return memcmp(va, vb, m.size) == 0;
+		}
+
+		/**
+		 * Assigns the variable of the given mapping from `src` to `dst`.
+		 *
+		 * @param[out] dst - variables to assign to
+		 * @param[in] src - variables to assign from
+		 * @param[in] i - mapping index
+		 * @return true if the value changed, else false
+		 */
+		bool assign(T & dst, const T & src, const size_t i) const noexcept {
+			if ( this->equal(dst, src, i) ) {
+				return false;
+			}
+			const Mapping<T> & m = this->entries[i];
+			memcpy(reinterpret_cast<char *>(&dst) + m.offset, reinterpret_cast<const char *>(&src) + m.offset, m.size);
+			return true;
+		}
+
+		/**
+		 * Returns a mapping provider for `IniParser` which maps to the given variables.
+		 *
+		 * @param[out] obj - variables to map to
+		 * @param[out] found - receives the bitmask of the found keys (needs to be initialized)
+		 * @param[in] mask - bitmask of the keys to map, others are ignored
+		 * @return mapping provider function object
+		 */
+		inline Mapper mapper(T & obj, uint32_t & found, const uint32_t mask = 0xFFFFFFFFUL) const noexcept {
+			return Mapper(this, &obj, &found, mask);
+		}
+	};
 private:
 	/* Function object implementation for mapping provider. */
 	struct MappingProviderIf {
@@ -429,7 +846,6 @@ private:
 		}
 	};
 	size_t maxIdLen; /**< Maximum number of characters for group/key strings including the null-terminator. */
-	char * buffer; /**< Heap allocated buffer used to store the current group and key string as well as the mapping provider object. */
 	Context ctx; /**< Paring context. */
 	size_t line; /**< Current line. */
 	size_t idx; /**< Current token string index (i.e. next character offset in output string). */
@@ -439,32 +855,9 @@ private:
 	bool numNeg; /**< True if the number being parsed has a negative sign, else false. */
 	char quote; /**< Value starting quote character or 0 if none. */
 	const MappingProviderIf * mappingProviderIf; /**< Interface to the mapping provider object depending on its type. */
-	char inlineBuffer[1]; /**< Used when `buffer` is not explicitly allocated on heap but part of `IniParser`. */
+	/** Group and key strings followed by the mapping provider object. Extended by `IniParserSized`. */
+	alignas(max_align_t) char buffer[1];
 public:
-	/**
-	 * Constructor.
-	 *
-	 * @param[in] mappingFn - user defined function which maps the values to variables
-	 * @param[in] maxId - maximum number of characters for group and key strings including null-terminator
-	 * @tparam MappingFn - function object with the signature `bool function(IniParser::Context &)` returning true on success, and false otherwise
-	 */
-	template <typename MappingFn, typename DF = typename detail::decay_function<MappingFn>::type>
-	inline explicit IniParser(MappingFn && mappingFn, const size_t maxId = 16):
-		maxIdLen(maxId),
-		buffer(new char[(maxIdLen * 2) + sizeof(DF)]),
-		ctx(buffer, buffer + maxIdLen),
-		line(1),
-		lastCh(-1),
-		quote(0),
-		mappingProviderIf(MappingProviderIf::template get<DF>(mappingFn, ctx))
-	{
-		if (this->buffer != NULL) {
-			const size_t groupKeySize = this->maxIdLen * 2;
-			memset(this->buffer, 0, groupKeySize);
-			new (this->buffer + groupKeySize) DF(detail::forward<MappingFn>(mappingFn));
-		}
-	}
-
 	/**
 	 * Copy constructor.
 	 */
@@ -474,17 +867,12 @@ public:
 	 * Destructor.
 	 */
 	inline ~IniParser() noexcept {
-		if (this->buffer != NULL) {
-			const size_t groupKeySize = this->maxIdLen * 2;
-			this->mappingProviderIf->destroyer(this->buffer + groupKeySize);
-			if (this->buffer != this->inlineBuffer) {
-				delete [] this->buffer;
-			}
-		}
+		this->mappingProviderIf->destroyer(this->buffer + objectOffset(this->maxIdLen));
 	}
 
 	/**
-	 * Resets the parser to start new.
+	 * Resets the parser to start new. This allows to reuse the same instance,
+	 * including its mapping provider, for multiple INI inputs.
 	 * Parsing -1 also resets most of the parser states.
 	 */
 	inline void reset() noexcept {
@@ -580,6 +968,7 @@ public:
 				*(this->ctx.val.str.ptr) = 0;
 			} else if (ch == '=') {
 				this->ctx.st = PST_VALUE;
+				*(this->ctx.val.str.ptr) = 0;
 			} else {
 				goto onError; /* invalid character */
 			}
@@ -596,8 +985,7 @@ public:
 				/* ignore */
 			} else if (isValidStrChar(ch) || isEndOfLineOrInput) {
 				this->ctx.st = PST_IGNORE_VALUE;
-				const size_t groupKeySize = this->maxIdLen * 2;
-				if ( ! this->mappingProviderIf->invoker(this->buffer + groupKeySize, this->ctx, false) ) {
+				if ( ! this->mappingProviderIf->invoker(this->buffer + objectOffset(this->maxIdLen), this->ctx, false) ) {
 					goto onError;
 				}
 				switch (this->ctx.st) {
@@ -699,8 +1087,7 @@ public:
 			}
 			if (newState != this->ctx.st) {
 				this->trimString();
-				const size_t groupKeySize = this->maxIdLen * 2;
-				if ( ! this->mappingProviderIf->invoker(this->buffer + groupKeySize, this->ctx, true) ) {
+				if ( ! this->mappingProviderIf->invoker(this->buffer + objectOffset(this->maxIdLen), this->ctx, true) ) {
 					goto onError;
 				}
 				this->ctx.st = newState;
@@ -792,8 +1179,7 @@ public:
 			const int32_t numI32 = -int32_t(this->num);
 			if (numI32 >= this->ctx.val.num.min.i32 && numI32 <= this->ctx.val.num.max.i32) {
 				this->ctx.val.num.ptr->i32 = numI32;
-				const size_t groupKeySize = this->maxIdLen * 2;
-				if ( ! this->mappingProviderIf->invoker(this->buffer + groupKeySize, this->ctx, true) ) {
+				if ( ! this->mappingProviderIf->invoker(this->buffer + objectOffset(this->maxIdLen), this->ctx, true) ) {
 					goto onError;
 				}
 				this->line += addLine;
@@ -801,8 +1187,7 @@ public:
 			}
 		} else if (this->num >= this->ctx.val.num.min.u32 && this->num <= this->ctx.val.num.max.u32) {
 			this->ctx.val.num.ptr->u32 = this->num; /* same for signed number in our case */
-			const size_t groupKeySize = this->maxIdLen * 2;
-			if ( ! this->mappingProviderIf->invoker(this->buffer + groupKeySize, this->ctx, true) ) {
+			if ( ! this->mappingProviderIf->invoker(this->buffer + objectOffset(this->maxIdLen), this->ctx, true) ) {
 				goto onError;
 			}
 			this->line += addLine;
@@ -814,18 +1199,37 @@ public:
 		return false;
 	}
 
+	/**
+	 * Parses a block of INI data. The data is read as unsigned characters.
+	 * The end of data needs to be signaled separately by parsing -1.
+	 *
+	 * @param[in] data - INI data to parse
+	 * @param[in] len - number of bytes in `data`
+	 * @return true on success, else false on syntax error
+	 */
+	inline bool parse(const char * data, const size_t len) {
+		const unsigned char * ptr = reinterpret_cast<const unsigned char *>(data);
+		const unsigned char * end = ptr + len;
+		for (; ptr < end; ptr++) {
+			if ( ! this->parse(int(*ptr)) ) {
+				return false;
+			}
+		}
+		return true;
+	}
+
 	/**
 	 * Convenience function to parse an INI from string.
 	 *
 	 * @param[in] str - null-terminated INI string to parse
 	 * @param[in] mappingFn - user defined function which maps the values to variables
-	 * @param[in] maxId - maximum number of characters for group and key strings including null-terminator
 	 * @return line number with a syntax error or 0 on success
+	 * @tparam MaxId - maximum number of characters for group and key strings including null-terminator
 	 * @tparam MappingFn - function object with the signature `bool function(IniParser::Context &)` returning true on success, and false otherwise
 	 */
-	template <typename MappingFn>
-	static inline size_t parseString(const char * str, MappingFn && mappingFn, const size_t maxId = 16) {
-		IniParser ini(mappingFn, maxId);
+	template <size_t MaxId = 16, typename MappingFn, typename DF = typename detail::decay_function<MappingFn>::type>
+	static inline size_t parseString(const char * str, MappingFn && mappingFn) {
+		IniParserSized<MaxId, sizeof(DF)> ini(mappingFn);
 		char ch;
 		do {
 			ch = *str++;
@@ -842,13 +1246,13 @@ public:
 	 * @param[in] str - INI string to parse
 	 * @param[in] len - maximum number of bytes in the INI string
 	 * @param[in] mappingFn - user defined function which maps the values to variables
-	 * @param[in] maxId - maximum number of characters for group and key strings including null-terminator
 	 * @return line number with a syntax error or 0 on success
+	 * @tparam MaxId - maximum number of characters for group and key strings including null-terminator
 	 * @tparam MappingFn - function object with the signature `bool function(IniParser::Context &)` returning true on success, and false otherwise
 	 */
-	template <typename MappingFn>
-	static inline size_t parseString(const char * str, const size_t len, MappingFn && mappingFn, const size_t maxId = 16) {
-		IniParser ini(mappingFn, maxId);
+	template <size_t MaxId = 16, typename MappingFn, typename DF = typename detail::decay_function<MappingFn>::type>
+	static inline size_t parseString(const char * str, const size_t len, MappingFn && mappingFn) {
+		IniParserSized<MaxId, sizeof(DF)> ini(mappingFn);
 		for (size_t i = 0; i <= len; i++) {
 			if (*str == 0) {
 				if ( ! ini.parse(-1) ) {
@@ -867,14 +1271,15 @@ public:
 	 *
 	 * @param[in] dataFn - user defined function with feeds the parser with data
 	 * @param[in] mappingFn - user defined function which maps the values to variables
-	 * @param[in] maxId - maximum number of characters for group and key strings including null-terminator
 	 * @return line number with a syntax error or 0 on success
+	 * @tparam MaxId - maximum number of characters for group and key strings including null-terminator
 	 * @tparam DataFn - function object with the signature `int function(void)` returning -1 at the end
 	 * @tparam MappingFn - function object with the signature `bool function(IniParser::Context &)` returning true on success, and false otherwise
 	 */
-	template <typename DataFn, typename MappingFn>
-	static inline size_t parseFn(DataFn && dataFn, MappingFn && mappingFn, const size_t maxId = 16) {
-		IniParser ini(mappingFn, maxId);
+	template <size_t MaxId = 16, typename DataFn, typename MappingFn, typename DF = typename detail::decay_function<MappingFn>::type>
+	static inline auto parseFn(DataFn && dataFn, MappingFn && mappingFn)
+		-> decltype(int(dataFn()), size_t()) {
+		IniParserSized<MaxId, sizeof(DF)> ini(mappingFn);
 		int ch;
 		do {
 			ch = dataFn();
@@ -884,6 +1289,47 @@ public:
 		} while (ch >= 0);
 		return 0;
 	}
+
+	/**
+	 * Convenience function to parse an INI from a chunk data provider function.
+	 * The data is requested in chunks of up to `INI_PARSER_CHUNK_SIZE` bytes.
+	 *
+	 * @param[in] dataFn - user defined function with feeds the parser with data
+	 * @param[in] mappingFn - user defined function which maps the values to variables
+	 * @return line number with a syntax error or 0 on success
+	 * @tparam MaxId - maximum number of characters for group and key strings including null-terminator
+	 * @tparam DataFn - function object with the signature `size_t function(char *, size_t)` returning the number of bytes written or 0 at the end
+	 * @tparam MappingFn - function object with the signature `bool function(IniParser::Context &)` returning true on success, and false otherwise
+	 */
+	template <size_t MaxId = 16, typename DataFn, typename MappingFn, typename DF = typename detail::decay_function<MappingFn>::type>
+	static inline auto parseFn(DataFn && dataFn, MappingFn && mappingFn)
+		-> decltype(size_t(dataFn(static_cast<char *>(NULL), size_t(0))), size_t()) {
+		IniParserSized<MaxId, sizeof(DF)> ini(mappingFn);
+		return ini.parseChunks(dataFn);
+	}
+
+	/**
+	 * Parses all data from the given chunk data provider function until its end.
+	 *
+	 * @param[in] dataFn - user defined function with feeds the parser with data
+	 * @return line number with a syntax error or 0 on success
+	 * @tparam DataFn - function object with the signature `size_t function(char *, size_t)` returning the number of bytes written or 0 at the end
+	 */
+	template <typename DataFn>
+	size_t parseChunks(DataFn && dataFn) {
+		char chunk[INI_PARSER_CHUNK_SIZE];
+		size_t len;
+		do {
+			len = dataFn(chunk, sizeof(chunk));
+			if ( ! this->parse(chunk, len) ) {
+				return this->getLine();
+			}
+		} while (len > 0);
+		if ( ! this->parse(-1) ) {
+			return this->getLine();
+		}
+		return 0;
+	}
 private:
 	/**
 	 * Constructor.
@@ -895,17 +1341,26 @@ private:
 	template <typename Params, typename MappingFn, typename DF = typename detail::decay_function<MappingFn>::type>
 	inline explicit IniParser(Params, MappingFn && mappingFn):
 		maxIdLen(Params::maxId),
-		buffer(inlineBuffer),
-		ctx(buffer, buffer + maxIdLen),
+		ctx(buffer, buffer + Params::maxId),
 		line(1),
 		lastCh(-1),
 		quote(0),
 		mappingProviderIf(MappingProviderIf::template get<DF>(mappingFn, ctx))
 	{
 		static_assert(Params::n >= sizeof(DF), "Provided mapping function is too large for the internal buffer.");
-		const size_t groupKeySize = this->maxIdLen * 2;
-		memset(this->buffer, 0, groupKeySize);
-		new (this->buffer + groupKeySize) DF(detail::forward<MappingFn>(mappingFn));
+		memset(this->buffer, 0, this->maxIdLen * 2);
+		new (this->buffer + objectOffset(this->maxIdLen)) DF(detail::forward<MappingFn>(mappingFn));
+	}
+
+	/**
+	 * Returns the offset of the mapping provider function object within the buffer.
+	 * The group and key strings are stored in front of it.
+	 *
+	 * @param[in] maxId - maximum number of characters for group and key strings including null-terminator
+	 * @return offset in bytes, suitably aligned for any function object
+	 */
+	static constexpr size_t objectOffset(const size_t maxId) noexcept {
+		return ((2 * maxId) + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
 	}
 
 	/**
@@ -945,10 +1400,12 @@ private:
 
 /**
  * Streaming INI parser.
- * Same as `IniParser` but without any heap allocation.
+ * Provides the storage for the group and key strings as well as the mapping provider
+ * function object of `IniParser` inline. One instance can be used for multiple INI
+ * inputs by calling `reset()` in between.
  *
  * @tparam MaxId - maximum number of characters for group and key strings including null-terminator
- * @tparam N - number of bytes to allocate for the mapping provider function object
+ * @tparam N - number of bytes to allocate for the mapping provider function object (checked at compile time)
  */
 template <size_t MaxId, size_t N>
 class IniParserSized : public IniParser {
@@ -963,7 +1420,7 @@ public:
 		static constexpr size_t n = N;
 	};
 private:
-	char extendedBuffer[size_t((2 * MaxId) + N - 1)];
+	char extendedBuffer[objectOffset(MaxId) + N - 1];
 public:
 	/**
 	 * Constructor.
@@ -987,17 +1444,9 @@ public:
  * @tparam MaxId - maximum number of characters for group and key strings including null-terminator
  * @tparam MappingFn - function object with the signature `bool function(IniParser::Context &)` returning true on success, and false otherwise
  */
-template <size_t MaxId, typename MappingFn, typename DF = typename IniParser::detail::decay_function<MappingFn>::type>
+template <size_t MaxId, typename MappingFn>
 static inline size_t iniParseString(const char * str, MappingFn && mappingFn) {
-	IniParserSized<MaxId, sizeof(DF)> ini(mappingFn);
-	char ch;
-	do {
-		ch = *str++;
-		if ( ! ini.parse((ch == 0) ? -1 : int(ch)) ) {
-			return ini.getLine();
-		}
-	} while (ch != 0);
-	return 0;
+	return IniParser::parseString<MaxId>(str, IniParser::detail::forward<MappingFn>(mappingFn));
 }
 
 
@@ -1011,43 +1460,48 @@ static inline size_t iniParseString(const char * str, MappingFn && mappingFn) {
  * @tparam MaxId - maximum number of characters for group and key strings including null-terminator
  * @tparam MappingFn - function object with the signature `bool function(IniParser::Context &)` returning true on success, and false otherwise
  */
-template <size_t MaxId, typename MappingFn, typename DF = typename IniParser::detail::decay_function<MappingFn>::type>
+template <size_t MaxId, typename MappingFn>
 static inline size_t iniParseString(const char * str, const size_t len, MappingFn && mappingFn) {
-	IniParserSized<MaxId, sizeof(DF)> ini(mappingFn);
-	for (size_t i = 0; i <= len; i++) {
-		if (*str == 0) {
-			if ( ! ini.parse(-1) ) {
-				return ini.getLine();
-			}
-			break;
-		} else if ( ! ini.parse((i == len) ? -1 : int(*str++)) ) {
-			return ini.getLine();
-		}
-	}
-	return 0;
+	return IniParser::parseString<MaxId>(str, len, IniParser::detail::forward<MappingFn>(mappingFn));
 }
 
 
 /**
  * Convenience function to parse an INI from a data provider function.
+ * This can either be a character or a chunk data provider (see `IniParser::parseFn()`).
  *
  * @param[in] dataFn - user defined function with feeds the parser with data
  * @param[in] mappingFn - user defined function which maps the values to variables
  * @return line number with a syntax error or 0 on success
  * @tparam MaxId - maximum number of characters for group and key strings including null-terminator
- * @tparam DataFn - function object with the signature `int function(void)` returning -1 at the end
+ * @tparam DataFn - function object with the signature `int function(void)` returning -1 at the end or `size_t function(char *, size_t)` returning the number of bytes written or 0 at the end
+ * @tparam MappingFn - function object with the signature `bool function(IniParser::Context &)` returning true on success, and false otherwise
+ */
+template <size_t MaxId, typename DataFn, typename MappingFn>
+static inline auto iniParseFn(DataFn && dataFn, MappingFn && mappingFn)
+	-> decltype(IniParser::parseFn<MaxId>(dataFn, mappingFn)) {
+	return IniParser::parseFn<MaxId>(IniParser::detail::forward<DataFn>(dataFn), IniParser::detail::forward<MappingFn>(mappingFn));
+}
+
+
+/**
+ * Convenience function to parse an INI from a memory block.
+ * Other than `iniParseString()` this does not stop at null-terminators
+ * and reads the data as unsigned characters.
+ *
+ * @param[in] data - INI data to parse
+ * @param[in] len - number of bytes in `data`
+ * @param[in] mappingFn - user defined function which maps the values to variables
+ * @return line number with a syntax error or 0 on success
+ * @tparam MaxId - maximum number of characters for group and key strings including null-terminator
  * @tparam MappingFn - function object with the signature `bool function(IniParser::Context &)` returning true on success, and false otherwise
  */
-template <size_t MaxId, typename DataFn, typename MappingFn, typename DF = typename IniParser::detail::decay_function<MappingFn>::type>
-static inline size_t iniParseFn(DataFn && dataFn, MappingFn && mappingFn) {
+template <size_t MaxId, typename MappingFn, typename DF = typename IniParser::detail::decay_function<MappingFn>::type>
+static inline size_t iniParseBlock(const char * data, const size_t len, MappingFn && mappingFn) {
 	IniParserSized<MaxId, sizeof(DF)> ini(mappingFn);
-	int ch;
-	do {
-		ch = dataFn();
-		if ( ! ini.parse(ch) ) {
-			return ini.getLine();
-		}
-	} while (ch >= 0);
+	if (( ! ini.parse(data, len) ) || ( ! ini.parse(-1) )) {
+		return ini.getLine();
+	}
 	return 0;
 }
 
@@ -0,0 +1,365 @@
+/**
+ * @file JsonWriter.hpp
+ * @author Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Copyright (c) 2026 Daniel Starke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _JSON_WRITER_HPP_
+#define _JSON_WRITER_HPP_
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * Allocation free JSON writer.
+ * The output is written to a window of the generated document. Bytes before
+ * `offset` and after `offset + size` are only counted. This allows to create
+ * a document in chunks by generating it again for each chunk without
+ * storing the whole document.
+ *
+ * Example:
+ * ```cpp
+ * char buf[64];
+ * JsonWriter json(buf, sizeof(buf));
+ * json.beginObject();
+ * json.key("name").value("value");
+ * json.key("list").beginArray().value(uint32_t(1)).value(true).endArray();
+ * json.endObject();
+ * Serial.write(buf, json.length());
+ * ```
+ */
+class JsonWriter {
+public:
+	enum {
+		MAX_DEPTH = 32 /**< Maximum nesting depth of objects and arrays. */
+	};
+private:
+	char * buf; /**< Output buffer. */
+	size_t size; /**< Size of the output buffer in bytes. */
+	size_t offset; /**< Document offset of the first output buffer byte. */
+	size_t pos; /**< Current document position. */
+	size_t depth; /**< Current nesting depth. */
+	uint32_t hasElement; /**< Bit per nesting depth set if the container has elements. */
+	bool afterKey; /**< True if the next value belongs to the previous key. */
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param[out] b - output buffer (may be `NULL` if `s` is 0)
+	 * @param[in] s - size of the output buffer in bytes
+	 * @param[in] o - document offset of the first output buffer byte
+	 */
+	explicit inline JsonWriter(char * b, const size_t s, const size_t o = 0) noexcept:
+		buf(b),
+		size(s),
+		offset(o),
+		pos(0),
+		depth(0),
+		hasElement(0),
+		afterKey(false)
+	{}
+
+	/**
+	 * Returns the number of bytes written to the output buffer.
+	 *
+	 * @return output length
+	 */
+	inline size_t length() const noexcept {
+		if (this->pos <= this->offset) {
+			return 0;
+		}
+		const size_t len = this->pos - this->offset;
+		return (len < this->size) ? len : this->size;
+	}
+
+	/**
+	 * Returns the length of the whole document generated so far.
+	 *
+	 * @return document length
+	 */
+	inline size_t total() const noexcept {
+		return this->pos;
+	}
+
+	/**
+	 * Starts a new object.
+	 *
+	 * @return this
+	 */
+	inline JsonWriter & beginObject() noexcept {
+		return this->beginContainer('{');
+	}
+
+	/**
+	 * Ends the current object.
+	 *
+	 * @return this
+	 */
+	inline JsonWriter & endObject() noexcept {
+		return this->endContainer('}');
+	}
+
+	/**
+	 * Starts a new array.
+	 *
+	 * @return this
+	 */
+	inline JsonWriter & beginArray() noexcept {
+		return this->beginContainer('[');
+	}
+
+	/**
+	 * Ends the current array.
+	 *
+	 * @return this
+	 */
+	inline JsonWriter & endArray() noexcept {
+		return this->endContainer(']');
+	}
+
+	/**
+	 * Adds a key to the current object. This needs to be followed by a value.
+	 *
+	 * @param[in] str - null-terminated key string
+	 * @return this
+	 */
+	JsonWriter & key(const char * str) noexcept {
+		this->separate();
+		this->putString(str);
+		this->put(':');
+		this->afterKey = true;
+		return *this;
+	}
+
+	/**
+	 * Adds a string value.
+	 *
+	 * @param[in] str - null-terminated string
+	 * @return this
+	 */
+	JsonWriter & value(const char * str) noexcept {
+		this->separate();
+		this->putString(str);
+		return *this;
+	}
+
+	/**
+	 * Adds an unsigned number value.
+	 *
+	 * @param[in] val - number
+	 * @return this
+	 */
+	JsonWriter & value(const uint32_t val) noexcept {
+		this->separate();
+		this->putNumber(val);
+		return *this;
+	}
+
+	/**
+	 * Adds a signed number value.
+	 *
+	 * @param[in] val - number
+	 * @return this
+	 */
+	JsonWriter & value(const int32_t val) noexcept {
+		this->separate();
+		if (val < 0) {
+			this->put('-');
+			this->putNumber(uint32_t(0) - uint32_t(val));
+		} else {
+			this->putNumber(uint32_t(val));
+		}
+		return *this;
+	}
+
+	/**
+	 * Adds a boolean value.
+	 *
+	 * @param[in] val - boolean
+	 * @return this
+	 */
+	JsonWriter & value(const bool val) noexcept {
+		this->separate();
+		this->putRaw(val ? "true" : "false");
+		return *this;
+	}
+
+	/**
+	 * Adds an unsigned number as string value in upper case hexadecimal format.
+	 *
+	 * @param[in] val - number
+	 * @param[in] digits - number of digits (1 to 8)
+	 * @param[in] prefix - null-terminated prefix string (not escaped)
+	 * @return this
+	 */
+	JsonWriter & hexValue(const uint32_t val, const size_t digits, const char * prefix = "") noexcept {
+		static const char hex[] = "0123456789ABCDEF";
+		this->separate();
+		this->put('"');
+		this->putRaw(prefix);
+		for (size_t i = digits; i > 0; i--) {
+			this->put(hex[(val >> (4 * (i - 1))) & 0xF]);
+		}
+		this->put('"');
+		return *this;
+	}
+private:
+	/**
+	 * Outputs a single character.
+	 *
+	 * @param[in] ch - character
+	 */
+	inline void put(const char ch) noexcept {
+		if (this->pos >= this->offset && (this->pos - this->offset) < this->size) {
+			this->buf[this->pos - this->offset] = ch;
+		}
+		this->pos++;
+	}
+
+	/**
+	 * Outputs the given string as is.
+	 *
+	 * @param[in] str - null-terminated string
+	 */
+	inline void putRaw(const char * str) noexcept {
+		for (; *str != 0; str++) {
+			this->put(*str);
+		}
+	}
+
+	/**
+	 * Outputs the given string quoted and escaped.
+	 *
+	 * @param[in] str - null-terminated string
+	 */
+	void putString(const char * str) noexcept {
+		static const char hex[] = "0123456789ABCDEF";
+		this->put('"');
+		for (; *str != 0; str++) {
+			const unsigned char ch = static_cast<unsigned char>(*str);
+			switch (ch) {
+			case '"':
+				this->putRaw("\\\"");
+				break;
+			case '\\':
+				this->putRaw("\\\\");
+				break;
+			case '\b':
+				this->putRaw("\\b");
+				break;
+			case '\f':
+				this->putRaw("\\f");
+				break;
+			case '\n':
+				this->putRaw("\\n");
+				break;
+			case '\r':
+				this->putRaw("\\r");
+				break;
+			case '\t':
+				this->putRaw("\\t");
+				break;
+			default:
+				if (ch < 0x20) {
+					this->putRaw("\\u00");
+					this->put(hex[ch >> 4]);
+					this->put(hex[ch & 0xF]);
+				} else {
+					this->put(char(ch));
+				}
+				break;
+			}
+		}
+		this->put('"');
+	}
+
+	/**
+	 * Outputs the given number in decimal format.
+	 *
+	 * @param[in] val - number
+	 */
+	void putNumber(uint32_t val) noexcept {
+		char digits[10];
+		size_t n = 0;
+		do {
+			digits[n++] = char('0' + (val % 10));
+			val /= 10;
+		} while (val != 0);
+		while (n > 0) {
+			this->put(digits[--n]);
+		}
+	}
+
+	/**
+	 * Outputs the element separator if needed and marks the current container
+	 * as non-empty.
+	 */
+	void separate() noexcept {
+		if ( this->afterKey ) {
+			this->afterKey = false;
+			return;
+		}
+		if (this->depth == 0) {
+			return;
+		}
+		const uint32_t bit = uint32_t(1) << (this->depth - 1);
+		if ((this->hasElement & bit) != 0) {
+			this->put(',');
+		}
+		this->hasElement |= bit;
+	}
+
+	/**
+	 * Starts a new object or array.
+	 *
+	 * @param[in] ch - opening character
+	 * @return this
+	 */
+	JsonWriter & beginContainer(const char ch) noexcept {
+		this->separate();
+		this->put(ch);
+		if (this->depth < MAX_DEPTH) {
+			this->depth++;
+			this->hasElement &= ~(uint32_t(1) << (this->depth - 1));
+		}
+		return *this;
+	}
+
+	/**
+	 * Ends the current object or array.
+	 *
+	 * @param[in] ch - closing character
+	 * @return this
+	 */
+	JsonWriter & endContainer(const char ch) noexcept {
+		if (this->depth > 0) {
+			this->depth--;
+		}
+		this->put(ch);
+		return *this;
+	}
+};
+
+
+#endif /* _JSON_WRITER_HPP_ */
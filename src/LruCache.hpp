@@ -0,0 +1,203 @@
+/**
+ * @file LruCache.hpp
+ * @author Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Copyright (c) 2026 Daniel Starke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _LRU_CACHE_HPP_
+#define _LRU_CACHE_HPP_
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/**
+ * Allocation free cache of a fixed number of objects identified by a string key.
+ * The least recently used object is replaced once all entries are in use.
+ * Replaced objects are destroyed and default constructed again to release
+ * their resources before being handed out for the new key.
+ *
+ * Example:
+ * ```cpp
+ * LruCache<Face, 3, 31> faces;
+ * Face * face = faces.get(name);
+ * if (face == NULL) {
+ *     face = faces.add(name);
+ *     if (face != NULL && ( ! face->load(name) )) {
+ *         faces.remove(name);
+ *         face = NULL;
+ *     }
+ * }
+ * ```
+ *
+ * @tparam T - default constructible object type
+ * @tparam Count - maximum number of cached objects
+ * @tparam KeySize - maximum number of characters of a key
+ */
+template <typename T, size_t Count, size_t KeySize>
+class LruCache {
+public:
+	enum {
+		COUNT = Count, /**< Maximum number of cached objects. */
+		KEY_SIZE = KeySize /**< Maximum number of characters of a key. */
+	};
+private:
+	/** Cache entry. */
+	struct Entry {
+		char key[KeySize + 1]; /**< Null-terminated key or empty if unused. */
+		uint32_t lastUse; /**< Value of `useCounter` at the last access. */
+		T value; /**< Cached object. */
+	};
+
+	Entry entries[Count]; /**< All cache entries. */
+	uint32_t useCounter; /**< Incremented on each access. */
+public:
+	/**
+	 * Constructor.
+	 */
+	LruCache() noexcept:
+		useCounter(0)
+	{
+		for (Entry & entry : this->entries) {
+			entry.key[0] = 0;
+			entry.lastUse = 0;
+		}
+	}
+
+	LruCache(const LruCache &) = delete;
+	LruCache & operator= (const LruCache &) = delete;
+
+	/**
+	 * Returns the cached object of the given key and marks it as most recently used.
+	 *
+	 * @param[in] key - null-terminated key
+	 * @return cached object or `NULL` if not cached
+	 */
+	T * get(const char * key) noexcept {
+		Entry * entry = this->find(key);
+		if (entry == NULL) {
+			return NULL;
+		}
+		entry->lastUse = ++(this->useCounter);
+		return &(entry->value);
+	}
+
+	/**
+	 * Returns a newly constructed object for the given key. This replaces
+	 * the least recently used object if all entries are in use. A cached
+	 * object of the same key is replaced as well.
+	 *
+	 * @param[in] key - null-terminated key
+	 * @return new object or `NULL` if the key is empty or too long
+	 */
+	T * add(const char * key) noexcept {
+		const size_t len = strlen(key);
+		if (len == 0 || len > KeySize) {
+			return NULL;
+		}
+		Entry * entry = this->find(key);
+		if (entry == NULL) {
+			entry = &(this->entries[0]);
+			for (Entry & other : this->entries) {
+				if (other.key[0] == 0) {
+					entry = &other; /* unused */
+					break;
+				}
+				if (other.lastUse < entry->lastUse) {
+					entry = &other;
+				}
+			}
+		}
+		if (entry->key[0] != 0) {
+			LruCache::reset(entry->value);
+		}
+		memcpy(entry->key, key, len + 1);
+		entry->lastUse = ++(this->useCounter);
+		return &(entry->value);
+	}
+
+	/**
+	 * Removes the object of the given key from the cache and releases its resources.
+	 *
+	 * @param[in] key - null-terminated key
+	 * @return true if removed, false if not cached
+	 */
+	bool remove(const char * key) noexcept {
+		Entry * entry = this->find(key);
+		if (entry == NULL) {
+			return false;
+		}
+		LruCache::reset(entry->value);
+		entry->key[0] = 0;
+		entry->lastUse = 0;
+		return true;
+	}
+
+	/**
+	 * Returns the number of cached objects.
+	 *
+	 * @return object count
+	 */
+	size_t size() const noexcept {
+		size_t res = 0;
+		for (const Entry & entry : this->entries) {
+			if (entry.key[0] != 0) {
+				res++;
+			}
+		}
+		return res;
+	}
+private:
+	/**
+	 * Returns the entry of the given key.
+	 *
+	 * @param[in] key - null-terminated key
+	 * @return entry or `NULL` if not found
+	 */
+	Entry * find(const char * key) noexcept {
+		if (key[0] == 0) {
+			return NULL; /* unused entries have empty keys */
+		}
+		for (Entry & entry : this->entries) {
+			if (strcmp(entry.key, key) == 0) {
+				return &entry;
+			}
+		}
+		return NULL;
+	}
+
+	/**
+	 * Destroys the given object and constructs it again.
+	 *
+	 * @param[in,out] value - object to reset
+	 */
+	static inline void reset(T & value) noexcept {
+		value.~T();
+		new (&value) T();
+	}
+};
+
+
+#endif /* _LRU_CACHE_HPP_ */
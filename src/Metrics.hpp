@@ -0,0 +1,256 @@
+/**
+ * @file Metrics.hpp
+ * @author Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Copyright (c) 2026 Daniel Starke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _METRICS_HPP_
+#define _METRICS_HPP_
+#include <stddef.h>
+#include <stdint.h>
+#include "JsonWriter.hpp"
+
+
+/**
+ * Allocation free statistics of a measured value like a duration.
+ * Keeps the number of samples, the overall minimum, maximum and average
+ * as well as a logarithmic histogram. The most recent samples are kept
+ * within a ring to report the minimum, maximum and average of these.
+ *
+ * Histogram bucket 0 counts the value 0. Bucket `i` counts values within
+ * `[2^(i-1), 2^i)`. The last bucket also counts all larger values.
+ *
+ * Example:
+ * ```cpp
+ * Metric<> frameUs;
+ * const uint32_t start = micros();
+ * draw();
+ * frameUs.add(micros() - start);
+ * ```
+ *
+ * @tparam RingSize - number of recent samples to keep
+ * @tparam Buckets - number of histogram buckets (up to 33)
+ */
+template <size_t RingSize = 32, size_t Buckets = 16>
+class Metric {
+public:
+	enum {
+		RING_SIZE = RingSize, /**< Number of recent samples kept. */
+		BUCKETS = Buckets /**< Number of histogram buckets. */
+	};
+private:
+	uint32_t ring[RingSize]; /**< Most recent samples. */
+	size_t ringPos; /**< Next write position within `ring`. */
+	uint32_t samples; /**< Total number of samples. */
+	uint64_t sum; /**< Sum of all samples. */
+	uint32_t minValue; /**< Smallest sample. */
+	uint32_t maxValue; /**< Largest sample. */
+	uint32_t histogram[Buckets]; /**< Number of samples per bucket. */
+public:
+	/**
+	 * Constructor.
+	 */
+	inline Metric() noexcept {
+		this->reset();
+	}
+
+	/**
+	 * Removes all samples.
+	 */
+	void reset() noexcept {
+		for (size_t i = 0; i < RingSize; i++) {
+			this->ring[i] = 0;
+		}
+		for (size_t i = 0; i < Buckets; i++) {
+			this->histogram[i] = 0;
+		}
+		this->ringPos = 0;
+		this->samples = 0;
+		this->sum = 0;
+		this->minValue = 0;
+		this->maxValue = 0;
+	}
+
+	/**
+	 * Adds a sample.
+	 *
+	 * @param[in] val - sample value
+	 */
+	void add(const uint32_t val) noexcept {
+		if (this->samples == 0 || val < this->minValue) {
+			this->minValue = val;
+		}
+		if (this->samples == 0 || val > this->maxValue) {
+			this->maxValue = val;
+		}
+		this->samples++;
+		this->sum += val;
+		this->ring[this->ringPos] = val;
+		this->ringPos = (this->ringPos + 1) % RingSize;
+		this->histogram[Metric::bucketOf(val)]++;
+	}
+
+	/**
+	 * Returns the total number of samples.
+	 *
+	 * @return sample count
+	 */
+	inline uint32_t count() const noexcept {
+		return this->samples;
+	}
+
+	/**
+	 * Returns the smallest sample.
+	 *
+	 * @return minimum or 0 without samples
+	 */
+	inline uint32_t min() const noexcept {
+		return this->minValue;
+	}
+
+	/**
+	 * Returns the largest sample.
+	 *
+	 * @return maximum or 0 without samples
+	 */
+	inline uint32_t max() const noexcept {
+		return this->maxValue;
+	}
+
+	/**
+	 * Returns the average of all samples.
+	 *
+	 * @return average or 0 without samples
+	 */
+	inline uint32_t avg() const noexcept {
+		return (this->samples == 0) ? 0 : uint32_t(this->sum / this->samples);
+	}
+
+	/**
+	 * Returns the number of recent samples within the ring.
+	 *
+	 * @return recent sample count
+	 */
+	inline size_t recentCount() const noexcept {
+		return (this->samples < RingSize) ? size_t(this->samples) : RingSize;
+	}
+
+	/**
+	 * Returns the smallest recent sample.
+	 *
+	 * @return minimum or 0 without samples
+	 */
+	uint32_t recentMin() const noexcept {
+		const size_t n = this->recentCount();
+		uint32_t res = (n > 0) ? this->ring[0] : 0;
+		for (size_t i = 1; i < n; i++) {
+			if (this->ring[i] < res) {
+				res = this->ring[i];
+			}
+		}
+		return res;
+	}
+
+	/**
+	 * Returns the largest recent sample.
+	 *
+	 * @return maximum or 0 without samples
+	 */
+	uint32_t recentMax() const noexcept {
+		const size_t n = this->recentCount();
+		uint32_t res = 0;
+		for (size_t i = 0; i < n; i++) {
+			if (this->ring[i] > res) {
+				res = this->ring[i];
+			}
+		}
+		return res;
+	}
+
+	/**
+	 * Returns the average of the recent samples.
+	 *
+	 * @return average or 0 without samples
+	 */
+	uint32_t recentAvg() const noexcept {
+		const size_t n = this->recentCount();
+		uint64_t res = 0;
+		for (size_t i = 0; i < n; i++) {
+			res += this->ring[i];
+		}
+		return (n == 0) ? 0 : uint32_t(res / n);
+	}
+
+	/**
+	 * Returns the number of samples within the given histogram bucket.
+	 *
+	 * @param[in] i - bucket index
+	 * @return sample count or 0 if out of range
+	 */
+	inline uint32_t bucket(const size_t i) const noexcept {
+		return (i < Buckets) ? this->histogram[i] : 0;
+	}
+
+	/**
+	 * Returns the histogram bucket index for the given value.
+	 *
+	 * @param[in] val - value
+	 * @return bucket index
+	 */
+	static size_t bucketOf(uint32_t val) noexcept {
+		size_t res = 0;
+		while (val != 0 && res < (Buckets - 1)) {
+			val >>= 1;
+			res++;
+		}
+		return res;
+	}
+
+	/**
+	 * Writes the statistics as JSON object.
+	 *
+	 * @param[in,out] json - JSON writer to use
+	 */
+	void toJson(JsonWriter & json) const noexcept {
+		json.beginObject();
+		json.key("count").value(this->samples);
+		json.key("min").value(this->minValue);
+		json.key("avg").value(this->avg());
+		json.key("max").value(this->maxValue);
+		json.key("recent").beginObject();
+		json.key("min").value(this->recentMin());
+		json.key("avg").value(this->recentAvg());
+		json.key("max").value(this->recentMax());
+		json.endObject();
+		json.key("histogram").beginArray();
+		for (size_t i = 0; i < Buckets; i++) {
+			json.value(this->histogram[i]);
+		}
+		json.endArray();
+		json.endObject();
+	}
+};
+
+
+#endif /* _METRICS_HPP_ */
@@ -0,0 +1,284 @@
+/**
+ * @file NtpManager.hpp
+ * @author Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Copyright (c) 2026 Daniel Starke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _NTP_MANAGER_HPP_
+#define _NTP_MANAGER_HPP_
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "JsonWriter.hpp"
+#include "Metrics.hpp"
+
+
+/**
+ * Allocation free NTP synchronization manager. Records the offset and round
+ * trip time of each synchronization and derives the poll interval from them.
+ * The interval is doubled after `STABLE_SYNCS` consecutive synchronizations
+ * with an offset below `DRIFT_US` and halved on larger offsets. Any failed
+ * request resets it to `MIN_INTERVAL`. After `FAILOVER` consecutive failures
+ * the next server of the configured list is used.
+ *
+ * Example:
+ * ```cpp
+ * NtpManager ntp;
+ * ntp.begin("ntp1.example.com,ntp2.example.com");
+ * client.setServer(ntp.server());
+ * client.onSync([] (bool ok, float offset, float delay) {
+ *     if ( ok ) {
+ *         ntp.synced(int32_t(offset * 1e6f), uint32_t(delay * 1e6f));
+ *     } else {
+ *         ntp.failed();
+ *     }
+ *     client.setServer(ntp.server());
+ *     client.setInterval(ntp.interval());
+ * });
+ * ```
+ */
+class NtpManager {
+public:
+	enum {
+		MAX_SERVERS = 3, /**< Maximum number of servers. */
+		LIST_SIZE = 255, /**< Maximum number of characters in the comma separated server list. */
+		MIN_INTERVAL = 64, /**< Shortest poll interval in seconds. */
+		MAX_INTERVAL = 1024, /**< Longest poll interval in seconds. */
+		STABLE_SYNCS = 4, /**< Number of consecutive stable synchronizations before doubling the poll interval. */
+		DRIFT_US = 50000, /**< Offset in microseconds from which on the poll interval is halved. */
+		FAILOVER = 3 /**< Number of consecutive failures before switching to the next server. */
+	};
+private:
+	char names[LIST_SIZE + 1]; /**< Null-terminated server names. */
+	uint16_t nameOffset[MAX_SERVERS]; /**< Offset of each server name within `names`. */
+	uint32_t serverFailures[MAX_SERVERS]; /**< Number of failed requests per server. */
+	size_t serverCount; /**< Number of servers. */
+	size_t current; /**< Index of the current server. */
+	uint32_t pollInterval; /**< Current poll interval in seconds. */
+	uint32_t stableSyncs; /**< Number of consecutive stable synchronizations. */
+	uint32_t failStreak; /**< Number of consecutive failures of the current server. */
+	uint32_t syncCount; /**< Number of successful synchronizations. */
+	uint32_t failCount; /**< Number of failed requests. */
+	uint32_t failovers; /**< Number of server switches due to failures. */
+	int32_t lastOffset; /**< Offset of the last synchronization in microseconds. */
+	uint32_t jitterUs; /**< Moving average of the offset change between synchronizations in microseconds. */
+	Metric<8> offsetUs; /**< Absolute offset per synchronization in microseconds. */
+	Metric<8> delayUs; /**< Round trip time per synchronization in microseconds. */
+public:
+	/**
+	 * Constructor.
+	 */
+	NtpManager() noexcept:
+		serverCount(0),
+		current(0),
+		pollInterval(MIN_INTERVAL),
+		stableSyncs(0),
+		failStreak(0),
+		syncCount(0),
+		failCount(0),
+		failovers(0),
+		lastOffset(0),
+		jitterUs(0)
+	{
+		memset(this->names, 0, sizeof(this->names));
+		memset(this->nameOffset, 0, sizeof(this->nameOffset));
+		memset(this->serverFailures, 0, sizeof(this->serverFailures));
+	}
+
+	/**
+	 * Sets the servers to use and restarts with the first one at the shortest
+	 * poll interval. Recorded statistics are kept. Blanks around each entry
+	 * are removed, empty entries are ignored and entries beyond `MAX_SERVERS`
+	 * are dropped.
+	 *
+	 * @param[in] list - null-terminated comma separated list of server names
+	 * @return number of servers
+	 */
+	size_t begin(const char * list) noexcept {
+		strncpy(this->names, list, LIST_SIZE);
+		this->names[LIST_SIZE] = 0;
+		this->serverCount = 0;
+		char * str = this->names;
+		while (*str != 0 && this->serverCount < MAX_SERVERS) {
+			char * end = strchr(str, ',');
+			if (end != NULL) {
+				*end = 0;
+			}
+			for (char * last = str + strlen(str); last > str && isblank(last[-1]); last--) {
+				last[-1] = 0;
+			}
+			while ( isblank(*str) ) {
+				str++;
+			}
+			if (*str != 0) {
+				this->nameOffset[this->serverCount] = uint16_t(str - this->names);
+				this->serverFailures[this->serverCount] = 0;
+				this->serverCount++;
+			}
+			if (end == NULL) {
+				break;
+			}
+			str = end + 1;
+		}
+		this->current = 0;
+		this->pollInterval = MIN_INTERVAL;
+		this->stableSyncs = 0;
+		this->failStreak = 0;
+		return this->serverCount;
+	}
+
+	/**
+	 * Returns the number of configured servers.
+	 *
+	 * @return server count
+	 */
+	inline size_t servers() const noexcept {
+		return this->serverCount;
+	}
+
+	/**
+	 * Returns the name of the current server.
+	 *
+	 * @return null-terminated server name or an empty string if none was configured
+	 */
+	inline const char * server() const noexcept {
+		return (this->serverCount > 0) ? this->names + this->nameOffset[this->current] : "";
+	}
+
+	/**
+	 * Returns the current poll interval.
+	 *
+	 * @return interval in seconds
+	 */
+	inline uint32_t interval() const noexcept {
+		return this->pollInterval;
+	}
+
+	/**
+	 * Returns the number of successful synchronizations.
+	 *
+	 * @return synchronization count
+	 */
+	inline uint32_t syncs() const noexcept {
+		return this->syncCount;
+	}
+
+	/**
+	 * Returns the number of failed requests.
+	 *
+	 * @return failure count
+	 */
+	inline uint32_t failures() const noexcept {
+		return this->failCount;
+	}
+
+	/**
+	 * Returns the moving average of the offset change between synchronizations.
+	 *
+	 * @return jitter in microseconds
+	 */
+	inline uint32_t jitter() const noexcept {
+		return this->jitterUs;
+	}
+
+	/**
+	 * Records a successful synchronization and adapts the poll interval.
+	 *
+	 * @param[in] offset - clock offset to the server before the synchronization in microseconds
+	 * @param[in] delay - round trip time in microseconds
+	 */
+	void synced(const int32_t offset, const uint32_t delay) noexcept {
+		const uint32_t absOffset = (offset < 0) ? uint32_t(-int64_t(offset)) : uint32_t(offset);
+		if (this->syncCount > 0) {
+			const int64_t change = int64_t(offset) - int64_t(this->lastOffset);
+			const uint32_t absChange = (change < 0) ? uint32_t(-change) : uint32_t(change);
+			this->jitterUs = uint32_t((uint64_t(this->jitterUs) * 3 + absChange) / 4);
+		}
+		this->lastOffset = offset;
+		this->offsetUs.add(absOffset);
+		this->delayUs.add(delay);
+		this->syncCount++;
+		this->failStreak = 0;
+		if (absOffset >= uint32_t(DRIFT_US)) {
+			/* drifted -> poll more often */
+			this->stableSyncs = 0;
+			this->pollInterval = (this->pollInterval / 2 < uint32_t(MIN_INTERVAL)) ? uint32_t(MIN_INTERVAL) : this->pollInterval / 2;
+		} else if (++(this->stableSyncs) >= uint32_t(STABLE_SYNCS)) {
+			/* stable -> back off */
+			this->stableSyncs = 0;
+			this->pollInterval = (this->pollInterval * 2 > uint32_t(MAX_INTERVAL)) ? uint32_t(MAX_INTERVAL) : this->pollInterval * 2;
+		}
+	}
+
+	/**
+	 * Records a failed request. Resets the poll interval and switches to the next
+	 * server after `FAILOVER` consecutive failures.
+	 */
+	void failed() noexcept {
+		this->failCount++;
+		if (this->serverCount > 0) {
+			this->serverFailures[this->current]++;
+		}
+		this->stableSyncs = 0;
+		this->pollInterval = MIN_INTERVAL;
+		if (++(this->failStreak) >= uint32_t(FAILOVER) && this->serverCount > 1) {
+			this->failStreak = 0;
+			this->current = (this->current + 1) % this->serverCount;
+			this->failovers++;
+		}
+	}
+
+	/**
+	 * Writes the statistics as JSON object.
+	 *
+	 * @param[in,out] json - JSON writer to use
+	 */
+	void toJson(JsonWriter & json) const noexcept {
+		json.beginObject();
+		json.key("server").value(this->server());
+		json.key("intervalS").value(this->pollInterval);
+		json.key("syncs").value(this->syncCount);
+		json.key("failures").value(this->failCount);
+		json.key("failovers").value(this->failovers);
+		json.key("lastOffsetUs").value(this->lastOffset);
+		json.key("jitterUs").value(this->jitterUs);
+		json.key("offsetUs");
+		this->offsetUs.toJson(json);
+		json.key("delayUs");
+		this->delayUs.toJson(json);
+		json.key("servers").beginArray();
+		for (size_t i = 0; i < this->serverCount; i++) {
+			json.beginObject();
+			json.key("name").value(this->names + this->nameOffset[i]);
+			json.key("failures").value(this->serverFailures[i]);
+			json.endObject();
+		}
+		json.endArray();
+		json.endObject();
+	}
+};
+
+
+#endif /* _NTP_MANAGER_HPP_ */
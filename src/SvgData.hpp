@@ -2,7 +2,7 @@
  * @file SvgData.hpp
  * @author Daniel Starke
  * @date 2024-05-07
- * @version 2024-05-09
+ * @version 2026-10-14
  *
  * Copyright (c) 2024 Daniel Starke
  *
@@ -44,10 +44,13 @@
  * - remove `stroke` attribute in all child nodes
  * - remove all font and inkscape related styles and attributes
  * - add the IDs to the remaining elements: `back`, `circle`, `nums`, `min`, `hour`
+ * - add the seconds clock hand `sec` as last element (hidden unless enabled)
  * - add these attributes to `nums`, `min` and `hour`: `stroke="#000" stroke-width="1"`
  * - insert SVG `content` as R"svg(content)svg" string literal
  *
  * @remarks The IDs are used for animations in `main.cpp`.
+ * @remarks The firmware uses the constant image compiled from `etc/analog.svg` by `build-pre-svg.py`.
+ * This string is kept for the unit tests to verify the generated `SvgImage.hpp` against NanoSVG.
  */
 static const char * svgData = R"svg(<svg width="320" height="240">
   <path id="back" d="M0 0h320v240H0z"/>
@@ -81,6 +84,7 @@ static const char * svgData = R"svg(<svg width="320" height="240">
   <path id="nums" fill="#fff" stroke="#000" stroke-width="1" d="M166.955.596c-2.11 0-3.823.508-5.06 1.574-1.284 1.105-1.91 3.009-2.014 5.62l-.02.52h4.746l.024-.476c.052-1.085.254-1.903.558-2.453.275-.495.669-.715 1.438-.715.533 0 .915.168 1.27.56l.001.003v.001c.348.379.526.855.526 1.526 0 .857-.285 1.752-.895 2.707-.622.967-1.54 2.081-2.75 3.33l-.011.014-.012.013c-.723.862-1.54 1.74-2.451 2.637-.914.898-1.75 1.719-2.508 2.461l-.15.146v4.743h13.761v-6.614h-4.258v2.59h-3.796c.39-.412.652-.703 1.404-1.455a59.248 59.248 0 0 0 3.072-3.287 19.105 19.105 0 0 0 2.262-3.26l.002-.002c.648-1.189.986-2.358.986-3.496 0-2.1-.547-3.786-1.69-4.955-1.126-1.152-2.643-1.732-4.435-1.732zm-16.217.527-.138.12c-2.06 1.762-3.364 2.833-3.795 3.134l-.213.148v5.217l.806-.623a35.12 35.12 0 0 0 3.12-2.71v12.374h-2.684v4.024h9.883v-4.024h-2.696V1.123h-4.283zM99.053 17.926l-.14.119c-1.602 1.37-2.62 2.207-2.942 2.432l-.215.148v4.344l.806-.625c1.018-.788 1.618-1.363 2.249-1.955v9.273h-2.088v3.352h7.908v-3.352h-2.096V17.926h-3.482zm11.611 0-.14.119c-1.602 1.37-2.62 2.207-2.942 2.432l-.213.148v4.344l.805-.625c1.016-.787 1.617-1.361 2.248-1.953v9.271h-2.088v3.352h7.91v-3.352h-2.098V17.926h-3.482zM71.527 57.082c-1.955 0-3.482.968-4.324 2.738-.818 1.714-1.215 3.795-1.215 6.23 0 2.407.396 4.467 1.215 6.169.844 1.746 2.371 2.699 4.324 2.699 1.38 0 2.562-.452 3.424-1.348.833-.865 1.406-1.971 1.72-3.28v-.003c.315-1.29.47-2.702.47-4.236 0-1.552-.155-2.98-.47-4.281v-.002c-.313-1.326-.885-2.443-1.716-3.315l-.002-.002c-.855-.909-2.04-1.369-3.426-1.369zm-12.433.41-.14.121c-1.602 1.371-2.62 2.205-2.942 2.43l-.215.15v4.342l.807-.623c1.017-.787 1.617-1.363 2.248-1.955v9.272h-2.088v3.351h7.908v-3.35h-2.096V57.492h-3.482zm12.433 2.979c.347 0 .574.087.77.26.195.172.369.461.488.91l.002.002c.258.947.4 2.432.4 4.408 0 1.939-.142 3.402-.4 4.351l-.002.002c-.12.445-.29.73-.486.903-.195.171-.424.26-.772.26-.428 0-.667-.137-.912-.538-.264-.437-.465-1.068-.568-1.892v-.004c-.1-.848-.152-1.876-.152-3.082 0-1.939.147-3.413.412-4.381.129-.46.307-.762.5-.94.193-.177.401-.26.72-.26zm-16.504 48.207c-2.133 0-3.88.62-5.125 1.883-1.263 1.271-1.855 3.194-1.855 5.671 0 2.038.476 3.82 1.441 5.301.978 1.492 2.402 2.301 4.098 2.301 1.031 0 1.903-.171 2.604-.553.294-.159.51-.526.773-.767-.133 1.263-.253 2.563-.506 3.449-.164.576-.405.958-.7 1.201-.293.243-.655.37-1.163.37-.58 0-.905-.158-1.15-.477-.246-.32-.413-.877-.413-1.707v-.5h-4.709l.018.517c.07 1.906.598 3.419 1.64 4.444 1.043 1.024 2.552 1.511 4.426 1.511 2.487 0 4.463-1.062 5.717-3.093 1.254-2.032 1.838-4.972 1.838-8.833 0-2.091-.181-3.906-.553-5.449-.377-1.574-1.076-2.86-2.101-3.81-1.054-.984-2.512-1.46-4.28-1.46zm-.234 3.918c.833 0 1.346.263 1.738.847.393.585.633 1.56.633 2.93 0 1.066-.212 1.938-.615 2.647v.001c-.37.657-.847.93-1.662.93-.83 0-1.32-.266-1.692-.88-.387-.654-.597-1.512-.597-2.604 0-1.069.205-2 .605-2.815.384-.766.84-1.056 1.59-1.056zm11.662 52.486c-.927 0-1.79.183-2.566.55-.79.372-1.428.972-1.885 1.759l-.002.002c-.461.798-.678 1.77-.678 2.892 0 1.045.242 1.938.768 2.617.298.386.845.512 1.299.739-.525.244-1.013.576-1.405 1.076-.638.81-.962 1.793-.962 2.879 0 1.843.458 3.262 1.472 4.119l.002.002c.982.817 2.324 1.201 3.957 1.201 1.737 0 3.127-.428 4.074-1.348.948-.92 1.393-2.281 1.393-3.974 0-1.136-.3-2.117-.926-2.864l-.002-.002c-.395-.474-.92-.801-1.494-1.058.477-.24 1.046-.39 1.36-.785.543-.683.798-1.573.798-2.602 0-1.676-.475-3.023-1.47-3.908-.969-.867-2.243-1.295-3.733-1.295zm0 3.27c.57 0 .894.148 1.125.427.231.28.389.764.389 1.506 0 .726-.155 1.196-.385 1.469-.23.272-.556.42-1.129.42-.558 0-.872-.144-1.097-.416-.226-.272-.381-.746-.381-1.473 0-.743.156-1.23.382-1.51.227-.279.54-.423 1.096-.423zm2.317 5.306.037.03.021.025h-.26c.068-.018.136-.035.202-.055zm-2.317 1.676c.572 0 .897.16 1.156.51.27.363.432.894.432 1.642 0 .768-.163 1.327-.445 1.725h-.002v.002c-.265.374-.582.535-1.14.535-.6 0-.942-.163-1.198-.496-.256-.333-.426-.91-.426-1.766 0-.73.163-1.25.45-1.623h.001c.288-.366.624-.529 1.172-.529zm34.117 29.652v6.114h3.543v-2.797h3.506a142.066 142.066 0 0 0-5.19 13.111l-.224.66h4.127l.11-.35a193.387 193.387 0 0 1 2.445-7.298 74.78 74.78 0 0 1 2.5-6.086l.047-.1v-3.254h-10.864zm59.982 11.791c-2.472 0-4.436 1.07-5.68 3.108-1.246 2.038-1.827 4.99-1.827 8.865 0 2.151.168 3.982.516 5.502l.002.002v.002c.361 1.537 1.045 2.8 2.054 3.742l.002.002c1.04.962 2.493 1.422 4.266 1.422 2.163 0 3.931-.62 5.193-1.881 1.278-1.278 1.881-3.203 1.881-5.674a10.09 10.09 0 0 0-.654-3.597c-.431-1.16-1.072-2.117-1.922-2.84a4.539 4.539 0 0 0-3.01-1.118c-1.377 0-2.476.548-3.41 1.34.156-1.271.307-2.573.572-3.433h-.002c.174-.557.42-.928.717-1.164.297-.237.66-.36 1.162-.36.553 0 .87.15 1.117.47.248.317.424.872.446 1.692l.013.487h4.762l-.039-.535c-.138-1.934-.708-3.46-1.762-4.496-1.054-1.037-2.554-1.536-4.396-1.536zm-.48 11.407c.795 0 1.28.241 1.647.77.367.527.595 1.413.595 2.667 0 1.152-.203 2.13-.595 2.95v.001h-.002c-.361.769-.81 1.06-1.598 1.06-.829 0-1.339-.268-1.734-.876-.396-.609-.637-1.623-.637-3.041 0-1.006.215-1.852.635-2.572.395-.679.886-.96 1.69-.96zm48.686-23.366v10.78h3.724v-.5c0-.52.142-.904.434-1.239.297-.34.572-.466.936-.466.603 0 .897.178 1.14.65.269.522.42 1.214.42 2.094 0 1.033-.173 1.762-.431 2.177-.259.416-.552.577-1.092.577-.535 0-.82-.13-.996-.336-.182-.22-.351-.66-.412-1.342l-.042-.455h-3.79v.5c0 1.534.482 2.81 1.458 3.69l.002.001c.96.86 2.178 1.293 3.561 1.293 1.944 0 3.461-.594 4.373-1.822.879-1.176 1.313-2.636 1.313-4.318a8.836 8.836 0 0 0-.475-2.934v-.002c-.316-.92-.808-1.685-1.475-2.264-.685-.594-1.548-.898-2.506-.898-.977 0-1.759.39-2.418.947v-2.818h6.09v-3.315h-9.814zm44.892-39.361-6.013 9.422v3.709h6.271v.603H252v3.352h7.309v-3.352h-1.532v-.603h1.649v-3.315h-1.649v-9.816h-4.129zm.258 5.387v4.43h-2.71l2.71-4.43zm11.24-62.166a7.726 7.726 0 0 0-3.33.738l-.002.002c-1.054.502-1.915 1.286-2.554 2.32v.002c-.644 1.047-.953 2.33-.953 3.813v.5h4.785l.012-.489c.025-1.044.232-1.772.537-2.199.304-.427.681-.617 1.318-.617.77 0 1.25.197 1.57.553.32.355.52.936.52 1.818 0 .925-.258 1.513-.764 1.924-.506.41-1.335.658-2.533.658h-.5v4.117h.5c1.253 0 2.14.208 2.65.532v.002h.002c.425.266.739.976.739 2.33 0 .902-.216 1.53-.602 1.964-.384.433-.9.653-1.687.653-.72 0-1.15-.206-1.471-.639-.321-.432-.526-1.165-.526-2.224v-.5h-4.738v.5c0 2.365.608 4.173 1.908 5.289l.002.002c1.255 1.068 2.875 1.595 4.778 1.595 2.087 0 3.819-.556 5.111-1.695 1.315-1.153 1.963-2.868 1.963-5.004 0-1.432-.39-2.675-1.178-3.654-.432-.546-.966-.94-1.55-1.237.594-.279 1.128-.65 1.542-1.173.737-.93 1.092-2.13 1.092-3.534 0-2.095-.618-3.746-1.892-4.802-1.234-1.037-2.843-1.545-4.749-1.545zm-11.283-51.426c-1.66 0-3.02.4-4.008 1.25-1.033.89-1.523 2.405-1.605 4.451l-.02.522h3.913l.023-.477c.04-.833.197-1.454.422-1.86.195-.35.448-.5 1.02-.5.387 0 .649.117.906.401v.002l.002.002c.25.272.379.611.379 1.111 0 .642-.213 1.316-.678 2.045-.478.743-1.187 1.607-2.125 2.574l-.012.012-.012.014a29.249 29.249 0 0 1-1.9 2.043c-.71.698-1.36 1.337-1.95 1.914l-.15.146v3.846h10.926v-5.365h-3.535v2.013h-2.578c.292-.304.42-.453.908-.94a46.97 46.97 0 0 0 2.395-2.563 14.98 14.98 0 0 0 1.773-2.555v-.002c.51-.938.781-1.864.781-2.772 0-1.653-.432-2.997-1.345-3.931-.898-.918-2.113-1.381-3.53-1.381zm-41.006-39.326-.138.119c-1.602 1.37-2.621 2.207-2.944 2.432l-.213.148v4.344l.807-.625c1.017-.787 1.616-1.362 2.246-1.953v9.271h-2.086v3.352h7.909v-3.352h-2.096V17.926h-3.485z"/>
   <path id="min" stroke="#fff" stroke-width="1" d="M163.217 145.833h-6.434l-.717-114.984L160 27.4l3.934 3.449z"/>
   <path id="hour" stroke="#fff" stroke-width="1" d="m155.18 140.353 9.64-.092V60.26L160 55l-4.82 5.259z"/>
+  <path id="sec" fill="#d40000" d="M159.25 150h1.5V30h-1.5z"/>
 </svg>)svg";
 
 
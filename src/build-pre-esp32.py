@@ -2,7 +2,7 @@
 @file build-pre-esp32.py
 @author Daniel Starke
 @date 2024-04-20
-@version 2024-05-05
+@version 2026-10-14
 
 Copyright (c) 2024 Daniel Starke
 
@@ -27,6 +27,9 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 """
 
 import configparser
+import gzip
+import hashlib
+import os
 import re
 
 def fromString(val):
@@ -41,6 +44,83 @@ def fromString(val):
 		val = val[1:-1]
 	return val.replace('"', '\\"')
 
+def mimeType(path):
+	"""! Returns the MIME type for the given file.
+	@param path - file path
+	@return MIME type string
+	"""
+	types = {
+		'.css': 'text/css',
+		'.html': 'text/html',
+		'.ico': 'image/x-icon',
+		'.js': 'application/javascript',
+		'.json': 'application/json',
+		'.png': 'image/png',
+		'.svg': 'image/svg+xml',
+		'.txt': 'text/plain'
+	}
+	return types.get(os.path.splitext(path)[1].lower(), 'application/octet-stream')
+
+def embedWebData(src, dst):
+	"""! Embeds all files from the given directory as gzip compressed arrays in a C++ header.
+	The file is only written if its content changed to avoid needless rebuilds.
+	@param src - directory with the web files
+	@param dst - C++ header file to create
+	"""
+	out = [
+		'/* generated by build-pre-esp32.py from ' + src.replace('\\', '/') + ' - do not edit */',
+		'#ifndef _WEBDATA_HPP_',
+		'#define _WEBDATA_HPP_',
+		'',
+		'#include <stddef.h>',
+		'#include <stdint.h>',
+		'#include <pgmspace.h>',
+		'',
+		'',
+		'/** Single gzip compressed web file. */',
+		'struct WebAsset {',
+		'\tconst char * path; /**< Absolute URL path. */',
+		'\tconst char * type; /**< MIME type. */',
+		'\tconst char * etag; /**< Strong entity tag including quotes. */',
+		'\tconst uint8_t * data; /**< gzip compressed file content in flash. */',
+		'\tsize_t size; /**< Number of bytes in `data`. */',
+		'};',
+		''
+	]
+	assets = []
+	for i, name in enumerate(sorted(os.listdir(src))):
+		path = os.path.join(src, name)
+		if not os.path.isfile(path):
+			continue
+		with open(path, 'rb') as f:
+			data = gzip.compress(f.read(), 9, mtime = 0)
+		etag = '\\"' + hashlib.sha1(data).hexdigest()[:16] + '\\"'
+		out.append('')
+		out.append('static const uint8_t webData%u[] PROGMEM = {' % i)
+		for n in range(0, len(data), 16):
+			out.append('\t' + ', '.join('0x%02X' % b for b in data[n:n + 16]) + ',')
+		out.append('};')
+		assets.append('\t{"/%s", "%s", "%s", webData%u, sizeof(webData%u)}' % (name, mimeType(name), etag, i, i))
+	out += [
+		'',
+		'',
+		'static const WebAsset webAssets[] = {',
+		',\n'.join(assets),
+		'};',
+		'',
+		'',
+		'#endif /* _WEBDATA_HPP_ */',
+		''
+	]
+	text = '\n'.join(out)
+	if os.path.isfile(dst):
+		with open(dst, 'r') as f:
+			if f.read() == text:
+				return
+	os.makedirs(os.path.dirname(dst), exist_ok = True)
+	with open(dst, 'w') as f:
+		f.write(text)
+
 if __name__ == 'SCons.Script':
 	Import('env')
 
@@ -63,13 +143,33 @@ if __name__ == 'SCons.Script':
 	assert int(config['NTP']['TIMEOUT'], 0) > 0
 	assert int(config['NTP']['TIMEOUT'], 0) <= 65535
 	assert len(fromString(config['NTP']['SERVER'])) <= 255
-	assert re.match(r'^(([a-zA-Z]([0-9a-zA-Z-]{0,61}[0-9a-zA-Z])?(\.[a-zA-Z]([0-9a-zA-Z-]{0,61}[0-9a-zA-Z])?)*)|(((25[0-5]|(2[0-4]|1\d|[1-9]|)\d)\.?\b){4}))$', fromString(config['NTP']['SERVER']), re.ASCII)
+	ntpServers = [server.strip(' \t') for server in fromString(config['NTP']['SERVER']).split(',')]
+	assert len(ntpServers) >= 1
+	assert len(ntpServers) <= 3 # NtpManager::MAX_SERVERS
+	for server in ntpServers:
+		assert re.match(r'^(([a-zA-Z]([0-9a-zA-Z-]{0,61}[0-9a-zA-Z])?(\.[a-zA-Z]([0-9a-zA-Z-]{0,61}[0-9a-zA-Z])?)*)|(((25[0-5]|(2[0-4]|1\d|[1-9]|)\d)\.?\b){4}))$', server, re.ASCII)
+	if config.has_option('NTP', 'TZ'):
+		assert re.match(r'^[a-zA-Z<][0-9a-zA-Z<>+,./:-]{0,62}$', fromString(config['NTP']['TZ']), re.ASCII)
 	assert int(config['CLOCK']['PASS_COLOR'], 0) > 0
 	assert int(config['CLOCK']['PASS_COLOR'], 0) <= 65535
 	assert int(config['CLOCK']['PASS_COLOR'], 0) > 0
 	assert int(config['CLOCK']['PASS_COLOR'], 0) <= 65535
-	assert re.match(r'^([01][0-9]|2[0-3]):([0-5][0-9]|60)$', fromString(config['CLOCK']['PASS_FROM']), re.ASCII)
-	assert re.match(r'^([01][0-9]|2[0-3]):([0-5][0-9]|60)$', fromString(config['CLOCK']['PASS_TO']), re.ASCII)
+	assert re.match(r'^([01][0-9]|2[0-3]):[0-5][0-9](,([01][0-9]|2[0-3]):[0-5][0-9]){0,3}$', fromString(config['CLOCK']['PASS_FROM']), re.ASCII)
+	assert re.match(r'^([01][0-9]|2[0-3]):[0-5][0-9](,([01][0-9]|2[0-3]):[0-5][0-9]){0,3}$', fromString(config['CLOCK']['PASS_TO']), re.ASCII)
+	assert len(fromString(config['CLOCK']['PASS_FROM']).split(',')) == len(fromString(config['CLOCK']['PASS_TO']).split(','))
+	assert re.match(r'^[0-9a-zA-Z_-]{1,31}$', fromString(config['CLOCK']['TYPE']), re.ASCII) # see faceNameValid() and FACE_NAME_SIZE
+	if config.has_option('CLOCK', 'SECONDS'):
+		assert fromString(config['CLOCK']['SECONDS']) in ('none', 'tick', 'sweep')
+	if config.has_option('CLOCK', 'FPS'):
+		assert int(config['CLOCK']['FPS'], 0) >= 1
+		assert int(config['CLOCK']['FPS'], 0) <= 30
+	if config.has_option('POWER', 'MODE'):
+		assert fromString(config['POWER']['MODE']) in ('none', 'modem', 'light')
+
+	# embed web files as gzip compressed arrays
+	genDir = os.path.join(env.subst('$BUILD_DIR'), 'generated')
+	embedWebData(os.path.join('data', 'web'), os.path.join(genDir, 'WebData.hpp'))
+	env.Append(CPPPATH = [genDir])
 
 	# set OTA parameters from config
 	if env['PIOENV'] == 'ttgo-t4-v13-ota':
@@ -0,0 +1,660 @@
+"""
+@file build-pre-svg.py
+@author Daniel Starke
+@date 2026-10-14
+@version 2026-10-14
+
+Copyright (c) 2026 Daniel Starke
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+Compiles the analog clock and digital clock glyph SVG images into constant
+NanoSVG structures. The parser follows nsvgParse() of `nanosvg.h` step by
+step in single precision to give the same shapes, paths and bounds. Only the
+SVG subset used by these images is supported (no transformations, gradients,
+dashes, units or view box). Unsupported input fails the build.
+
+Usage without PlatformIO: python build-pre-svg.py <svg file> <header file> [<variable name>]
+"""
+
+import math
+import os
+import struct
+import sys
+import xml.etree.ElementTree as ElementTree
+
+def f32(val):
+	"""! Rounds the given value to single precision.
+	@param val - value to round
+	@return rounded value
+	"""
+	return struct.unpack('<f', struct.pack('<f', val))[0]
+
+PI = f32(3.14159265358979323846264338327)
+KAPPA90 = f32(0.5522847493)
+EPSILON = 1e-12
+
+def isCoordinate(item):
+	"""! Checks whether the given path item is a number (see `nsvg__isCoordinate()`).
+	@param item - path item
+	@return True if a number, else False
+	"""
+	if item[:1] in ('-', '+'):
+		item = item[1:]
+	return item[:1].isdigit() or item[:1] == '.'
+
+def parseNumber(s, i):
+	"""! Scans the number at the given position (see `nsvg__parseNumber()`).
+	@param s - input string
+	@param i - start position
+	@return number string, position after the number
+	"""
+	start = i
+	if i < len(s) and s[i] in '-+':
+		i += 1
+	while i < len(s) and s[i].isdigit():
+		i += 1
+	if i < len(s) and s[i] == '.':
+		i += 1
+		while i < len(s) and s[i].isdigit():
+			i += 1
+	if i < len(s) and s[i] in 'eE' and s[i + 1:i + 2] not in ('m', 'x'):
+		i += 1
+		if i < len(s) and s[i] in '-+':
+			i += 1
+		while i < len(s) and s[i].isdigit():
+			i += 1
+	return s[start:i], i
+
+def atof(s):
+	"""! Converts the number string to single precision (see `nsvg__atof()`).
+	@param s - number string
+	@return value
+	"""
+	i = 0
+	sign = 1.0
+	res = 0.0
+	hasPart = False
+	if s[i:i + 1] == '+':
+		i += 1
+	elif s[i:i + 1] == '-':
+		sign = -1.0
+		i += 1
+	n = i
+	while n < len(s) and s[n].isdigit():
+		n += 1
+	if n > i:
+		res = f32(float(int(s[i:n])))
+		hasPart = True
+		i = n
+	if s[i:i + 1] == '.':
+		i += 1
+		n = i
+		while n < len(s) and s[n].isdigit():
+			n += 1
+		if n > i:
+			res = f32(res + f32(f32(float(int(s[i:n]))) / f32(10.0 ** (n - i))))
+			hasPart = True
+			i = n
+	if not hasPart:
+		return 0.0
+	if s[i:i + 1] in ('e', 'E'):
+		exp, n = parseNumber('+' + s[i + 1:].lstrip('+'), 0)
+		if len(exp) > 1:
+			res = f32(res * f32(10.0 ** int(exp)))
+	return f32(res * sign)
+
+def parseCoordinate(s):
+	"""! Parses a coordinate value without unit (see `nsvg__parseCoordinate()`).
+	@param s - coordinate string
+	@return value
+	"""
+	num, i = parseNumber(s.strip(), 0)
+	assert i == len(s.strip()), 'unsupported unit in "%s"' % s
+	return atof(num)
+
+def parseColor(s):
+	"""! Parses a hex color value (see `nsvg__parseColorHex()`).
+	@param s - color string
+	@return RGB value as used by NanoSVG
+	"""
+	s = s.strip()
+	assert s.startswith('#') and len(s) in (4, 7), 'unsupported color "%s"' % s
+	if len(s) == 7:
+		r, g, b = (int(s[n:n + 2], 16) for n in (1, 3, 5))
+	else:
+		r, g, b = (int(s[n], 16) * 17 for n in (1, 2, 3))
+	return r | (g << 8) | (b << 16)
+
+def curveBounds(curve):
+	"""! Returns the tight bounds of the given cubic bezier curve (see `nsvg__curveBounds()`).
+	@param curve - list of 8 values
+	@return [minx, miny, maxx, maxy]
+	"""
+	v0, v1, v2, v3 = curve[0:2], curve[2:4], curve[4:6], curve[6:8]
+	bounds = [min(v0[0], v3[0]), min(v0[1], v3[1]), max(v0[0], v3[0]), max(v0[1], v3[1])]
+	def inBounds(pt):
+		return pt[0] >= bounds[0] and pt[0] <= bounds[2] and pt[1] >= bounds[1] and pt[1] <= bounds[3]
+	if inBounds(v1) and inBounds(v2):
+		return bounds
+	for i in range(2):
+		a = -3.0 * v0[i] + 9.0 * v1[i] - 9.0 * v2[i] + 3.0 * v3[i]
+		b = 6.0 * v0[i] - 12.0 * v1[i] + 6.0 * v2[i]
+		c = 3.0 * v1[i] - 3.0 * v0[i]
+		roots = []
+		if math.fabs(a) < EPSILON:
+			if math.fabs(b) > EPSILON:
+				t = -c / b
+				if t > EPSILON and t < 1.0 - EPSILON:
+					roots.append(t)
+		else:
+			b2ac = b * b - 4.0 * c * a
+			if b2ac > EPSILON:
+				for t in ((-b + math.sqrt(b2ac)) / (2.0 * a), (-b - math.sqrt(b2ac)) / (2.0 * a)):
+					if t > EPSILON and t < 1.0 - EPSILON:
+						roots.append(t)
+		for t in roots:
+			it = 1.0 - t
+			v = f32(it * it * it * v0[i] + 3.0 * it * it * t * v1[i] + 3.0 * it * t * t * v2[i] + t * t * t * v3[i])
+			bounds[i] = v if v < bounds[i] else bounds[i]
+			bounds[2 + i] = v if v > bounds[2 + i] else bounds[2 + i]
+	return bounds
+
+def unionBounds(a, b):
+	"""! Returns the union of both bounds in the same way as NanoSVG.
+	@param a - first bounds
+	@param b - second bounds
+	@return united bounds
+	"""
+	return [
+		a[0] if a[0] < b[0] else b[0],
+		a[1] if a[1] < b[1] else b[1],
+		a[2] if a[2] > b[2] else b[2],
+		a[3] if a[3] > b[3] else b[3]
+	]
+
+class Parser:
+	"""! Reimplements the parts of the NanoSVG parser used by the analog clock. """
+
+	def __init__(self):
+		self.attr = [{
+			'id': '',
+			'fillColor': 0,
+			'strokeColor': 0,
+			'strokeWidth': 1.0,
+			'strokeLineJoin': 'NSVG_JOIN_MITER',
+			'strokeLineCap': 'NSVG_CAP_BUTT',
+			'hasFill': 1,
+			'hasStroke': 0
+		}]
+		self.pts = []
+		self.plist = []
+		self.shapes = []
+
+	def parseAttr(self, name, value):
+		"""! Applies the given presentation attribute (see `nsvg__parseAttr()`).
+		@param name - attribute name
+		@param value - attribute value
+		@return True if handled, else False
+		"""
+		attr = self.attr[-1]
+		if name == 'fill':
+			assert not value.startswith('url('), 'gradients are not supported'
+			attr['hasFill'] = 0 if value == 'none' else 1
+			if value != 'none':
+				attr['fillColor'] = parseColor(value)
+		elif name == 'stroke':
+			assert not value.startswith('url('), 'gradients are not supported'
+			attr['hasStroke'] = 0 if value == 'none' else 1
+			if value != 'none':
+				attr['strokeColor'] = parseColor(value)
+		elif name == 'stroke-width':
+			attr['strokeWidth'] = parseCoordinate(value)
+		elif name == 'stroke-linejoin':
+			assert value in ('miter', 'round', 'bevel'), 'unsupported line join "%s"' % value
+			attr['strokeLineJoin'] = 'NSVG_JOIN_' + value.upper()
+		elif name == 'stroke-linecap':
+			assert value in ('butt', 'round', 'square'), 'unsupported line cap "%s"' % value
+			attr['strokeLineCap'] = 'NSVG_CAP_' + value.upper()
+		elif name == 'id':
+			attr['id'] = value[:63]
+		else:
+			assert name not in ('style', 'transform', 'display', 'opacity', 'fill-opacity', 'stroke-opacity', 'stroke-miterlimit', 'stroke-dasharray', 'stroke-dashoffset', 'fill-rule'), 'unsupported attribute "%s"' % name
+			return False
+		return True
+
+	def moveTo(self, x, y):
+		"""! Starts a new sub-path (see `nsvg__moveTo()`). """
+		if self.pts:
+			self.pts[-1] = (x, y)
+		else:
+			self.pts.append((x, y))
+
+	def lineTo(self, x, y):
+		"""! Adds a line as cubic bezier curve (see `nsvg__lineTo()`). """
+		if self.pts:
+			px, py = self.pts[-1]
+			dx = f32(x - px)
+			dy = f32(y - py)
+			self.pts.append((f32(px + f32(dx / 3.0)), f32(py + f32(dy / 3.0))))
+			self.pts.append((f32(x - f32(dx / 3.0)), f32(y - f32(dy / 3.0))))
+			self.pts.append((x, y))
+
+	def cubicBezTo(self, cpx1, cpy1, cpx2, cpy2, x, y):
+		"""! Adds a cubic bezier curve (see `nsvg__cubicBezTo()`). """
+		if self.pts:
+			self.pts += [(cpx1, cpy1), (cpx2, cpy2), (x, y)]
+
+	def arcTo(self, cp, args, rel):
+		"""! Approximates an elliptic arc with cubic bezier curves (see `nsvg__pathArcTo()`).
+		@param cp - current point as list
+		@param args - arc arguments
+		@param rel - True if relative
+		"""
+		def vmag(x, y):
+			return f32(math.sqrt(f32(f32(x * x) + f32(y * y))))
+		def vecang(ux, uy, vx, vy):
+			r = f32(f32(f32(ux * vx) + f32(uy * vy)) / f32(vmag(ux, uy) * vmag(vx, vy)))
+			r = max(-1.0, min(1.0, r))
+			return f32((-1.0 if f32(ux * vy) < f32(uy * vx) else 1.0) * f32(math.acos(r)))
+		def sqr(x):
+			return f32(x * x)
+		rx = math.fabs(args[0])
+		ry = math.fabs(args[1])
+		rotx = f32(f32(args[2] / 180.0) * PI)
+		fa = 1 if math.fabs(args[3]) > 1e-6 else 0
+		fs = 1 if math.fabs(args[4]) > 1e-6 else 0
+		x1, y1 = cp
+		if rel:
+			x2 = f32(cp[0] + args[5])
+			y2 = f32(cp[1] + args[6])
+		else:
+			x2, y2 = args[5], args[6]
+		dx = f32(x1 - x2)
+		dy = f32(y1 - y2)
+		d = f32(math.sqrt(f32(f32(dx * dx) + f32(dy * dy))))
+		if d < f32(1e-6) or rx < f32(1e-6) or ry < f32(1e-6):
+			self.lineTo(x2, y2)
+			cp[0], cp[1] = x2, y2
+			return
+		sinrx = f32(math.sin(rotx))
+		cosrx = f32(math.cos(rotx))
+		x1p = f32(f32(f32(cosrx * dx) / 2.0) + f32(f32(sinrx * dy) / 2.0))
+		y1p = f32(f32(f32(-sinrx * dx) / 2.0) + f32(f32(cosrx * dy) / 2.0))
+		d = f32(f32(sqr(x1p) / sqr(rx)) + f32(sqr(y1p) / sqr(ry)))
+		if d > 1:
+			d = f32(math.sqrt(d))
+			rx = f32(rx * d)
+			ry = f32(ry * d)
+		s = 0.0
+		sa = f32(f32(f32(sqr(rx) * sqr(ry)) - f32(sqr(rx) * sqr(y1p))) - f32(sqr(ry) * sqr(x1p)))
+		sb = f32(f32(sqr(rx) * sqr(y1p)) + f32(sqr(ry) * sqr(x1p)))
+		if sa < 0.0:
+			sa = 0.0
+		if sb > 0.0:
+			s = f32(math.sqrt(f32(sa / sb)))
+		if fa == fs:
+			s = -s
+		cxp = f32(f32(f32(s * rx) * y1p) / ry)
+		cyp = f32(f32(f32(s * -ry) * x1p) / rx)
+		cx = f32(f32(f32(f32(x1 + x2) / 2.0) + f32(cosrx * cxp)) - f32(sinrx * cyp))
+		cy = f32(f32(f32(f32(y1 + y2) / 2.0) + f32(sinrx * cxp)) + f32(cosrx * cyp))
+		ux = f32(f32(x1p - cxp) / rx)
+		uy = f32(f32(y1p - cyp) / ry)
+		vx = f32(f32(-x1p - cxp) / rx)
+		vy = f32(f32(-y1p - cyp) / ry)
+		a1 = vecang(1.0, 0.0, ux, uy)
+		da = vecang(ux, uy, vx, vy)
+		if fs == 0 and da > 0:
+			da = f32(da - 2 * PI)
+		elif fs == 1 and da < 0:
+			da = f32(da + 2 * PI)
+		t = [cosrx, sinrx, -sinrx, cosrx, cx, cy]
+		ndivs = int(f32(f32(math.fabs(da) / f32(PI * 0.5)) + 1.0))
+		hda = f32(f32(da / float(ndivs)) / 2.0)
+		if hda < f32(1e-3) and hda > -f32(1e-3):
+			hda = f32(hda * 0.5)
+		else:
+			hda = f32(f32(1.0 - f32(math.cos(hda))) / f32(math.sin(hda)))
+		kappa = math.fabs(f32(f32(4.0 / 3.0) * hda))
+		if da < 0.0:
+			kappa = -kappa
+		px = py = ptanx = ptany = 0.0
+		for i in range(ndivs + 1):
+			a = f32(a1 + f32(da * f32(float(i) / float(ndivs))))
+			dx = f32(math.cos(a))
+			dy = f32(math.sin(a))
+			x, y = xformPoint(f32(dx * rx), f32(dy * ry), t)
+			tanx, tany = xformVec(f32(f32(-dy * rx) * kappa), f32(f32(dx * ry) * kappa), t)
+			if i > 0:
+				self.cubicBezTo(f32(px + ptanx), f32(py + ptany), f32(x - tanx), f32(y - tany), x, y)
+			px, py, ptanx, ptany = x, y, tanx, tany
+		cp[0], cp[1] = x2, y2
+
+	def addPath(self, closed):
+		"""! Stores the current points as new path (see `nsvg__addPath()`).
+		@param closed - True if closed
+		"""
+		if len(self.pts) < 4:
+			return
+		if closed:
+			self.lineTo(*self.pts[0])
+		if (len(self.pts) % 3) != 1:
+			return
+		pts = [xformPoint(x, y, [1.0, 0.0, 0.0, 1.0, 0.0, 0.0]) for x, y in self.pts]
+		flat = [v for pt in pts for v in pt]
+		bounds = None
+		for i in range(0, len(pts) - 1, 3):
+			curve = curveBounds(flat[i * 2:i * 2 + 8])
+			bounds = curve if bounds is None else unionBounds(bounds, curve)
+		self.plist.insert(0, {'pts': flat, 'closed': 1 if closed else 0, 'bounds': bounds})
+
+	def addShape(self):
+		"""! Creates a shape from the current path list (see `nsvg__addShape()`). """
+		if not self.plist:
+			return
+		attr = self.attr[-1]
+		bounds = self.plist[0]['bounds']
+		for path in self.plist[1:]:
+			bounds = unionBounds(bounds, path['bounds'])
+		self.shapes.append({
+			'id': attr['id'],
+			'fill': (1, attr['fillColor'] | (255 << 24)) if attr['hasFill'] else (0, 0),
+			'stroke': (1, attr['strokeColor'] | (255 << 24)) if attr['hasStroke'] else (0, 0),
+			'strokeWidth': attr['strokeWidth'],
+			'strokeLineJoin': attr['strokeLineJoin'],
+			'strokeLineCap': attr['strokeLineCap'],
+			'bounds': bounds,
+			'paths': self.plist
+		})
+		self.plist = []
+
+	def parsePath(self, attrs):
+		"""! Parses a path element (see `nsvg__parsePath()`).
+		@param attrs - element attributes
+		"""
+		s = None
+		for name, value in attrs.items():
+			if name == 'd':
+				s = value
+			else:
+				self.parseAttr(name, value)
+		if s is not None:
+			self.pts = []
+			cp = [0.0, 0.0]
+			cp2 = [0.0, 0.0]
+			cmd = ''
+			args = []
+			rargs = 0
+			initPoint = False
+			closedFlag = False
+			i = 0
+			while i < len(s):
+				item = ''
+				if cmd in ('A', 'a') and len(args) in (3, 4):
+					while i < len(s) and (s[i].isspace() or s[i] == ','):
+						i += 1
+					if i < len(s) and s[i] in '01':
+						item = s[i]
+						i += 1
+				if not item:
+					while i < len(s) and (s[i].isspace() or s[i] == ','):
+						i += 1
+					if i >= len(s):
+						break
+					if s[i] in '-+.' or s[i].isdigit():
+						item, i = parseNumber(s, i)
+					else:
+						item = s[i]
+						i += 1
+				if cmd != '' and isCoordinate(item):
+					if len(args) < 10:
+						args.append(atof(item))
+					if len(args) >= rargs:
+						rel = cmd.islower()
+						c = cmd.lower()
+						assert c in 'mlhvazc', 'unsupported path command "%s"' % cmd
+						if c in 'ml':
+							if rel:
+								cp = [f32(cp[0] + args[0]), f32(cp[1] + args[1])]
+							else:
+								cp = [args[0], args[1]]
+							if c == 'm':
+								self.moveTo(*cp)
+								cmd = 'l' if rel else 'L'
+								rargs = 2
+								initPoint = True
+							else:
+								self.lineTo(*cp)
+						elif c == 'h':
+							cp[0] = f32(cp[0] + args[0]) if rel else args[0]
+							self.lineTo(*cp)
+						elif c == 'v':
+							cp[1] = f32(cp[1] + args[0]) if rel else args[0]
+							self.lineTo(*cp)
+						elif c == 'c':
+							if rel:
+								v = [f32(cp[n % 2] + args[n]) for n in range(6)]
+							else:
+								v = args[:6]
+							self.cubicBezTo(*v)
+							cp2 = v[2:4]
+							cp = v[4:6]
+						elif c == 'a':
+							self.arcTo(cp, args, rel)
+						elif len(args) >= 2:
+							cp = args[-2:]
+						if c != 'c':
+							cp2 = list(cp)
+						args = []
+				else:
+					cmd = item[0]
+					if cmd in ('M', 'm'):
+						if self.pts:
+							self.addPath(closedFlag)
+						self.pts = []
+						closedFlag = False
+						args = []
+					elif not initPoint:
+						cmd = ''
+					if cmd in ('Z', 'z'):
+						closedFlag = True
+						if self.pts:
+							cp = list(self.pts[0])
+							cp2 = list(cp)
+							self.addPath(closedFlag)
+						self.pts = []
+						self.moveTo(*cp)
+						closedFlag = False
+						args = []
+					rargs = {'m': 2, 'l': 2, 't': 2, 'h': 1, 'v': 1, 'q': 4, 's': 4, 'c': 6, 'a': 7, 'z': 0}.get(cmd.lower(), -1)
+					if rargs == -1:
+						cmd = ''
+						rargs = 0
+			if self.pts:
+				self.addPath(closedFlag)
+		self.addShape()
+
+	def parseCircle(self, attrs):
+		"""! Parses a circle element (see `nsvg__parseCircle()`).
+		@param attrs - element attributes
+		"""
+		cx = cy = r = 0.0
+		for name, value in attrs.items():
+			if not self.parseAttr(name, value):
+				if name == 'cx':
+					cx = parseCoordinate(value)
+				elif name == 'cy':
+					cy = parseCoordinate(value)
+				elif name == 'r':
+					r = math.fabs(parseCoordinate(value))
+		if r > 0.0:
+			rk = f32(r * KAPPA90)
+			self.pts = []
+			self.moveTo(f32(cx + r), cy)
+			self.cubicBezTo(f32(cx + r), f32(cy + rk), f32(cx + rk), f32(cy + r), cx, f32(cy + r))
+			self.cubicBezTo(f32(cx - rk), f32(cy + r), f32(cx - r), f32(cy + rk), f32(cx - r), cy)
+			self.cubicBezTo(f32(cx - r), f32(cy - rk), f32(cx - rk), f32(cy - r), cx, f32(cy - r))
+			self.cubicBezTo(f32(cx + rk), f32(cy - r), f32(cx + r), f32(cy - rk), f32(cx + r), cy)
+			self.addPath(True)
+			self.addShape()
+
+	def parseElement(self, el):
+		"""! Parses the given element and its children (see `nsvg__startElement()`).
+		@param el - XML element
+		"""
+		if el.tag == 'svg':
+			for name, value in el.attrib.items():
+				if not self.parseAttr(name, value):
+					assert name in ('width', 'height'), 'unsupported attribute "%s"' % name
+					setattr(self, name, parseCoordinate(value))
+			for child in el:
+				self.parseElement(child)
+			return
+		assert el.tag in ('g', 'path', 'circle'), 'unsupported element "%s"' % el.tag
+		self.attr.append(dict(self.attr[-1]))
+		if el.tag == 'g':
+			for name, value in el.attrib.items():
+				self.parseAttr(name, value)
+			for child in el:
+				self.parseElement(child)
+		elif el.tag == 'path':
+			self.parsePath(el.attrib)
+		else:
+			self.parseCircle(el.attrib)
+		self.attr.pop()
+
+def xformPoint(x, y, t):
+	"""! Transforms a point (see `nsvg__xformPoint()`). """
+	return f32(f32(f32(x * t[0]) + f32(y * t[2])) + t[4]), f32(f32(f32(x * t[1]) + f32(y * t[3])) + t[5])
+
+def xformVec(x, y, t):
+	"""! Transforms a vector (see `nsvg__xformVec()`). """
+	return f32(f32(x * t[0]) + f32(y * t[2])), f32(f32(x * t[1]) + f32(y * t[3]))
+
+def toFloat(val):
+	"""! Formats the value as shortest C float literal which gives the same value.
+	@param val - single precision value
+	@return C float literal
+	"""
+	for precision in range(1, 10):
+		res = '%.*g' % (precision, val)
+		if f32(float(res)) == val:
+			break
+	if 'e' in res and math.fabs(val) >= 1e-4 and math.fabs(val) < 1e9:
+		exponent = int(math.floor(math.log10(math.fabs(val))))
+		res = '%.*f' % (max(0, precision - 1 - exponent), val)
+	if '.' not in res and 'e' not in res:
+		res += '.0'
+	return res + 'f'
+
+def compileSvg(src, dst, name = 'svgImage'):
+	"""! Compiles the SVG image into constant NanoSVG structures in a C++ header.
+	The file is only written if its content changed to avoid needless rebuilds.
+	@param src - SVG image
+	@param dst - C++ header file to create
+	@param name - variable name of the image
+	"""
+	parser = Parser()
+	parser.parseElement(ElementTree.parse(src).getroot())
+	assert parser.width > 0 and parser.height > 0, 'missing image size'
+	guard = '_' + os.path.basename(dst).upper().replace('.', '_') + '_'
+	out = [
+		'/* generated by build-pre-svg.py from ' + src.replace('\\', '/') + ' - do not edit */',
+		'#ifndef ' + guard,
+		'#define ' + guard,
+		'',
+		'/* needs the NanoSVG declarations */',
+		''
+	]
+	paths = []
+	for shape in parser.shapes:
+		shape['first'] = len(paths)
+		for path in shape['paths']:
+			path['next'] = len(paths) + 1 if path is not shape['paths'][-1] else None
+			paths.append(path)
+	for i, path in enumerate(paths):
+		values = [toFloat(v) for v in path['pts']]
+		out.append('')
+		out.append('static const float %sPts%u[] = {' % (name, i))
+		for n in range(0, len(values), 8):
+			out.append('\t' + ', '.join(values[n:n + 8]) + ',')
+		out.append('};')
+	out += [
+		'',
+		'',
+		'static const NSVGpath %sPaths[%u] = {' % (name, len(paths)),
+		',\n'.join('\t{const_cast<float *>(%sPts%u), %u, %u, {%s}, %s}' % (
+			name,
+			i,
+			len(path['pts']) // 2,
+			path['closed'],
+			', '.join(toFloat(v) for v in path['bounds']),
+			'NULL' if path['next'] is None else 'const_cast<NSVGpath *>(%sPaths + %u)' % (name, path['next'])
+		) for i, path in enumerate(paths)),
+		'};',
+		'',
+		'',
+		'static const NSVGshape %sShapes[%u] = {' % (name, len(parser.shapes)),
+		',\n'.join('\t{"%s", {%s, {0x%08XU}}, {%s, {0x%08XU}}, 1.0f, %s, 0.0f, {0}, 0, %s, %s, 4.0f, NSVG_FILLRULE_NONZERO, NSVG_FLAGS_VISIBLE, {%s}, "", "", {1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f}, const_cast<NSVGpath *>(%sPaths + %u), %s}' % (
+			shape['id'],
+			'NSVG_PAINT_COLOR' if shape['fill'][0] else 'NSVG_PAINT_NONE',
+			shape['fill'][1],
+			'NSVG_PAINT_COLOR' if shape['stroke'][0] else 'NSVG_PAINT_NONE',
+			shape['stroke'][1],
+			toFloat(shape['strokeWidth']),
+			shape['strokeLineJoin'],
+			shape['strokeLineCap'],
+			', '.join(toFloat(v) for v in shape['bounds']),
+			name,
+			shape['first'],
+			'NULL' if i + 1 == len(parser.shapes) else 'const_cast<NSVGshape *>(%sShapes + %u)' % (name, i + 1)
+		) for i, shape in enumerate(parser.shapes)),
+		'};',
+		'',
+		'',
+		'/** Pre-parsed image of `%s`. Equals `nsvgParse(svg, "px", 96)`. */' % src.replace('\\', '/'),
+		'static const NSVGimage %s = {%s, %s, const_cast<NSVGshape *>(%sShapes)};' % (name, toFloat(parser.width), toFloat(parser.height), name),
+		'',
+		'',
+		'#endif /* ' + guard + ' */',
+		''
+	]
+	text = '\n'.join(out)
+	if os.path.isfile(dst):
+		with open(dst, 'r') as f:
+			if f.read() == text:
+				return
+	os.makedirs(os.path.dirname(os.path.abspath(dst)), exist_ok = True)
+	with open(dst, 'w') as f:
+		f.write(text)
+
+if __name__ == 'SCons.Script':
+	Import('env')
+
+	# compile the analog clock image and digital clock glyphs into constant NanoSVG structures
+	genDir = os.path.join(env.subst('$BUILD_DIR'), 'generated')
+	compileSvg(os.path.join('etc', 'analog.svg'), os.path.join(genDir, 'SvgImage.hpp'))
+	compileSvg(os.path.join('etc', 'digital.svg'), os.path.join(genDir, 'SvgDigits.hpp'), 'svgDigits')
+	env.Append(CPPPATH = [genDir])
+elif __name__ == '__main__':
+	if len(sys.argv) not in (3, 4):
+		sys.exit('Usage: ' + os.path.basename(sys.argv[0]) + ' <svg file> <header file> [<variable name>]')
+	compileSvg(*sys.argv[1:])
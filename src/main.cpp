@@ -2,7 +2,7 @@
  * @file main.cpp
  * @author Daniel Starke
  * @date 2024-03-24
- * @version 2024-05-11
+ * @version 2026-10-14
  *
  * Copyright (c) 2024 Daniel Starke
  *
@@ -26,6 +26,15 @@
  * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include <Arduino.h>
+#include <atomic>
+#include <sys/time.h>
+#include <driver/gpio.h>
+#include <driver/ledc.h>
+#include <esp_idf_version.h>
+#include <esp_pm.h>
+#include <esp_rom_crc.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
 #include <ArduinoOTA.h>
 #include <FS.h>
 #include <LittleFS.h>
@@ -37,14 +46,44 @@
 #include <AsyncTCP.h> /* https://github.com/mathieucarbou/AsyncTCP */
 #include <ESPAsyncWebServer.h> /* https://github.com/mathieucarbou/ESPAsyncWebServer */
 #include "IniParser.hpp"
-#include "SvgData.hpp"
+#include "JsonWriter.hpp"
+#include "LruCache.hpp"
+#include "Metrics.hpp"
+#include "NtpManager.hpp"
+#include "WebData.hpp" /* generated by build-pre-esp32.py */
 
+#ifndef SVG_NO_FAST_EDGES
+/**
+ * Sorts the rasterizer edges into scanline buckets and keeps the active edges in arrays.
+ * Define `SVG_NO_FAST_EDGES` to use the original NanoSVG implementation.
+ */
+#define NSVG_FAST_EDGES
+#endif /* SVG_NO_FAST_EDGES */
+#ifndef SVG_NO_PACKED_PIXELS
+/**
+ * Blends solid colored RGB565 spans with two color channels per 32-bit word and
+ * stores opaque runs two pixels per word.
+ * Define `SVG_NO_PACKED_PIXELS` to use the original NanoSVG implementation.
+ */
+#define NSVG_PACKED_PIXELS
+#endif /* SVG_NO_PACKED_PIXELS */
+/** CPU cycles spent within each rasterizer stage of the current frame (see `NSVGprofileStage`). */
+static uint32_t svgStageCycles[4];
+#define NSVG_PROFILE(stage, statement) do { \
+		const uint32_t profileStart = ESP.getCycleCount(); \
+		statement; \
+		svgStageCycles[stage] += ESP.getCycleCount() - profileStart; \
+	} while (0)
 extern "C" {
 #define NANOSVG_IMPLEMENTATION
 #include "nanosvg.h"
 #define NANOSVGRAST_IMPLEMENTATION
 #include "nanosvgrast.h"
 } /* C */
+#include "AnalogClock.hpp" /* needs the NanoSVG implementation */
+#include "SvgImage.hpp" /* generated by build-pre-svg.py, needs the NanoSVG declarations */
+#include "DigitalClock.hpp" /* needs the NanoSVG implementation */
+#include "SvgDigits.hpp" /* generated by build-pre-svg.py, needs the NanoSVG declarations */
 
 
 #ifndef ARRAY_SIZE
@@ -60,10 +99,101 @@ extern "C" {
 
 /** Configuration file path. */
 #define CONFIG_FILE "/config.ini"
+/** Binary configuration shadow file path. */
+#define CONFIG_SHADOW_FILE "/config.bin"
+/** Suffix of temporary files written before being renamed to their final name. */
+#define CONFIG_TEMP_SUFFIX ".tmp"
+/** Identifies a binary configuration shadow file. */
+#define CONFIG_SHADOW_MAGIC 0x47464354UL /* "TCFG" */
+/** Version of the binary configuration shadow file. Increment on any change of `Config` members or their meaning. */
+#define CONFIG_SHADOW_VERSION 1
+
+
+/** Time to coalesce configuration changes before storing them on flash. */
+#define CONFIG_STORE_DELAY_MS 10000
+
+
+/** Binary WIFI connection cache file path. */
+#define WIFI_CACHE_FILE "/wifi.bin"
+/** Identifies a WIFI connection cache file. */
+#define WIFI_CACHE_MAGIC 0x49465754UL /* "TWFI" */
+/** Time to wait for a direct connection to the cached access point before scanning for all. */
+#define WIFI_DIRECT_MS 5000
+/** Minimum time between two connection attempts via scan. A random delay of up to the same time is added. */
+#define WIFI_RETRY_MS 10000
+/* Define `WIFI_IP_CACHE` to reuse the IP configuration of the last connection instead of DHCP when connecting directly.
+ * Only use this if the DHCP server reserves the address for the device. */
+
+
+/** Directory of additional analog clock faces. */
+#define FACE_DIR "/faces"
+/** File name suffix of additional analog clock faces. */
+#define FACE_SUFFIX ".svg"
+/** Name of the built-in analog clock face (see `SvgImage.hpp`). */
+#define FACE_BUILTIN "analog"
+/** Maximum number of characters in a clock face name. */
+#define FACE_NAME_SIZE 31
+/** Maximum number of clock faces reported via `GET /faces`. */
+#define FACE_LIST_MAX 16
+
+
+#if !defined(BOARD_HAS_PSRAM) && !defined(SVG_STRIP_LINES)
+/**
+ * Renders the analog clock in bands of this many full-width lines via
+ * double-buffered DMA instead of using a full-frame buffer.
+ * Enabled by default for boards without PSRAM.
+ */
+#define SVG_STRIP_LINES 16
+#endif /* !BOARD_HAS_PSRAM && !SVG_STRIP_LINES */
+
+
+#if defined(BOARD_HAS_PSRAM) && !defined(SVG_NO_HAND_CACHE)
+/**
+ * Keeps the flattened and sorted edges of every clock hand position in PSRAM.
+ * These are created on first use and rasterized instead of the rotated paths.
+ * Define `SVG_NO_HAND_CACHE` to disable.
+ */
+#define SVG_HAND_CACHE
+#endif /* BOARD_HAS_PSRAM && !SVG_NO_HAND_CACHE */
+
+
+#ifndef SVG_NO_ARENA
+/**
+ * Places the parsed analog clock image and all rasterizer buffers into a
+ * single arena which is sized once at startup. The arena is allocated in
+ * internal RAM if possible. No heap allocation is performed while rendering.
+ * Define `SVG_NO_ARENA` to allocate them separately on demand.
+ */
+#define SVG_ARENA
+#endif /* SVG_NO_ARENA */
+
+
+#ifndef SVG_FACE_CACHE
+#ifdef BOARD_HAS_PSRAM
+/**
+ * Number of analog clock faces kept ready for rendering. Faces are loaded on
+ * first use and the least recently used one is released if all are in use.
+ * Each face holds its own background and clock hand cache.
+ * Defaults to 1 for boards without PSRAM.
+ */
+#define SVG_FACE_CACHE 3
+#else /* ! BOARD_HAS_PSRAM */
+#define SVG_FACE_CACHE 1
+#endif /* ! BOARD_HAS_PSRAM */
+#endif /* SVG_FACE_CACHE */
+
+
+#if defined(BOARD_HAS_PSRAM) && !defined(DIGITAL_NO_ATLAS)
+/**
+ * Draws the digital clock with anti-aliased glyphs from an atlas in PSRAM
+ * which is rendered once per clock color (see `DigitalClock`). Only the
+ * changed characters are transferred to the screen.
+ * Define `DIGITAL_NO_ATLAS` to draw the time with the built-in font 8.
+ */
+#define DIGITAL_ATLAS
+#endif /* BOARD_HAS_PSRAM && !DIGITAL_NO_ATLAS */
 
 
-/** Global mutex. */
-SemaphoreHandle_t mutex;
 
 
 /* TFT */
@@ -80,24 +210,129 @@ static uint32_t tftBl[] {
 	255
 };
 /** Current index into `tftBl`. */
-static size_t tftBlIndex = 1;
-/** Parsed SVG data for the analog clock. */
-static NSVGimage * svgImg = NULL;
-/** SVG image rasterizer instance. */
-static NSVGrasterizer * svgRast = NULL;
-/** Rendered SVG data for the analog clock in RGBA32. */
-static unsigned char * imgBuf = NULL;
-/** Initial paths of the hour clock hand. */
-static NSVGpath * svgPathsHour = NULL;
-/** Initial paths of the minute clock hand. */
-static NSVGpath * svgPathsMin = NULL;
-
+static volatile size_t tftBlIndex = 1;
+/** Index into `tftBl` currently applied to the back light. */
+static size_t tftBlApplied = 0;
+/** Analog clock renderers of the recently used clock faces. Only accessed by the render task after setup. */
+static LruCache<AnalogClock, SVG_FACE_CACHE, FACE_NAME_SIZE> faceCache;
+#ifdef DIGITAL_ATLAS
+/** Digital clock renderer. Only accessed by the render task after setup. */
+static DigitalClock digitalClock;
+/** True if `digitalClock` is ready for use, else the built-in font is used. */
+static bool digitalAtlas = false;
+#endif /* DIGITAL_ATLAS */
+/** Name of the last clock face which failed to load or empty. Not retried until the clock configuration changes. */
+static char faceFailed[FACE_NAME_SIZE + 1] = {0};
+/** Number of clock faces loaded since startup. */
+static std::atomic<uint32_t> faceLoads(0);
+/** Number of cached clock faces. */
+static std::atomic<uint32_t> faceCached(0);
+/** Arena size and used bytes of the last drawn clock face. */
+static std::atomic<uint32_t> faceArena[2];
+#ifdef SVG_STRIP_LINES
+/** Ping-pong DMA buffers for the rendered SVG bands of the analog clock in RGB565. */
+static uint16_t * stripBuf[2] = {NULL, NULL};
+#else /* ! SVG_STRIP_LINES */
+/** Rendered SVG data for the analog clock in RGB565. */
+static uint16_t * imgBuf = NULL;
+#endif /* ! SVG_STRIP_LINES */
 /* Buttons */
 #define BUTTON_UP 37 /* pin */
 #define BUTTON_DOWN 38 /* pin */
 static uint32_t bUpLast; /**< Last `millis()` when `BUTTON_UP` was triggered. */
 static uint32_t bDownLast; /**< Last `millis()` when `BUTTON_DOWN` was triggered. */
 
+/* Render task */
+#define RENDER_TASK_CORE 0
+#define RENDER_TASK_STACK 8192 /* bytes */
+#define RENDER_TASK_PRIORITY 1
+#define RENDER_FPS_DEFAULT 10 /* default frame rate of the sweeping seconds hand */
+#define RENDER_FPS_MAX 30 /* maximum frame rate of the sweeping seconds hand */
+/* Power management */
+#define POWER_AWAKE_MS 60000 /* time to stay awake after a button press or web request in light sleep mode */
+static esp_pm_lock_handle_t powerLock = NULL; /**< Prevents automatic light sleep while held or `NULL` without light sleep. */
+static int64_t powerWindowStart = 0; /**< Start of the current awake time measurement window in microseconds. */
+static int64_t powerWindowSlept = 0; /**< Time light sleep was allowed within the current window in microseconds. */
+static volatile uint32_t powerAwakeMs = 0; /**< Time light sleep was prevented per minute within the last window in milliseconds. */
+
+/* WIFI */
+/**
+ * Parameters of the last working WIFI connection. Stored within `WIFI_CACHE_FILE`
+ * to connect without scanning for the access point after a reboot.
+ */
+struct WifiCache {
+	uint32_t magic; /**< Always `WIFI_CACHE_MAGIC`. */
+	uint32_t ssidCrc; /**< CRC32 of the SSID of the network. */
+	uint8_t bssid[6]; /**< MAC address of the access point. */
+	uint8_t channel; /**< Primary channel of the access point. */
+	uint8_t reserved; /**< Always 0. */
+	uint32_t ip; /**< Local IPv4 address. */
+	uint32_t gateway; /**< Gateway IPv4 address. */
+	uint32_t subnet; /**< Subnet mask. */
+	uint32_t dns; /**< DNS server IPv4 address. */
+	uint32_t crc; /**< CRC32 of all previous fields. */
+};
+/** Last working WIFI connection. Only accessed by the main loop after setup. */
+static WifiCache wifiCache;
+/** True if `wifiCache` belongs to the configured network, else false. */
+static bool wifiCacheValid = false;
+/** True while connecting directly to the cached access point, else false. */
+static bool wifiDirect = false;
+/** Earliest value of `millis()` for the next connection attempt relative to `wifiConnectStart`. */
+static uint32_t wifiRetryMs = 0;
+/** Value of `millis()` at the start of the current connection attempt. */
+static uint32_t wifiConnectStart = 0;
+/** Duration of the last successful connection attempt in milliseconds. */
+static std::atomic<uint32_t> wifiConnectMs(0);
+/** Number of connection attempts via scan. */
+static std::atomic<uint32_t> wifiScans(0);
+
+
+/* Main loop */
+#define OTA_POLL_MS 2000 /* maximum time between two Over-the-Air updater polls */
+/** Set while an Over-the-Air update is being received. */
+static std::atomic<bool> otaActive(false);
+/** Main loop task which waits for events (see `loopWake()`). */
+static TaskHandle_t loopTask = NULL;
+
+/** Render task which draws the display updates. */
+static TaskHandle_t renderTaskHandle = NULL;
+/** Single element queue holding the next display update for the render task (see `RenderJob`). */
+static QueueHandle_t renderQueue = NULL;
+
+
+/**
+ * Converts an RGB565 value to an RGB24 value.
+ *
+ * @param[in] val - RGB565 value
+ * @return RGB24 value
+ */
+static inline uint32_t fromRgb565(const uint32_t val) noexcept {
+	const uint32_t r = (val << 8) & 0xF80000UL;
+	const uint32_t g = (val << 5) & 0xFC00UL;
+	const uint32_t b = (val << 3) & 0xF8UL;
+	return r | g | b;
+}
+
+
+/**
+ * Checks if the given string is a valid clock face name.
+ * Only letters, digits, `-` and `_` are allowed to keep it within `FACE_DIR`.
+ *
+ * @param[in] name - null-terminated name
+ * @return true if valid, else false
+ */
+static bool faceNameValid(const char * name) noexcept {
+	size_t len = 0;
+	for (; name[len] != 0; len++) {
+		const char c = name[len];
+		if ( ! ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_') ) {
+			return false;
+		}
+	}
+	return len > 0 && len <= FACE_NAME_SIZE;
+}
+
 
 /**
  * Holds the system configuration.
@@ -107,19 +342,63 @@ struct Config {
 		MAX_STRING = 255, /**< Maximum number of characters in a general string. */
 		HOST_SIZE = 63, /**< Maximum number of characters in a host name string. */
 		TIME_SIZE = 5, /**< Number of characters in a time string. */
-		TYPE_SIZE = 8 /**< Number of characters in a type string. */
+		MAX_WINDOWS = 4, /**< Maximum number of passing time windows. */
+		TIMES_SIZE = (MAX_WINDOWS * (TIME_SIZE + 1)) - 1, /**< Number of characters in a comma separated list of time strings. */
+		TYPE_SIZE = 8, /**< Number of characters in a type string. */
+		TZ_SIZE = 63 /**< Number of characters in a time zone string. */
 	};
 	char wifiSsid[MAX_STRING + 1]; /**< WIFI SSID to connect to. */
 	char wifiPass[MAX_STRING + 1]; /**< WIFI password to use. */
 	char mdnsHost[HOST_SIZE + 1]; /**< Multicast DNS host name to publish within domain `.local`. */
 	char otaPass[MAX_STRING + 1]; /**< Over-the-Air updater password. */
 	uint32_t ntpTimeout; /**< NTP request timeout in milliseconds. */
-	char ntpServer[MAX_STRING + 1]; /**< NTP server address as host name or IPv4 address. */
+	char ntpServer[MAX_STRING + 1]; /**< Comma separated NTP server addresses as host name or IPv4 address. Tried in order on failures. */
+	char ntpTz[TZ_SIZE + 1]; /**< Local time zone in POSIX `TZ` format. */
 	uint32_t clockPassColor; /**< Passing clock color in RGB565. */
 	uint32_t clockFailColor; /**< Failing clock color in RGB565. */
-	char clockPassFrom[TIME_SIZE + 1]; /**< Starting time (inclusive) in HH:SS to use the passing color. */
-	char clockPassTo[TIME_SIZE + 1]; /**< Endinding time (exclusive) in HH:SS to use the passing color. */
-	char clockType[TYPE_SIZE + 1]; /**< Either "digital" or "analog". */
+	char clockPassFrom[TIMES_SIZE + 1]; /**< Comma separated starting times (inclusive) in HH:MM to use the passing color. */
+	char clockPassTo[TIMES_SIZE + 1]; /**< Comma separated ending times (exclusive) in HH:MM to use the passing color. */
+	char clockType[FACE_NAME_SIZE + 1]; /**< Either "digital", "analog" or the name of a clock face within `FACE_DIR`. */
+	char clockSeconds[TYPE_SIZE + 1]; /**< Seconds hand of the analog clock. Either "none", "tick" or "sweep". */
+	uint32_t clockFps; /**< Target frame rate of the sweeping seconds hand. */
+	char powerMode[TYPE_SIZE + 1]; /**< Either "none", "modem" or "light". */
+
+	/** Flags of the configuration key mappings (see `Config::keys()`). */
+	enum KeyFlags {
+		KEY_OPTIONAL = 0x01, /**< Key may be missing in the configuration file. */
+		KEY_WEB      = 0x02, /**< Key can be changed via web interface. */
+		KEY_NTP      = 0x04, /**< Changing the value requires an NTP restart. */
+		KEY_CLOCK    = 0x08  /**< Changing the value requires a clock redraw. */
+	};
+
+	/**
+	 * Returns the mapping of all configuration keys to their variables.
+	 * This is shared by the configuration file and the web interface.
+	 *
+	 * @return configuration key map
+	 */
+	static const IniParser::KeyMap<Config> & keys() noexcept {
+		typedef IniParser::Mapping<Config> Map;
+		static constexpr Map mappings[] = {
+			Map::string("WIFI",  "SSID",       offsetof(Config, wifiSsid),       sizeof(wifiSsid)),
+			Map::string("WIFI",  "PASS",       offsetof(Config, wifiPass),       sizeof(wifiPass)),
+			Map::string("MDNS",  "HOST",       offsetof(Config, mdnsHost),       sizeof(mdnsHost),      KEY_WEB, &Config::checkMdnsHost),
+			Map::string("OTA",   "PASS",       offsetof(Config, otaPass),        sizeof(otaPass)),
+			Map::u32(   "NTP",   "TIMEOUT",    offsetof(Config, ntpTimeout),     0, 0xFFFF,             KEY_WEB),
+			Map::string("NTP",   "SERVER",     offsetof(Config, ntpServer),      sizeof(ntpServer),     KEY_WEB | KEY_NTP, &Config::checkNtpServer),
+			Map::string("NTP",   "TZ",         offsetof(Config, ntpTz),          sizeof(ntpTz),         KEY_OPTIONAL | KEY_WEB | KEY_NTP, &Config::checkNtpTz),
+			Map::u32(   "CLOCK", "PASS_COLOR", offsetof(Config, clockPassColor), 0, 0xFFFF,             KEY_WEB | KEY_CLOCK),
+			Map::u32(   "CLOCK", "FAIL_COLOR", offsetof(Config, clockFailColor), 0, 0xFFFF,             KEY_WEB | KEY_CLOCK),
+			Map::string("CLOCK", "PASS_FROM",  offsetof(Config, clockPassFrom),  sizeof(clockPassFrom), KEY_WEB | KEY_CLOCK, &Config::checkClockPassFrom),
+			Map::string("CLOCK", "PASS_TO",    offsetof(Config, clockPassTo),    sizeof(clockPassTo),   KEY_WEB | KEY_CLOCK, &Config::checkClockPassTo),
+			Map::string("CLOCK", "TYPE",       offsetof(Config, clockType),      sizeof(clockType),     KEY_WEB | KEY_CLOCK, &Config::checkClockType),
+			Map::string("CLOCK", "SECONDS",    offsetof(Config, clockSeconds),   sizeof(clockSeconds),  KEY_OPTIONAL | KEY_WEB | KEY_CLOCK, &Config::checkClockSeconds),
+			Map::u32(   "CLOCK", "FPS",        offsetof(Config, clockFps),       1, RENDER_FPS_MAX,     KEY_OPTIONAL | KEY_WEB | KEY_CLOCK),
+			Map::string("POWER", "MODE",       offsetof(Config, powerMode),      sizeof(powerMode),     KEY_OPTIONAL, &Config::checkPowerMode)
+		};
+		static const IniParser::KeyMap<Config> map(mappings);
+		return map;
+	}
 
 	/**
 	 * Checks if the Multicast DNS host name is valid.
@@ -136,41 +415,115 @@ struct Config {
 	}
 
 	/**
-	 * Checks if the NTP server address is valid.
+	 * Checks if the comma separated NTP server addresses are valid.
 	 *
 	 * @return true if valid, else false
 	 */
 	bool checkNtpServer() const noexcept {
-		/* ^(([a-zA-Z]([0-9a-zA-Z-]{0,61}[0-9a-zA-Z])?(\.[a-zA-Z]([0-9a-zA-Z-]{0,61}[0-9a-zA-Z])?)*)|(((25[0-5]|(2[0-4]|1\d|[1-9]|)\d)\.?\b){4}))$ */
-		if ( Config::checkIpv4(this->ntpServer) ) {
-			return true;
-		}
+		char server[MAX_STRING + 1];
 		const char * str = this->ntpServer;
-		do {
-			str = Config::checkDomainLabel(str);
-		} while (str != NULL && *str == '.');
-		if (str == NULL || *str != 0) {
+		for (size_t i = 0; i < size_t(NtpManager::MAX_SERVERS); i++) {
+			const char * end = strchr(str, ',');
+			size_t len = (end != NULL) ? size_t(end - str) : strlen(str);
+			/* blanks around each entry are ignored (see `NtpManager::begin()`) */
+			while (len > 0 && isblank(*str)) {
+				str++;
+				len--;
+			}
+			while (len > 0 && isblank(str[len - 1])) {
+				len--;
+			}
+			memcpy(server, str, len);
+			server[len] = 0;
+			if ( ! Config::checkHost(server) ) {
+				return false;
+			}
+			if (end == NULL) {
+				return true;
+			}
+			str = end + 1;
+		}
+		return false; /* too many servers */
+	}
+
+	/**
+	 * Checks if the time zone is a valid POSIX `TZ` string.
+	 * Only the character set is checked.
+	 *
+	 * @return true if valid, else false
+	 */
+	bool checkNtpTz() const noexcept {
+		/* ^[a-zA-Z<][0-9a-zA-Z<>+,./:-]*$ */
+		if (( ! isalpha(*this->ntpTz) ) && *this->ntpTz != '<') {
 			return false;
 		}
+		for (const char * str = this->ntpTz; *str != 0; str++) {
+			if (( ! isalnum(*str) ) && strchr("<>+,./:-", *str) == NULL) {
+				return false;
+			}
+		}
 		return true;
 	}
 
 	/**
-	 * Checks if the starting passing time is valid.
+	 * Checks if the starting passing times are valid.
 	 *
 	 * @return true if valid, else false
 	 */
 	inline bool checkClockPassFrom() const noexcept {
-		return Config::checkTime(this->clockPassFrom);
+		return Config::parseTimes(this->clockPassFrom, NULL) > 0;
 	}
 
 	/**
-	 * Checks if the ending passing time is valid.
+	 * Checks if the ending passing times are valid.
 	 *
 	 * @return true if valid, else false
 	 */
 	inline bool checkClockPassTo() const noexcept {
-		return Config::checkTime(this->clockPassTo);
+		return Config::parseTimes(this->clockPassTo, NULL) > 0;
+	}
+
+	/**
+	 * Checks if the starting and ending passing times form complete time windows.
+	 *
+	 * @return true if valid, else false
+	 */
+	inline bool checkClockPass() const noexcept {
+		const size_t count = Config::parseTimes(this->clockPassFrom, NULL);
+		return count > 0 && count == Config::parseTimes(this->clockPassTo, NULL);
+	}
+
+	/**
+	 * Parses a comma separated list of times in the format `HH:MM`.
+	 *
+	 * @param[in] str - string to parse
+	 * @param[out] minutes - receives up to `MAX_WINDOWS` times in minutes since midnight (may be `NULL`)
+	 * @return number of times or 0 if invalid
+	 */
+	static size_t parseTimes(const char * str, uint16_t * minutes) noexcept {
+		size_t count = 0;
+		for (;;) {
+			if (count >= MAX_WINDOWS
+				|| !isdigit(str[0]) || !isdigit(str[1]) || str[2] != ':'
+				|| !isdigit(str[3]) || !isdigit(str[4])) {
+				return 0;
+			}
+			const uint32_t hour = uint32_t(((str[0] - '0') * 10) + str[1] - '0');
+			const uint32_t minute = uint32_t(((str[3] - '0') * 10) + str[4] - '0');
+			if (hour > 23 || minute > 59) {
+				return 0;
+			}
+			if (minutes != NULL) {
+				minutes[count] = uint16_t((hour * 60) + minute);
+			}
+			count++;
+			if (str[5] == 0) {
+				return count;
+			} else if (str[5] != ',') {
+				return 0;
+			}
+			str += 6;
+		}
 	}
 
 	/**
@@ -179,7 +532,45 @@ struct Config {
 	 * @return true if valid, else false
 	 */
 	inline bool checkClockType() const noexcept {
-		return strcmp(this->clockType, "digital") == 0 || strcmp(this->clockType, "analog") == 0;
+		return faceNameValid(this->clockType); /* includes "digital" and `FACE_BUILTIN` */
+	}
+
+	/**
+	 * Checks whether the digital clock is displayed.
+	 *
+	 * @return true for the digital clock, false for an analog clock face
+	 */
+	inline bool digital() const noexcept {
+		return strcmp(this->clockType, "digital") == 0;
+	}
+
+	/**
+	 * Checks if the seconds hand mode is valid.
+	 *
+	 * @return true if valid, else false
+	 */
+	inline bool checkClockSeconds() const noexcept {
+		return strcmp(this->clockSeconds, "none") == 0 || strcmp(this->clockSeconds, "tick") == 0
+			|| strcmp(this->clockSeconds, "sweep") == 0;
+	}
+
+	/**
+	 * Checks whether a seconds hand is displayed.
+	 *
+	 * @return true if displayed, else false
+	 */
+	inline bool showSeconds() const noexcept {
+		return ( ! this->digital() ) && this->clockSeconds[0] != 'n';
+	}
+
+	/**
+	 * Checks if the power mode is valid.
+	 *
+	 * @return true if valid, else false
+	 */
+	inline bool checkPowerMode() const noexcept {
+		return strcmp(this->powerMode, "none") == 0 || strcmp(this->powerMode, "modem") == 0
+			|| strcmp(this->powerMode, "light") == 0;
 	}
 
 	/**
@@ -190,114 +581,50 @@ struct Config {
 	 */
 	bool load() {
 		static Config tmp;
-		static const char * params[] = {
-			"WIFI.SSID",
-			"WIFI.PASS",
-			"MDNS.HOST",
-			"OTA.PASS",
-			"NTP.TIMEOUT",
-			"NTP.SERVER",
-			"CLOCK.PASS_COLOR",
-			"CLOCK.FAIL_COLOR",
-			"CLOCK.PASS_FROM",
-			"CLOCK.PASS_TO",
-			"CLOCK.TYPE"
-		};
-		enum {
-			HAS_WIFI_SSID,
-			HAS_WIFI_PASS,
-			HAS_MDNS_HOST,
-			HAS_OTA_PASS,
-			HAS_NTP_TIMEOUT,
-			HAS_NTP_SERVER,
-			HAS_CLOCK_PASS_COLOR,
-			HAS_CLOCK_FAIL_COLOR,
-			HAS_CLOCK_PASS_FROM,
-			HAS_CLOCK_PASS_TO,
-			HAS_CLOCK_TYPE,
-			HAS_ALL
-		};
+		const IniParser::KeyMap<Config> & keys = Config::keys();
 		File file = LittleFS.open(CONFIG_FILE, FILE_READ);
 		if ( ! file ) {
 			return false;
 		}
 		memset(&tmp, 0, sizeof(tmp));
+		strcpy(tmp.ntpTz, TZ_Europe_Berlin);
+		strcpy(tmp.clockSeconds, "none");
+		tmp.clockFps = RENDER_FPS_DEFAULT;
+		strcpy(tmp.powerMode, "none");
 		uint32_t found = 0;
-		const auto fileReader = [&] () -> int {
-			return file.read();
-		};
-		bool (Config::* checker)() const noexcept = NULL;
-		const auto valueMapper = [&] (IniParser::Context & ctx, const bool parsed) -> bool {
-			checker = NULL;
-			if ( ! parsed ) {
-				if (ctx.group == "WIFI") {
-					if (ctx.key == "SSID") {
-						found |= uint32_t(1) << HAS_WIFI_SSID;
-						ctx.mapString(tmp.wifiSsid);
-					} else if (ctx.key == "PASS") {
-						found |= uint32_t(1) << HAS_WIFI_PASS;
-						ctx.mapString(tmp.wifiPass);
-					}
-				} else if (ctx.group == "MDNS") {
-					if (ctx.key == "HOST") {
-						found |= uint32_t(1) << HAS_MDNS_HOST;
-						ctx.mapString(tmp.mdnsHost);
-						checker = &Config::checkMdnsHost;
-					}
-				} else if (ctx.group == "OTA") {
-					if (ctx.key == "PASS") {
-						found |= uint32_t(1) << HAS_OTA_PASS;
-						ctx.mapString(tmp.otaPass);
-					}
-				} else if (ctx.group == "NTP") {
-					if (ctx.key == "TIMEOUT") {
-						found |= uint32_t(1) << HAS_NTP_TIMEOUT;
-						ctx.mapNumber(tmp.ntpTimeout, 0, 0xFFFF);
-					} else if (ctx.key == "SERVER") {
-						found |= uint32_t(1) << HAS_NTP_SERVER;
-						ctx.mapString(tmp.ntpServer);
-						checker = &Config::checkNtpServer;
-					}
-				} else if (ctx.group == "CLOCK") {
-					if (ctx.key == "PASS_COLOR") {
-						found |= uint32_t(1) << HAS_CLOCK_PASS_COLOR;
-						ctx.mapNumber(tmp.clockPassColor, 0, 0xFFFF);
-					} else if (ctx.key == "FAIL_COLOR") {
-						found |= uint32_t(1) << HAS_CLOCK_FAIL_COLOR;
-						ctx.mapNumber(tmp.clockFailColor, 0, 0xFFFF);
-					} else if (ctx.key == "PASS_FROM") {
-						found |= uint32_t(1) << HAS_CLOCK_PASS_FROM;
-						ctx.mapString(tmp.clockPassFrom);
-						checker = &Config::checkClockPassFrom;
-					} else if (ctx.key == "PASS_TO") {
-						found |= uint32_t(1) << HAS_CLOCK_PASS_TO;
-						ctx.mapString(tmp.clockPassTo);
-						checker = &Config::checkClockPassTo;
-					} else if (ctx.key == "TYPE") {
-						found |= uint32_t(1) << HAS_CLOCK_TYPE;
-						ctx.mapString(tmp.clockType);
-						checker = &Config::checkClockType;
-					}
-				}
-			} else if (checker != NULL && ((*this).*checker)() == false) {
-				return false;
-			}
-			return true; /* ignore unknown keys */
-		};
-		const size_t res = iniParseFn<16>(fileReader, valueMapper);
+		const auto valueMapper = keys.mapper(tmp, found);
+		/* read the whole file at once to avoid a file system call per character */
+		size_t res;
+		const size_t fileSize = file.size();
+		char * data = static_cast<char *>(malloc(fileSize));
+		if (data != NULL && file.read(reinterpret_cast<uint8_t *>(data), fileSize) == fileSize) {
+			res = iniParseBlock<16>(data, fileSize, valueMapper);
+		} else {
+			/* fall back to reading in chunks */
+			file.seek(0);
+			const auto fileReader = [&] (char * buf, const size_t size) -> size_t {
+				return file.read(reinterpret_cast<uint8_t *>(buf), size);
+			};
+			res = iniParseFn<16>(fileReader, valueMapper);
+		}
+		free(data);
 		file.close();
-		const bool foundAll = found == uint32_t((uint32_t(1) << HAS_ALL) - 1);
+		const uint32_t required = keys.all() & ~keys.select(KEY_OPTIONAL);
+		const bool foundAll = (found & required) == required;
 		if (res != 0) {
 			log_e("Syntax error in system configuration at line %u.", unsigned(res));
 			return false;
 		} else if ( ! foundAll ) {
 			log_e("Missing configuration keys:");
-			for (size_t i = 0; i < HAS_ALL; i++) {
-				if ((found & (uint32_t(1) << i)) == 0) {
-					log_e(" - %s", params[i]);
+			for (size_t i = 0; i < keys.size(); i++) {
+				if ((required & ~found & (uint32_t(1) << i)) != 0) {
+					log_e(" - %s.%s", keys[i].group, keys[i].key);
 				}
 			}
 			return false;
+		} else if ( ! tmp.checkClockPass() ) {
+			log_e("Number of CLOCK.PASS_FROM and CLOCK.PASS_TO times differ.");
+			return false;
 		}
 		/* all checks passed -> update to new configuration */
 		*this = tmp;
@@ -310,7 +637,7 @@ struct Config {
 	 *
 	 * @return true on success, else false
 	 */
-	bool store() {
+	bool store() const {
 		static const char * fmt = R"([WIFI]
 
 SSID = "%s"
@@ -329,8 +656,10 @@ PASS = "%s"
 
 # milliseconds
 TIMEOUT = %lu
-# host name or IPv4 address
+# host name or IPv4 address[,...] (up to 3, tried in order)
 SERVER = "%s"
+# POSIX time zone (optional)
+TZ = "%s"
 
 [CLOCK]
 
@@ -338,14 +667,23 @@ SERVER = "%s"
 PASS_COLOR = 0x%04X
 # RGB565
 FAIL_COLOR = 0x%04X
-# HH:MM
+# HH:MM[,HH:MM...] (up to 4 time windows)
 PASS_FROM = "%s"
-# HH:MM
+# HH:MM[,HH:MM...] (same number of times as PASS_FROM)
 PASS_TO = "%s"
-# digital, analog
+# digital, analog or the name of a clock face in /faces
 TYPE = "%s"
+# none, tick, sweep (analog only)
+SECONDS = "%s"
+# frames per second of the sweeping seconds hand (1..30)
+FPS = %lu
+
+[POWER]
+
+# none, modem, light
+MODE = "%s"
 )";
-		File file = LittleFS.open(CONFIG_FILE, FILE_WRITE, true);
+		File file = LittleFS.open(CONFIG_FILE CONFIG_TEMP_SUFFIX, FILE_WRITE, true);
 		if ( ! file ) {
 			return false;
 		}
@@ -357,19 +695,155 @@ TYPE = "%s"
 			this->otaPass,
 			this->ntpTimeout,
 			this->ntpServer,
+			this->ntpTz,
 			this->clockPassColor,
 			this->clockFailColor,
 			this->clockPassFrom,
 			this->clockPassTo,
-			this->clockType
+			this->clockType,
+			this->clockSeconds,
+			this->clockFps,
+			this->powerMode
 		) <= 0) {
 			file.close();
+			LittleFS.remove(CONFIG_FILE CONFIG_TEMP_SUFFIX);
+			return false;
+		}
+		file.close();
+		/* replace the previous file only once the new one is complete */
+		if ( ! LittleFS.rename(CONFIG_FILE CONFIG_TEMP_SUFFIX, CONFIG_FILE) ) {
+			LittleFS.remove(CONFIG_FILE CONFIG_TEMP_SUFFIX);
+			return false;
+		}
+		return this->storeShadow();
+	}
+
+	/**
+	 * Loads the system configuration from the binary shadow file.
+	 * See `CONFIG_SHADOW_FILE`. This fails if the configuration file
+	 * (see `CONFIG_FILE`) changed since the shadow file was written or
+	 * if the shadow file was written by a firmware with a different
+	 * `CONFIG_SHADOW_VERSION`.
+	 *
+	 * @return true on success, else false
+	 */
+	bool loadShadow() {
+		static Config tmp;
+		ShadowHeader header;
+		uint32_t iniSize, iniTime;
+		if ( ! Config::iniStat(iniSize, iniTime) ) {
+			return false;
+		}
+		File file = LittleFS.open(CONFIG_SHADOW_FILE, FILE_READ);
+		if ( ! file ) {
+			return false;
+		}
+		const bool complete = file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) == sizeof(header)
+			&& file.read(reinterpret_cast<uint8_t *>(&tmp), sizeof(tmp)) == sizeof(tmp);
+		file.close();
+		if (( ! complete )
+			|| header.magic != CONFIG_SHADOW_MAGIC
+			|| header.version != CONFIG_SHADOW_VERSION
+			|| header.size != sizeof(Config)
+			|| header.crc != esp_rom_crc32_le(0, reinterpret_cast<const uint8_t *>(&tmp), sizeof(tmp))) {
+			log_w("Ignoring invalid configuration shadow file.");
+			return false;
+		}
+		if (header.iniSize != iniSize || header.iniTime != iniTime) {
+			return false; /* configuration file modified */
+		}
+		*this = tmp;
+		return true;
+	}
+
+	/**
+	 * Stores the system configuration in the binary shadow file.
+	 * See `CONFIG_SHADOW_FILE`. The configuration file (see `CONFIG_FILE`)
+	 * needs to be up to date as its size and modification time are recorded.
+	 *
+	 * @return true on success, else false
+	 */
+	bool storeShadow() const {
+		ShadowHeader header;
+		header.magic = CONFIG_SHADOW_MAGIC;
+		header.version = CONFIG_SHADOW_VERSION;
+		header.size = sizeof(Config);
+		if ( ! Config::iniStat(header.iniSize, header.iniTime) ) {
+			return false;
+		}
+		header.crc = esp_rom_crc32_le(0, reinterpret_cast<const uint8_t *>(this), sizeof(Config));
+		File file = LittleFS.open(CONFIG_SHADOW_FILE CONFIG_TEMP_SUFFIX, FILE_WRITE, true);
+		if ( ! file ) {
 			return false;
 		}
+		const bool complete = file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header)) == sizeof(header)
+			&& file.write(reinterpret_cast<const uint8_t *>(this), sizeof(Config)) == sizeof(Config);
 		file.close();
+		if (( ! complete ) || ( ! LittleFS.rename(CONFIG_SHADOW_FILE CONFIG_TEMP_SUFFIX, CONFIG_SHADOW_FILE) )) {
+			LittleFS.remove(CONFIG_SHADOW_FILE CONFIG_TEMP_SUFFIX);
+			return false;
+		}
 		return true;
 	}
+
+	/**
+	 * Writes the web editable part of the system configuration as JSON object.
+	 *
+	 * @param[in,out] json - JSON writer to use
+	 */
+	void toJson(JsonWriter & json) const noexcept {
+		json.beginObject();
+		json.key("mdns").beginObject();
+		json.key("host").value(this->mdnsHost);
+		json.endObject();
+		json.key("ntp").beginObject();
+		json.key("timeout").value(this->ntpTimeout);
+		json.key("server").value(this->ntpServer);
+		json.key("tz").value(this->ntpTz);
+		json.endObject();
+		json.key("clock").beginObject();
+		json.key("passColor").hexValue(fromRgb565(this->clockPassColor), 6, "#");
+		json.key("failColor").hexValue(fromRgb565(this->clockFailColor), 6, "#");
+		json.key("passFrom").value(this->clockPassFrom);
+		json.key("passTo").value(this->clockPassTo);
+		json.key("type").value(this->clockType);
+		json.key("seconds").value(this->clockSeconds);
+		json.key("fps").value(this->clockFps);
+		json.endObject();
+		json.endObject();
+	}
 private:
+	/**
+	 * Header of the binary shadow file followed by the `Config` data.
+	 */
+	struct ShadowHeader {
+		uint32_t magic; /**< Always `CONFIG_SHADOW_MAGIC`. */
+		uint32_t version; /**< Always `CONFIG_SHADOW_VERSION`. */
+		uint32_t size; /**< Size of the `Config` data in bytes. */
+		uint32_t iniSize; /**< Size of the configuration file in bytes. */
+		uint32_t iniTime; /**< Modification time of the configuration file. */
+		uint32_t crc; /**< CRC32 of the `Config` data. */
+	};
+
+	/**
+	 * Returns the size and modification time of the configuration file.
+	 * See `CONFIG_FILE`.
+	 *
+	 * @param[out] size - file size in bytes
+	 * @param[out] time - modification time
+	 * @return true on success, else false
+	 */
+	static bool iniStat(uint32_t & size, uint32_t & time) {
+		File file = LittleFS.open(CONFIG_FILE, FILE_READ);
+		if ( ! file ) {
+			return false;
+		}
+		size = uint32_t(file.size());
+		time = uint32_t(file.getLastWrite());
+		file.close();
+		return true;
+	}
+
 	/**
 	 * Checks if the given string is a valid domain name label according to RFC1035 Ch. 2.3.1.
 	 * A label may be terminated by a null-terminator or dot.
@@ -400,22 +874,20 @@ private:
 	}
 
 	/**
-	 * Checks if the given string is a valid time in the format `HH:MM`.
+	 * Checks if the given string is a valid host name or IPv4 address.
 	 *
 	 * @param[in] str - string to check
 	 * @return if valid, else false
 	 */
-	static bool checkTime(const char * str) noexcept {
-		if (!isdigit(str[0]) || !isdigit(str[1]) || str[2] != ':'
-			|| !isdigit(str[3]) || !isdigit(str[4]) || str[5] != 0) {
-			return false;
-		}
-		const uint32_t hour = uint32_t(((str[0] - '0') * 10) + str[1] - '0');
-		if (hour > 23) {
-			return false;
+	static bool checkHost(const char * str) noexcept {
+		/* ^(([a-zA-Z]([0-9a-zA-Z-]{0,61}[0-9a-zA-Z])?(\.[a-zA-Z]([0-9a-zA-Z-]{0,61}[0-9a-zA-Z])?)*)|(((25[0-5]|(2[0-4]|1\d|[1-9]|)\d)\.?\b){4}))$ */
+		if ( Config::checkIpv4(str) ) {
+			return true;
 		}
-		const uint32_t minute = uint32_t(((str[3] - '0') * 10) + str[4] - '0');
-		if (minute > 59) {
+		do {
+			str = Config::checkDomainLabel(str);
+		} while (str != NULL && *str == '.');
+		if (str == NULL || *str != 0) {
 			return false;
 		}
 		return true;
@@ -450,326 +922,1431 @@ private:
 
 
 /**
- * Holds the current system configuration.
+ * Passing time windows of a system configuration in minutes since midnight.
  */
-static Config config{{0}, {0}, {0}, {0}, 0, {0}, 0, 0, {0}, {0}, {0}};
-
+struct ClockSchedule {
+	uint16_t from[Config::MAX_WINDOWS]; /**< Starting times (inclusive). */
+	uint16_t to[Config::MAX_WINDOWS]; /**< Ending times (exclusive). */
+	size_t count; /**< Number of time windows. */
 
-/**
- * Holds a system state.
- */
-struct State {
-	bool wifiOnline; /**< True if WIFI is connected in online, else false. */
-	bool otaStarted; /**< True if the Over-the-Air updater has been started, else false. */
-	bool ntpStarted; /**< True if the NTP client has been started, else false. */
-	bool clockChanged; /**< True if the clock type has been changed, else false. */
-	bool configChanged; /**< True if the configuration has been changed and needs to be stored, else false. */
-	char time[Config::TIME_SIZE + 1]; /**< Time string used for display. */
+	/**
+	 * Sets the time windows from the given configuration.
+	 *
+	 * @param[in] config - system configuration
+	 */
+	void set(const Config & config) noexcept {
+		const size_t nFrom = Config::parseTimes(config.clockPassFrom, this->from);
+		const size_t nTo = Config::parseTimes(config.clockPassTo, this->to);
+		this->count = (nFrom < nTo) ? nFrom : nTo;
+	}
 
 	/**
-	 * Assignment operator.
+	 * Checks whether the given time is within any of the time windows.
+	 * A window with an ending time before its starting time wraps past midnight.
 	 *
-	 * @param[in] o - object to assign
-	 * @return this
+	 * @param[in] minute - time in minutes since midnight or -1 if unknown
+	 * @return true if within, else false
 	 */
-	State & operator= (const State & o) noexcept {
-		if (this != &o) {
-			this->wifiOnline = o.wifiOnline;
-			this->otaStarted = o.otaStarted;
-			this->ntpStarted = o.ntpStarted;
-			this->clockChanged = o.clockChanged;
-			this->configChanged = o.configChanged;
-			memcpy(this->time, o.time, Config::TIME_SIZE);
+	bool contains(const int minute) const noexcept {
+		if (minute < 0) {
+			return false;
+		}
+		for (size_t i = 0; i < this->count; i++) {
+			const int a = int(this->from[i]);
+			const int b = int(this->to[i]);
+			if (a <= b) {
+				if (minute >= a && minute < b) {
+					return true;
+				}
+			} else if (minute >= a || minute < b) {
+				return true;
+			}
 		}
-		return *this;
+		return false;
 	}
+};
+
+
+/**
+ * Immutable and versioned system configuration snapshot.
+ * See `ConfigRef` and `configPublish()`.
+ */
+struct ConfigSnapshot {
+	Config config; /**< System configuration. */
+	ClockSchedule schedule; /**< Passing time windows derived from `config`. */
+	uint32_t version; /**< Incremented with each published snapshot. */
+	std::atomic<uint32_t> readers; /**< Number of active `ConfigRef` objects. */
+};
 
+
+#define CONFIG_SNAPSHOTS 3 /* number of configuration snapshot slots */
+#define CONFIG_PUBLISH_RETRIES 10 /* ticks to wait for a free snapshot slot */
+static ConfigSnapshot configSlots[CONFIG_SNAPSHOTS];
+/** Currently published configuration snapshot. */
+static std::atomic<ConfigSnapshot *> configCurrent(configSlots);
+
+
+enum ConfigEvent {
+	CONFIG_EV_NTP   = 0x01, /**< NTP client needs to be restarted. */
+	CONFIG_EV_CLOCK = 0x02, /**< Clock needs to be redrawn completely. */
+	CONFIG_EV_REBOOT = 0x04 /**< Store pending changes and reboot. */
+};
+/** Pending `ConfigEvent` flags for the main loop. */
+static std::atomic<uint32_t> configEvents(0);
+/** Version of the configuration snapshot stored on flash. */
+static uint32_t configStoredVersion = 0;
+
+
+/**
+ * Non-blocking read access to the currently published system configuration.
+ * The referenced snapshot stays valid and unchanged for the lifetime of this object.
+ */
+class ConfigRef {
+private:
+	ConfigSnapshot * snapshot; /**< Referenced snapshot. */
+public:
 	/**
-	 * Update stored time string from NTP client.
+	 * Constructor. References the current configuration snapshot.
 	 */
-	void updateNtp() noexcept {
-		const char * newTime = NTP.getTimeStr() ;
-		memset(this->time, 0, Config::TIME_SIZE);
-		if (newTime != NULL) {
-			for (size_t i = 0; i < Config::TIME_SIZE && newTime[i] != 0; i++) {
-				this->time[i] = newTime[i];
+	ConfigRef() noexcept {
+		for (;;) {
+			this->snapshot = configCurrent.load();
+			this->snapshot->readers.fetch_add(1);
+			if (configCurrent.load() == this->snapshot) {
+				break; /* still current -> will not be reused before release */
 			}
+			this->snapshot->readers.fetch_sub(1);
 		}
 	}
 
+	ConfigRef(const ConfigRef &) = delete;
+	ConfigRef & operator= (const ConfigRef &) = delete;
+
 	/**
-	 * Reset online states.
+	 * Destructor. Releases the referenced snapshot.
 	 */
-	inline void setOffline() {
-		this->otaStarted = false;
-		ArduinoOTA.end();
-		this->ntpStarted = false;
-		memset(this->time, 0, Config::TIME_SIZE + 1);
+	~ConfigRef() noexcept {
+		this->snapshot->readers.fetch_sub(1);
 	}
 
 	/**
-	 * Checks whether the stored time string is within the given range.
+	 * Returns the version of the referenced snapshot.
 	 *
-	 * @param[in] from - including start time
-	 * @param[in] to - excluding end time
-	 * @return true if within, else false
+	 * @return snapshot version
 	 */
-	inline bool withinTimeSpan(const char * from, const char * to) const noexcept {
-		return strcmp(this->time, from) >= 0 && strcmp(this->time, to) < 0;
+	inline uint32_t version() const noexcept {
+		return this->snapshot->version;
+	}
+
+	/**
+	 * Returns the passing time windows of the referenced snapshot.
+	 *
+	 * @return passing time windows
+	 */
+	inline const ClockSchedule & schedule() const noexcept {
+		return this->snapshot->schedule;
+	}
+
+	/**
+	 * Member access operator.
+	 *
+	 * @return referenced configuration
+	 */
+	inline const Config * operator-> () const noexcept {
+		return &(this->snapshot->config);
+	}
+
+	/**
+	 * Dereference operator.
+	 *
+	 * @return referenced configuration
+	 */
+	inline const Config & operator* () const noexcept {
+		return this->snapshot->config;
 	}
 };
 
 
 /**
- * Holds the most recent system state.
+ * Per request state of an incrementally parsed `POST /config` body.
+ * The INI parser is constructed once during setup and reset for each request
+ * to parse the body without any heap allocation.
+ * Only accessed from the web server task.
  */
-static State state{false, false, false, false, false, false, 0, 0};
+struct ConfigUpload {
+	/** INI parser type used for the request body. */
+	typedef IniParserSized<16, sizeof(IniParser::KeyMap<Config>::Mapper)> Parser;
+	AsyncWebServerRequest * request; /**< Owning request or `NULL` if unused. */
+	Config config; /**< Received configuration values. */
+	uint32_t found; /**< Bitmask of the received configuration keys. */
+	size_t received; /**< Number of body bytes received so far. */
+	bool failed; /**< True if the body could not be parsed, else false. */
+	alignas(Parser) uint8_t parser[sizeof(Parser)]; /**< Storage for the INI parser (see `configUploadInit()`). */
+
+	/**
+	 * Returns the INI parser of this upload.
+	 *
+	 * @return INI parser
+	 */
+	inline Parser & ini() noexcept {
+		return *reinterpret_cast<Parser *>(this->parser);
+	}
+};
+
+
+#define CONFIG_UPLOADS 2 /* maximum number of concurrent POST /config requests */
+static ConfigUpload configUploads[CONFIG_UPLOADS];
+
+
+/**
+ * Holds a system state.
+ */
+struct State {
+	bool wifiOnline; /**< True if WIFI is connected in online, else false. */
+	bool otaStarted; /**< True if the Over-the-Air updater has been started, else false. */
+	bool ntpStarted; /**< True if the NTP client has been started, else false. */
+	int16_t minute; /**< Local time in minutes since midnight used for display or -1 if unknown. */
+
+	/**
+	 * Not equal to comparison operator.
+	 *
+	 * @param[in] o - object to compare with
+	 * @return true if not equal, else false
+	 */
+	inline bool operator!= (const State & o) const noexcept {
+		return this->wifiOnline != o.wifiOnline || this->otaStarted != o.otaStarted
+			|| this->ntpStarted != o.ntpStarted || this->minute != o.minute;
+	}
+
+	/**
+	 * Update stored time from system time as set by the NTP client.
+	 */
+	void updateTime() noexcept {
+		const time_t now = time(NULL);
+		struct tm local;
+		if (localtime_r(&now, &local) == NULL) {
+			this->minute = -1;
+			return;
+		}
+		this->minute = int16_t((local.tm_hour * 60) + local.tm_min);
+	}
+
+	/**
+	 * Formats the stored time as `HH:MM` string.
+	 *
+	 * @param[out] str - receives the null-terminated time string or an empty string if unknown
+	 */
+	void formatTime(char (&str)[Config::TIME_SIZE + 1]) const noexcept {
+		if (this->minute < 0) {
+			str[0] = 0;
+			return;
+		}
+		const unsigned hour = unsigned(this->minute / 60);
+		const unsigned min = unsigned(this->minute % 60);
+		str[0] = char('0' + (hour / 10));
+		str[1] = char('0' + (hour % 10));
+		str[2] = ':';
+		str[3] = char('0' + (min / 10));
+		str[4] = char('0' + (min % 10));
+		str[5] = 0;
+	}
+
+	/**
+	 * Reset online states.
+	 */
+	inline void setOffline() {
+		this->otaStarted = false;
+		ArduinoOTA.end();
+		this->ntpStarted = false;
+		this->minute = -1;
+	}
+};
+
+
+/**
+ * Holds the most recent system state.
+ */
+static State state{false, false, false, -1};
+
+
+/** Display modes of the seconds clock hand. */
+enum RenderSeconds {
+	RENDER_SECONDS_NONE,  /**< No seconds clock hand. */
+	RENDER_SECONDS_TICK,  /**< Seconds clock hand moves once per second. */
+	RENDER_SECONDS_SWEEP  /**< Seconds clock hand moves smoothly at the target frame rate. */
+};
+
+
+/**
+ * Display update passed from the main loop to the render task.
+ * This holds everything needed to draw the clock so that no
+ * global object needs to be accessed while rendering.
+ */
+struct RenderJob {
+	State state; /**< System state snapshot to display. */
+	bool clockChanged; /**< True if the whole screen needs to be redrawn, else false. */
+	bool digital; /**< True to display the digital clock, false for the analog clock. */
+	char face[FACE_NAME_SIZE + 1]; /**< Analog clock face name (see `faceGet()`). */
+	uint16_t color; /**< Clock color in RGB565. */
+	uint8_t seconds; /**< Seconds clock hand mode (see `RenderSeconds`). */
+	uint8_t fps; /**< Target frame rate in `RENDER_SECONDS_SWEEP` mode. */
+};
+
+
+/**
+ * Frame statistics of the render task as reported via `GET /status`.
+ * Updated once per second while the seconds clock hand is animated.
+ */
+struct RenderStats {
+	std::atomic<uint32_t> fps; /**< Frames drawn within the last window. */
+	std::atomic<uint32_t> frameUs; /**< Average frame time within the last window in microseconds. */
+	std::atomic<uint32_t> frameMaxUs; /**< Maximum frame time within the last window in microseconds. */
+	std::atomic<uint32_t> dropped; /**< Total number of frames dropped to keep up with the wall clock. */
+	std::atomic<uint32_t> updated; /**< `millis()` at the end of the last window. */
+};
+
+
+static RenderStats renderStats;
+
+
+/** Measured stages reported via `GET /metrics`. */
+enum MetricsStage {
+	METRICS_LOOP,    /**< Main loop iteration until the display update is passed on. */
+	METRICS_STATE,   /**< State refresh of the main loop. */
+	METRICS_OTA,     /**< `ArduinoOTA.handle()`. */
+	METRICS_NTP,     /**< NTP client start and time update. */
+	METRICS_EVENTS,  /**< Server-Sent Events update. */
+	METRICS_STORE,   /**< Storing the configuration on flash. */
+	METRICS_FRAME,   /**< Whole frame within the render task. */
+	METRICS_FLATTEN, /**< Flattening of SVG paths into edges per frame. */
+	METRICS_SORT,    /**< Sorting of the edges per frame. */
+	METRICS_FILL,    /**< Scanline traversal of the edges per frame without `METRICS_BLEND`. */
+	METRICS_BLEND,   /**< Blending into the RGB565 frame buffer per frame. */
+	METRICS_PUSH,    /**< Transfer to the display per frame. */
+	METRICS_STAGES   /**< Number of stages. */
+};
+
+
+/** Names of the stages in `MetricsStage` order. */
+static const char * const metricsNames[METRICS_STAGES] = {
+	"loop", "state", "ota", "ntp", "events", "store", "frame", "flatten", "sort", "fill", "blend", "push"
+};
+/** Duration statistics per stage in microseconds. */
+static Metric<> metrics[METRICS_STAGES];
+/** Guards `metrics` and `ntpManager` against torn copies by `GET /metrics`. */
+static portMUX_TYPE metricsLock = portMUX_INITIALIZER_UNLOCKED;
+/** Copy of `metrics` sent by `GET /metrics` to produce the same document for each chunk. */
+static Metric<> metricsSnapshot[METRICS_STAGES];
+/** Request sending the snapshot or `NULL` if none. Only one is served at a time. */
+static const AsyncWebServerRequest * metricsRequest = NULL;
+/** CPU clock in MHz to convert cycles to microseconds. */
+static uint32_t metricsCpuMhz = 240;
+/** CPU cycles spent transferring the current frame to the display. */
+static uint32_t metricsPushCycles = 0;
+/** Copy of `ntpManager` sent by `GET /metrics`. */
+static NtpManager metricsNtp;
+
+
+/* NTP */
+/**
+ * Result of an NTP request as reported by the NTP client task.
+ */
+struct NtpResult {
+	bool ok; /**< True if the server responded, else false. */
+	int32_t offsetUs; /**< Clock offset to the server in microseconds. */
+	uint32_t delayUs; /**< Round trip time in microseconds. */
+};
+/** Passes the NTP request results from the NTP client task to the main loop. */
+static QueueHandle_t ntpQueue = NULL;
+/** Keeps the NTP statistics and selects server and poll interval. Only modified by the main loop. */
+static NtpManager ntpManager;
 
 
 /* web server */
 AsyncWebServer server(80);
+/** Live status feed via Server-Sent Events. */
+static AsyncEventSource eventsSource("/events");
+/** Last `millis()` when a web request was received. */
+static std::atomic<uint32_t> webLast(0);
+/** Set if a new live status feed client connected and needs all values. */
+static std::atomic<bool> eventsResync(false);
+/** State last sent to the live status feed clients. */
+static State eventsState{false, false, false, -1};
+/** Backlight index last sent to the live status feed clients. */
+static size_t eventsBl = 0;
+/** ID of the last live status feed event. */
+static uint32_t eventsId = 0;
 
 
 /**
- * Converts an RGB565 value to an RGB24 value.
+ * Publishes a new system configuration snapshot.
+ * Readers holding a `ConfigRef` continue to see their previous snapshot.
+ * This needs to be called from a single writer task only.
  *
- * @param[in] val - RGB565 value
- * @return RGB24 value
+ * @param[in] newConfig - configuration to publish
+ * @return true on success, false if all other snapshots are still referenced
  */
-static inline uint32_t fromRgb565(const uint32_t val) noexcept {
-	const uint32_t r = (val << 8) & 0xF80000UL;
-	const uint32_t g = (val << 5) & 0xFC00UL;
-	const uint32_t b = (val << 3) & 0xF8UL;
-	return r | g | b;
+static bool configPublish(const Config & newConfig) noexcept {
+	ConfigSnapshot * current = configCurrent.load();
+	for (size_t retry = 0; retry < CONFIG_PUBLISH_RETRIES; retry++) {
+		for (ConfigSnapshot & slot : configSlots) {
+			if (&slot == current || slot.readers.load() != 0) {
+				continue;
+			}
+			slot.config = newConfig;
+			slot.schedule.set(newConfig);
+			slot.version = current->version + 1;
+			configCurrent.store(&slot);
+			return true;
+		}
+		vTaskDelay(1); /* wait for readers to release an old snapshot */
+	}
+	return false;
 }
 
 
 /**
- * Interrupt handler for the UP button.
+ * Stores the current configuration on flash if it changed since last stored.
+ * This needs to be called from the main loop task only.
  */
-static void IRAM_ATTR buttonUpIsr() noexcept {
-	const uint32_t now = millis();
-	if ((now - bUpLast) < 250) {
+static void configStore() noexcept {
+	const ConfigRef config;
+	if (config.version() == configStoredVersion) {
 		return;
 	}
-	bUpLast = now;
-	tftBlIndex++;
-	if (tftBlIndex >= ARRAY_SIZE(tftBl)) {
-		tftBlIndex = 0;
+	if ( ! config->store() ) {
+		log_e("Failed to store new configuration on flash.");
 	}
-	analogWrite(TFT_BACKLIGHT, tftBl[tftBlIndex]);
+	configStoredVersion = config.version();
 }
 
 
 /**
- * Interrupt handler for the DOWN button.
+ * Returns the configuration upload of the given request.
+ *
+ * @param[in] request - web request
+ * @return upload or `NULL` if none is assigned
  */
-static void IRAM_ATTR buttonDownIsr() noexcept {
-	const uint32_t now = millis();
-	if ((now - bDownLast) < 250) {
-		return;
+static ConfigUpload * configUploadFind(const AsyncWebServerRequest * request) noexcept {
+	for (ConfigUpload & upload : configUploads) {
+		if (upload.request == request) {
+			return &upload;
+		}
 	}
-	bDownLast = now;
-	if (tftBlIndex == 0) {
-		tftBlIndex = size_t(ARRAY_SIZE(tftBl) - 1);
-	} else {
-		tftBlIndex--;
+	return NULL;
+}
+
+
+/**
+ * Constructs the INI parsers of all configuration uploads.
+ * These map the web configurable keys to the configuration of the upload.
+ */
+static void configUploadInit() noexcept {
+	const IniParser::KeyMap<Config> & keys = Config::keys();
+	for (ConfigUpload & upload : configUploads) {
+		upload.request = NULL;
+		new (upload.parser) ConfigUpload::Parser(keys.mapper(upload.config, upload.found, keys.select(Config::KEY_WEB)));
 	}
-	analogWrite(TFT_BACKLIGHT, tftBl[tftBlIndex]);
 }
 
 
 /**
- * Returns the SVG shape with the given ID
+ * Releases the configuration upload of the given request if any.
  *
- * @param[in] id - shape ID
- * @return shape or `NULL` if not found
+ * @param[in] request - web request
  */
-static NSVGshape * svgGetShape(const char * id) noexcept {
-	NSVGshape * shape;
-	for (shape = svgImg->shapes; shape != NULL; shape = shape->next) {
-		if (strcmp(shape->id, id) == 0) {
-			break;
-		}
+static void configUploadEnd(const AsyncWebServerRequest * request) noexcept {
+	ConfigUpload * upload = configUploadFind(request);
+	if (upload != NULL) {
+		upload->request = NULL;
 	}
-	return shape;
 }
 
 
 /**
- * Creates a copy of all paths from the SVG shape of the given ID.
+ * Assigns a free configuration upload to the given request.
+ * The upload is released once the request completes or the client disconnects.
  *
- * @param[in] id - shape ID
- * @return allocated paths or `NULL` on allocation error
- */
-static NSVGpath * svgDuplicateShapePaths(const char * id) noexcept {
-	NSVGshape * shape = svgGetShape(id);
-	if (shape == NULL) {
-		return NULL; /* ID not found */
-	}
-	NSVGpath * res = NULL, * ptr = NULL;
-	for (NSVGpath * path = shape->paths; path != NULL; path = path->next) {
-		if (res == NULL) {
-			res = nsvgDuplicatePath(path);
-			ptr = res;
+ * @param[in,out] request - web request
+ * @return upload or `NULL` if all are in use
+ */
+static ConfigUpload * configUploadBegin(AsyncWebServerRequest * request) noexcept {
+	configUploadEnd(request);
+	ConfigUpload * upload = configUploadFind(NULL);
+	if (upload == NULL) {
+		return NULL;
+	}
+	upload->request = request;
+	upload->found = 0;
+	upload->received = 0;
+	upload->failed = false;
+	upload->ini().reset();
+	request->onDisconnect([request] () {
+		configUploadEnd(request);
+	});
+	return upload;
+}
+
+
+/**
+ * Wakes up the main loop to process a new event.
+ */
+static void loopWake() noexcept {
+	if (loopTask != NULL) {
+		xTaskNotifyGive(loopTask);
+	}
+}
+
+
+/**
+ * Wakes up the main loop to process a new event.
+ * This variant is for use within interrupt handlers.
+ */
+static void IRAM_ATTR loopWakeFromIsr() noexcept {
+	if (loopTask != NULL) {
+		BaseType_t woken = pdFALSE;
+		vTaskNotifyGiveFromISR(loopTask, &woken);
+		portYIELD_FROM_ISR(woken);
+	}
+}
+
+
+/**
+ * Passes the NTP request results from the NTP client task to `ntpManager` and
+ * applies the selected server and poll interval to the NTP client.
+ */
+static void ntpUpdate() noexcept {
+	NtpResult res;
+	while (xQueueReceive(ntpQueue, &res, 0) == pdTRUE) {
+		const char * lastServer = ntpManager.server();
+		const uint32_t lastInterval = ntpManager.interval();
+		portENTER_CRITICAL(&metricsLock);
+		if ( res.ok ) {
+			ntpManager.synced(res.offsetUs, res.delayUs);
 		} else {
-			ptr->next = nsvgDuplicatePath(path);
+			ntpManager.failed();
+		}
+		portEXIT_CRITICAL(&metricsLock);
+		if (ntpManager.server() != lastServer) {
+			log_w("NTP server %s failed. Switching to %s.", lastServer, ntpManager.server());
+			NTP.setNtpServerName(ntpManager.server());
 		}
-		if (ptr == NULL) {
-			goto onError;
+		if (ntpManager.interval() != lastInterval) {
+			NTP.setInterval(NtpManager::MIN_INTERVAL, int(ntpManager.interval()));
 		}
-		ptr = ptr->next;
 	}
+}
+
+
+/**
+ * Returns the time until the displayed time changes next.
+ *
+ * @return milliseconds until the next minute boundary
+ */
+static uint32_t msUntilNextMinute() noexcept {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	const uint32_t elapsed = (uint32_t(tv.tv_sec % 60) * 1000) + uint32_t(tv.tv_usec / 1000);
+	return 60000 - elapsed + 1; /* wake up just after the boundary */
+}
+
+
+/**
+ * Initializes the PWM for the TFT back light. The LEDC timer is driven by
+ * the internal 8 MHz oscillator to keep the back light on during light sleep.
+ */
+static void tftInitBacklight() noexcept {
+	ledc_timer_config_t timer = {};
+	timer.speed_mode = LEDC_LOW_SPEED_MODE;
+	timer.duty_resolution = LEDC_TIMER_8_BIT;
+	timer.timer_num = LEDC_TIMER_0;
+	timer.freq_hz = 1000;
+	timer.clk_cfg = LEDC_USE_RTC8M_CLK;
+	ledc_timer_config(&timer);
+	ledc_channel_config_t channel = {};
+	channel.gpio_num = TFT_BACKLIGHT;
+	channel.speed_mode = LEDC_LOW_SPEED_MODE;
+	channel.channel = LEDC_CHANNEL_0;
+	channel.timer_sel = LEDC_TIMER_0;
+	channel.duty = 0;
+	channel.hpoint = 0;
+	ledc_channel_config(&channel);
+	esp_sleep_pd_config(ESP_PD_DOMAIN_RTC8M, ESP_PD_OPTION_ON);
+}
+
+
+/**
+ * Applies the TFT back light intensity selected by `tftBlIndex`.
+ */
+static void tftUpdateBacklight() noexcept {
+	const size_t index = tftBlIndex;
+	if (index == tftBlApplied) {
+		return;
+	}
+	tftBlApplied = index;
+	const uint32_t val = tftBl[index];
+	/* a duty of 256 keeps the output high for the full period */
+	ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, (val >= 255) ? 256 : val);
+	ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0);
+}
+
+
+/**
+ * Sends the changed status values to all live status feed clients (see `eventsSource`).
+ * All values are sent if a new client connected since the last call.
+ *
+ * @param[in] st - current system state
+ */
+static void eventsUpdate(const State & st) noexcept {
+	const bool full = eventsResync.exchange(false);
+	const size_t bl = tftBlApplied;
+	char buf[128];
+	JsonWriter json(buf, sizeof(buf) - 1);
+	bool changed = false;
+	json.beginObject();
+	if (full || st.wifiOnline != eventsState.wifiOnline) {
+		json.key("wifiOnline").value(st.wifiOnline);
+		changed = true;
+	}
+	if (full || st.ntpStarted != eventsState.ntpStarted) {
+		json.key("ntpStarted").value(st.ntpStarted);
+		changed = true;
+	}
+	if (full || st.minute != eventsState.minute) {
+		char str[Config::TIME_SIZE + 1];
+		st.formatTime(str);
+		json.key("time").value(str);
+		changed = true;
+	}
+	if (full || bl != eventsBl) {
+		json.key("backlight").value(tftBl[bl]);
+		changed = true;
+	}
+	if ( ! changed ) {
+		return;
+	}
+	json.key("freeHeap").value(uint32_t(ESP.getFreeHeap()));
+	json.endObject();
+	buf[json.length()] = 0;
+	eventsState = st;
+	eventsBl = bl;
+	if (eventsSource.count() > 0) {
+		eventsSource.send(buf, "status", ++eventsId);
+	}
+}
+
+
+/**
+ * Enables automatic light sleep for the `light` power mode. The system then
+ * enters light sleep whenever all tasks are idle and `powerLock` is not held.
+ * WIFI modem sleep keeps the access point association meanwhile. This needs
+ * a framework built with `CONFIG_PM_ENABLE` and `CONFIG_FREERTOS_USE_TICKLESS_IDLE`.
+ * Only WIFI modem sleep is used otherwise. The calling task holds `powerLock`
+ * until it calls `powerAllowSleep()`.
+ *
+ * @param[in] config - system configuration
+ */
+static void powerInit(const Config & config) noexcept {
+	if (config.powerMode[0] != 'l') {
+		return;
+	}
+#if ESP_IDF_VERSION_MAJOR >= 5
+	esp_pm_config_t pm = {};
+#else /* ESP-IDF 4 */
+	esp_pm_config_esp32_t pm = {};
+#endif /* ESP-IDF 4 */
+	pm.max_freq_mhz = int(ESP.getCpuFreqMHz());
+	pm.min_freq_mhz = pm.max_freq_mhz; /* keep the clock of the display and `metricsCpuMhz` */
+	pm.light_sleep_enable = true;
+	esp_pm_lock_handle_t lock = NULL;
+	if (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "awake", &lock) != ESP_OK) {
+		log_w("Light sleep is not supported. Using modem sleep only.");
+		return;
+	}
+	esp_pm_lock_acquire(lock);
+	if (esp_pm_configure(&pm) != ESP_OK) {
+		log_w("Light sleep is not supported. Using modem sleep only.");
+		esp_pm_lock_release(lock);
+		esp_pm_lock_delete(lock);
+		return;
+	}
+	esp_sleep_enable_gpio_wakeup(); /* see buttonArm() */
+	powerLock = lock;
+}
+
+
+/**
+ * Prevents automatic light sleep until the matching `powerAllowSleep()` call.
+ */
+static inline void powerStayAwake() noexcept {
+	if (powerLock != NULL) {
+		esp_pm_lock_acquire(powerLock);
+	}
+}
+
+
+/**
+ * Allows automatic light sleep again after `powerStayAwake()`.
+ */
+static inline void powerAllowSleep() noexcept {
+	if (powerLock != NULL) {
+		esp_pm_lock_release(powerLock);
+	}
+}
+
+
+/**
+ * Updates the measured awake time per minute (see `powerAwakeMs`).
+ */
+static void powerUpdateStats() noexcept {
+	const int64_t now = esp_timer_get_time();
+	const int64_t elapsed = now - powerWindowStart;
+	if (elapsed < 60000000) {
+		return; /* window not yet completed */
+	}
+	powerAwakeMs = uint32_t(((elapsed - powerWindowSlept) * 60000) / elapsed);
+	powerWindowStart = now;
+	powerWindowSlept = 0;
+}
+
+
+/**
+ * Re-arms the level triggered interrupt of the given button for its next change.
+ * Level triggers are needed to wake up from light sleep. A pressed button
+ * waits for its release without being a wakeup source.
+ *
+ * @param[in] pin - button pin
+ * @return true if the button is pressed, else false
+ */
+static bool IRAM_ATTR buttonArm(const gpio_num_t pin) noexcept {
+	if (gpio_get_level(pin) == 0) {
+		gpio_wakeup_disable(pin);
+		gpio_set_intr_type(pin, GPIO_INTR_HIGH_LEVEL);
+		return true;
+	}
+	gpio_wakeup_enable(pin, GPIO_INTR_LOW_LEVEL);
+	return false;
+}
+
+
+/**
+ * Applies a button press to the TFT back light intensity.
+ * Presses within 250ms of the last one are ignored to debounce the button.
+ *
+ * @param[in,out] last - last `millis()` the button was triggered
+ * @param[in] up - true to increase the intensity, false to decrease it
+ * @return true if the intensity changed, else false
+ */
+static bool IRAM_ATTR buttonPress(uint32_t & last, const bool up) noexcept {
+	const uint32_t now = millis();
+	if ((now - last) < 250) {
+		return false;
+	}
+	last = now;
+	const size_t index = tftBlIndex;
+	if ( up ) {
+		tftBlIndex = (index + 1 < ARRAY_SIZE(tftBl)) ? index + 1 : 0;
+	} else {
+		tftBlIndex = (index > 0) ? index - 1 : size_t(ARRAY_SIZE(tftBl) - 1);
+	}
+	return true;
+}
+
+
+/**
+ * Interrupt handler for the UP button.
+ */
+static void IRAM_ATTR buttonUpIsr() noexcept {
+	if (buttonArm(gpio_num_t(BUTTON_UP)) && buttonPress(bUpLast, true)) {
+		loopWakeFromIsr(); /* apply new back light intensity */
+	}
+}
+
+
+/**
+ * Interrupt handler for the DOWN button.
+ */
+static void IRAM_ATTR buttonDownIsr() noexcept {
+	if (buttonArm(gpio_num_t(BUTTON_DOWN)) && buttonPress(bDownLast, false)) {
+		loopWakeFromIsr(); /* apply new back light intensity */
+	}
+}
+
+
+/**
+ * Adds a measured duration to the statistics of the given stage.
+ * Each stage may only be measured by a single task.
+ *
+ * @param[in] stage - measured stage
+ * @param[in] cycles - duration in CPU cycles
+ */
+static inline void metricsAdd(const MetricsStage stage, const uint32_t cycles) noexcept {
+	portENTER_CRITICAL(&metricsLock);
+	metrics[stage].add(cycles / metricsCpuMhz);
+	portEXIT_CRITICAL(&metricsLock);
+}
+
+
+/**
+ * Adds the duration since the given start to the statistics of the given stage.
+ *
+ * @param[in] stage - measured stage
+ * @param[in] start - `ESP.getCycleCount()` at the start of the stage
+ */
+static inline void metricsEnd(const MetricsStage stage, const uint32_t start) noexcept {
+	metricsAdd(stage, ESP.getCycleCount() - start);
+}
+
+
+/**
+ * Adds the rasterizer and display transfer durations of the current
+ * frame to the statistics and resets them for the next frame.
+ */
+static void metricsEndFrame() noexcept {
+	const uint32_t raster = svgStageCycles[NSVG_PROFILE_FLATTEN] | svgStageCycles[NSVG_PROFILE_SORT] | svgStageCycles[NSVG_PROFILE_FILL];
+	if (raster != 0) {
+		metricsAdd(METRICS_FLATTEN, svgStageCycles[NSVG_PROFILE_FLATTEN]);
+		metricsAdd(METRICS_SORT, svgStageCycles[NSVG_PROFILE_SORT]);
+		metricsAdd(METRICS_FILL, svgStageCycles[NSVG_PROFILE_FILL] - svgStageCycles[NSVG_PROFILE_BLEND]);
+		metricsAdd(METRICS_BLEND, svgStageCycles[NSVG_PROFILE_BLEND]);
+	}
+	metricsAdd(METRICS_PUSH, metricsPushCycles);
+	memset(svgStageCycles, 0, sizeof(svgStageCycles));
+	metricsPushCycles = 0;
+}
+
+
+#ifdef SVG_ARENA
+/**
+ * Allocates the analog clock arena. Internal RAM is preferred over PSRAM
+ * as the rasterizer buffers are accessed for every rendered band.
+ *
+ * @param[in] size - number of bytes to allocate
+ * @return allocated memory or `NULL`
+ */
+static void * svgArenaAlloc(size_t size) noexcept {
+	void * res = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#ifdef BOARD_HAS_PSRAM
+	if (res == NULL) {
+		res = ps_malloc(size);
+	}
+#endif /* BOARD_HAS_PSRAM */
 	return res;
-onError:
-	nsvg__deletePaths(res);
-	return NULL;
 }
+#endif /* SVG_ARENA */
+
+
+/**
+ * Output sink of the clock renderers which flushes the rendered bands
+ * to the screen. In strip mode (see `SVG_STRIP_LINES`) the next band is
+ * rasterized while the previous one is transferred via DMA.
+ */
+struct TftSink {
+	/**
+	 * Returns the number of pixels per band buffer.
+	 *
+	 * @return band buffer capacity
+	 */
+	inline size_t capacity() const noexcept {
+#ifdef SVG_STRIP_LINES
+		return size_t(320 * SVG_STRIP_LINES);
+#else /* ! SVG_STRIP_LINES */
+		return size_t(320 * 240);
+#endif /* ! SVG_STRIP_LINES */
+	}
+
+	/**
+	 * Returns the given band buffer.
+	 *
+	 * @param[in] band - band buffer index (0 or 1)
+	 * @return band buffer
+	 */
+	inline uint16_t * buffer(const size_t band) const noexcept {
+#ifdef SVG_STRIP_LINES
+		return stripBuf[band];
+#else /* ! SVG_STRIP_LINES */
+		(void)band;
+		return imgBuf;
+#endif /* ! SVG_STRIP_LINES */
+	}
+
+	/**
+	 * Starts the transfer of a new region.
+	 */
+	inline void begin() const noexcept {
+#ifdef SVG_STRIP_LINES
+		tft.startWrite();
+#endif /* SVG_STRIP_LINES */
+	}
+
+	/**
+	 * Flushes the given band to the screen.
+	 *
+	 * @param[in] x - left screen coordinate
+	 * @param[in] y - top screen coordinate
+	 * @param[in] w - width in pixels
+	 * @param[in] h - height in pixels
+	 * @param[in] buf - band buffer in RGB565
+	 */
+	inline void push(const int x, const int y, const int w, const int h, uint16_t * buf) const noexcept {
+		const uint32_t pushStart = ESP.getCycleCount();
+#ifdef SVG_STRIP_LINES
+		tft.pushImageDMA(x, y, w, h, buf); /* waits for the previous band */
+#else /* ! SVG_STRIP_LINES */
+		tft.pushImage(x, y, w, h, buf);
+#endif /* ! SVG_STRIP_LINES */
+		metricsPushCycles += ESP.getCycleCount() - pushStart;
+	}
+
+	/**
+	 * Waits until the region was transferred.
+	 */
+	inline void end() const noexcept {
+#ifdef SVG_STRIP_LINES
+		const uint32_t waitStart = ESP.getCycleCount();
+		tft.dmaWait();
+		tft.endWrite();
+		metricsPushCycles += ESP.getCycleCount() - waitStart;
+#endif /* SVG_STRIP_LINES */
+	}
+};
 
 
 /**
- * Sets the paths for the SVG shape with the given ID to the
- * passed path list. Both lists much match in size.
+ * Loads the analog clock face of the given name into the passed renderer.
+ * The built-in face uses the image compiled at build time. All other faces
+ * are parsed from `FACE_DIR/<name>FACE_SUFFIX`. Only the built-in face
+ * prefers internal RAM for its arena to keep enough for the network stack.
  *
- * @param[in] id - shape ID
- * @param[in] p - path list
+ * @param[out] clock - default constructed renderer
+ * @param[in] name - clock face name
  * @return true on success, else false
  */
-static bool svgSetPaths(const char * id, NSVGpath * p) noexcept {
-	NSVGshape * shape = svgGetShape(id);
-	if (shape == NULL) {
-		return false; /* ID not found */
-	}
-	for (NSVGpath * path = shape->paths; path != NULL; path = path->next) {
-		if (p == NULL || p->npts != path->npts) {
+static bool faceLoad(AnalogClock & clock, const char * name) noexcept {
+	const bool builtin = strcmp(name, FACE_BUILTIN) == 0;
+#ifdef SVG_ARENA
+#ifdef BOARD_HAS_PSRAM
+	const AnalogClock::Allocator arenaAlloc = builtin ? svgArenaAlloc : ps_malloc;
+#else /* ! BOARD_HAS_PSRAM */
+	const AnalogClock::Allocator arenaAlloc = svgArenaAlloc;
+#endif /* ! BOARD_HAS_PSRAM */
+#else /* ! SVG_ARENA */
+	const AnalogClock::Allocator arenaAlloc = NULL;
+#endif /* ! SVG_ARENA */
+#ifdef BOARD_HAS_PSRAM
+	const AnalogClock::Allocator bgAlloc = ps_malloc;
+#else /* ! BOARD_HAS_PSRAM */
+	const AnalogClock::Allocator bgAlloc = NULL;
+#endif /* ! BOARD_HAS_PSRAM */
+#ifdef SVG_HAND_CACHE
+	const AnalogClock::Allocator handAlloc = ps_malloc;
+#else /* ! SVG_HAND_CACHE */
+	const AnalogClock::Allocator handAlloc = NULL;
+#endif /* ! SVG_HAND_CACHE */
+	if ( builtin ) {
+		if ( ! clock.begin(svgImage, bgAlloc, handAlloc, arenaAlloc) ) {
+			log_e("%s", clock.error());
 			return false;
 		}
-		memcpy(path->pts, p->pts, p->npts * sizeof(float) * 2);
-		memcpy(path->bounds, p->bounds, sizeof(p->bounds));
-		p = p->next;
+		return true;
+	}
+	char path[sizeof(FACE_DIR) + FACE_NAME_SIZE + sizeof(FACE_SUFFIX)];
+	snprintf(path, sizeof(path), FACE_DIR "/%s" FACE_SUFFIX, name);
+	File file = LittleFS.open(path, FILE_READ);
+	if ( ! file ) {
+		log_e("Failed to open clock face %s.", path);
+		return false;
+	}
+	const size_t size = file.size();
+#ifdef BOARD_HAS_PSRAM
+	char * svg = static_cast<char *>(ps_malloc(size + 1));
+#else /* ! BOARD_HAS_PSRAM */
+	char * svg = static_cast<char *>(malloc(size + 1));
+#endif /* ! BOARD_HAS_PSRAM */
+	if (svg == NULL) {
+		file.close();
+		log_e("Memory exhausted while trying to read clock face %s.", path);
+		return false;
 	}
-	return p == NULL;
+	const bool complete = file.read(reinterpret_cast<uint8_t *>(svg), size) == size;
+	file.close();
+	svg[size] = 0;
+	bool res = false;
+	if ( ! complete ) {
+		log_e("Failed to read clock face %s.", path);
+	} else if ( ! clock.begin(svg, bgAlloc, handAlloc, arenaAlloc) ) {
+		log_e("Failed to load clock face %s: %s", path, clock.error());
+	} else {
+		res = true;
+	}
+	free(svg);
+	return res;
 }
 
 
 /**
- * Converts an RGB565 value to an SVG RGBA32 value.
+ * Returns the renderer of the analog clock face with the given name.
+ * Faces are loaded on first use and kept within `faceCache` to switch
+ * between them without parsing them again. The built-in face is used
+ * if the requested one cannot be loaded.
  *
- * @param[in] val - RGB565 value
- * @return SVG RGBA32 value
+ * @param[in] name - clock face name
+ * @return renderer or `NULL` if not even the built-in face could be loaded
  */
-static inline uint32_t svgFromRgb565(const uint32_t val) noexcept {
-	const uint32_t r = (val >> 8) & 0xF8UL;
-	const uint32_t g = (val << 5) & 0xFC00UL;
-	const uint32_t b = (val << 19) & 0xF80000UL;
-	const uint32_t a = 0xFF000000UL;
-	return r | g | b | a;
+static AnalogClock * faceGet(const char * name) noexcept {
+	const bool builtin = strcmp(name, FACE_BUILTIN) == 0;
+	AnalogClock * clock = faceCache.get(name);
+	if (clock == NULL && (builtin || strcmp(name, faceFailed) != 0)) {
+		clock = faceCache.add(name);
+		if (clock != NULL) {
+			faceLoads++;
+			if ( ! faceLoad(*clock, name) ) {
+				faceCache.remove(name);
+				clock = NULL;
+			}
+		}
+		if (clock == NULL && ( ! builtin )) {
+			snprintf(faceFailed, sizeof(faceFailed), "%s", name);
+		}
+		faceCached = uint32_t(faceCache.size());
+	}
+	if (clock == NULL && ( ! builtin )) {
+		return faceGet(FACE_BUILTIN);
+	}
+	if (clock != NULL) {
+		faceArena[0] = uint32_t(clock->arenaSize());
+		faceArena[1] = uint32_t(clock->arenaUsed());
+	}
+	return clock;
 }
 
 
 /**
- * Sets the paths for the SVG shape with the given ID to the
- * passed path list. Both lists much match in size.
+ * Draws the clock on the display.
+ * Only the regions of the moved clock hands are redrawn unless the
+ * job requests a full redraw or the clock color changed.
  *
- * @param[in] id - shape ID
- * @param[in] p - path list
- * @return true on success, else false
+ * @param[in] job - display update to draw
+ * @param[in] secPos - position of the seconds clock hand in milliseconds within the minute or -1 to hide it
+ */
+static void renderDraw(const RenderJob & job, const int32_t secPos) noexcept {
+	if ( job.digital ) {
+		/* display digital clock */
+		if ( job.clockChanged ) {
+			tft.fillScreen(TFT_BLACK);
+		}
+		char str[Config::TIME_SIZE + 1];
+		job.state.formatTime(str);
+#ifdef DIGITAL_ATLAS
+		if ( digitalAtlas ) {
+			TftSink sink;
+			if ( digitalClock.draw(sink, str, job.color, job.clockChanged) ) {
+				return;
+			}
+			log_e("%s", digitalClock.error());
+		}
+#endif /* DIGITAL_ATLAS */
+		const uint32_t pushStart = ESP.getCycleCount();
+		tft.setTextColor(job.color, TFT_BLACK);
+		tft.drawString(str, 160, 120);
+		metricsPushCycles += ESP.getCycleCount() - pushStart;
+	} else {
+		/* display analog clock */
+		static AnalogClock * lastClock = NULL;
+		if ( job.clockChanged ) {
+			faceFailed[0] = 0; /* retry after configuration changes */
+		}
+		AnalogClock * clock = faceGet(job.face);
+		if (clock == NULL) {
+			return;
+		}
+		/* another clock face may have been drawn since the last use of this one */
+		const bool full = job.clockChanged || clock != lastClock;
+		lastClock = clock;
+		TftSink sink;
+		const int minute = (job.state.minute < 0) ? 0 : int(job.state.minute); /* 00:00 if no valid time */
+		if ( ! clock->draw(sink, minute, secPos, job.color, full) ) {
+			log_e("%s", clock->error());
+		}
+	}
+}
+
+
+/**
+ * Returns the frame rate of the seconds clock hand for the given display update.
+ *
+ * @param[in] job - display update
+ * @return frames per second or 0 if not animated
  */
-static bool svgSetFill(const char * id, const uint32_t color) {
-	NSVGshape * shape = svgGetShape(id);
-	if (shape == NULL) {
-		return false; /* ID not found */
+static inline int64_t renderFps(const RenderJob & job) noexcept {
+	if (job.digital || job.state.minute < 0) {
+		return 0; /* no seconds clock hand or no valid time */
 	}
-	if (shape->fill.type != NSVG_PAINT_COLOR) {
-		return false; /* not a simple color fill */
+	switch (job.seconds) {
+	case RENDER_SECONDS_TICK: return 1;
+	case RENDER_SECONDS_SWEEP: return int64_t(job.fps);
+	default: return 0;
 	}
-	shape->fill.color = static_cast<unsigned int>(color);
-	return true;
 }
 
 
 /**
- * Transforms the SVG shape of the given ID by the passed angle
- * around the center (160x120).
+ * Returns the current position of the seconds clock hand for the given display update.
+ * The wall clock is divided into frame slots of the target frame rate. Each slot is drawn
+ * at most once.
  *
- * @param[in] id - shape ID
- * @param[in] angle - angle in degrees
- */
-static bool svgRotateShape(const char * id, float angle) noexcept {
-	NSVGshape * shape = svgGetShape(id);
-	if (shape == NULL) {
-		return false; /* ID not found */
-	}
-	/* calculate root transformation matrix */
-	float m[6];
-	float t[6];
-	NSVGpath * path;
-	float bounds[4];
-	float * curve;
-	int i;
-	nsvg__xformIdentity(m);
-	nsvg__xformSetTranslation(t, -160.0f, -120.0f);
-	nsvg__xformMultiply(m, t);
-	nsvg__xformSetRotation(t, angle / 180.0f * NSVG_PI);
-	nsvg__xformMultiply(m, t);
-	nsvg__xformSetTranslation(t, 160.0f, 120.0f);
-	nsvg__xformMultiply(m, t);
-	/* recalculate shape bounds */
-	for (path = shape->paths; path != NULL; path = path->next) {
-		/* apply transformation to paths */
-		for (i = 0; i < path->npts; i++) {
-			nsvg__xformPoint(&path->pts[i * 2], &path->pts[(i * 2) + 1], path->pts[i * 2], path->pts[(i * 2) + 1], m);
-		}
-		for (i = 0; i < (path->npts - 1); i += 3) {
-			curve = &path->pts[i * 2];
-			nsvg__curveBounds(bounds, curve);
-			if (i == 0) {
-				path->bounds[0] = bounds[0];
-				path->bounds[1] = bounds[1];
-				path->bounds[2] = bounds[2];
-				path->bounds[3] = bounds[3];
-			} else {
-				path->bounds[0] = nsvg__minf(path->bounds[0], bounds[0]);
-				path->bounds[1] = nsvg__minf(path->bounds[1], bounds[1]);
-				path->bounds[2] = nsvg__maxf(path->bounds[2], bounds[2]);
-				path->bounds[3] = nsvg__maxf(path->bounds[3], bounds[3]);
+ * @param[in] job - display update
+ * @param[out] slot - current frame slot or -1 if not animated
+ * @param[out] waitUs - time until the next frame slot in microseconds
+ * @return position in milliseconds within the minute or -1 if not animated
+ */
+static int32_t renderSecondsPos(const RenderJob & job, int64_t & slot, int64_t & waitUs) noexcept {
+	const int64_t fps = renderFps(job);
+	slot = -1;
+	waitUs = 0;
+	if (fps <= 0) {
+		return -1;
+	}
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	const int64_t periodUs = 1000000 / fps;
+	const int64_t nowUs = (int64_t(tv.tv_sec) * 1000000) + int64_t(tv.tv_usec);
+	slot = nowUs / periodUs;
+	waitUs = ((slot + 1) * periodUs) - nowUs;
+	/* snap to the start of the slot to reuse positions (and cached edges) of full seconds */
+	const int64_t startUs = slot * periodUs;
+	const time_t start = time_t(startUs / 1000000);
+	struct tm local;
+	if (localtime_r(&start, &local) == NULL) {
+		slot = -1;
+		return -1;
+	}
+	const int32_t ms = int32_t((startUs % 1000000) / 1000);
+	return (int32_t(local.tm_sec % 60) * 1000) + ms;
+}
+
+
+/**
+ * Render task which draws display updates received from the main loop.
+ * This runs on its own core to keep the main loop and the network
+ * handling responsive while drawing. The seconds clock hand is
+ * animated here without involving the main loop. Frames which cannot
+ * be drawn within their slot are dropped instead of delaying the
+ * following ones.
+ *
+ * @param[in] arg - unused
+ */
+static void renderTask(void * /* arg */) noexcept {
+	RenderJob job{};
+	bool haveJob = false;
+	int64_t lastSlot = -1;
+	int64_t windowStart = esp_timer_get_time();
+	uint32_t windowFrames = 0;
+	uint64_t windowUs = 0;
+	uint32_t windowMaxUs = 0;
+	for (;;) {
+		TickType_t wait = portMAX_DELAY;
+		int64_t slot, waitUs;
+		if (haveJob && renderSecondsPos(job, slot, waitUs) >= 0) {
+			if (slot != lastSlot) {
+				waitUs = 0; /* draw the current slot right away */
+			}
+			/* block at least one tick to let lower priority tasks run on this core */
+			wait = pdMS_TO_TICKS(uint32_t((waitUs + 999) / 1000));
+			if (wait < 1) {
+				wait = 1;
 			}
 		}
-		if (path == shape->paths) {
-			shape->bounds[0] = shape->paths->bounds[0];
-			shape->bounds[1] = shape->paths->bounds[1];
-			shape->bounds[2] = shape->paths->bounds[2];
-			shape->bounds[3] = shape->paths->bounds[3];
-		} else {
-			shape->bounds[0] = nsvg__minf(shape->bounds[0], path->bounds[0]);
-			shape->bounds[1] = nsvg__minf(shape->bounds[1], path->bounds[1]);
-			shape->bounds[2] = nsvg__maxf(shape->bounds[2], path->bounds[2]);
-			shape->bounds[3] = nsvg__maxf(shape->bounds[3], path->bounds[3]);
+		RenderJob next;
+		const bool received = (xQueuePeek(renderQueue, &next, wait) == pdTRUE);
+		powerStayAwake(); /* light sleep would stall the display transfer */
+		const int64_t start = esp_timer_get_time();
+		bool draw = false;
+		if (received && xQueueReceive(renderQueue, &job, 0) == pdTRUE) {
+			haveJob = true;
+			draw = true;
+		}
+		const int32_t secPos = haveJob ? renderSecondsPos(job, slot, waitUs) : -1;
+		if (secPos < 0) {
+			lastSlot = -1;
+		} else if (slot != lastSlot) {
+			const int64_t skipped = slot - lastSlot - 1;
+			if (lastSlot >= 0 && skipped > 0 && skipped < renderFps(job)) {
+				renderStats.dropped += uint32_t(skipped); /* larger gaps are time jumps */
+			}
+			lastSlot = slot;
+			draw = true;
+		}
+		if ( draw ) {
+			const uint32_t frameStart = ESP.getCycleCount();
+			renderDraw(job, secPos);
+			metricsEnd(METRICS_FRAME, frameStart);
+			metricsEndFrame();
+			job.clockChanged = false; /* following frames only move the clock hands */
+		}
+		powerAllowSleep();
+		if ( ! draw ) {
+			continue;
+		}
+		/* update frame statistics */
+		const int64_t end = esp_timer_get_time();
+		const uint32_t frameUs = uint32_t(end - start);
+		windowFrames++;
+		windowUs += frameUs;
+		if (frameUs > windowMaxUs) {
+			windowMaxUs = frameUs;
+		}
+		if ((end - windowStart) >= 1000000) {
+			renderStats.fps = uint32_t((uint64_t(windowFrames) * 1000000) / uint64_t(end - windowStart));
+			renderStats.frameUs = uint32_t(windowUs / windowFrames);
+			renderStats.frameMaxUs = windowMaxUs;
+			renderStats.updated = millis();
+			windowStart = end;
+			windowFrames = 0;
+			windowUs = 0;
+			windowMaxUs = 0;
 		}
 	}
+}
+
+
+/**
+ * Returns the CRC32 of the given WIFI connection cache without the `crc` field.
+ *
+ * @param[in] cache - WIFI connection cache
+ * @return CRC32
+ */
+static inline uint32_t wifiCacheCrc(const WifiCache & cache) noexcept {
+	return esp_rom_crc32_le(0, reinterpret_cast<const uint8_t *>(&cache), offsetof(WifiCache, crc));
+}
+
+
+/**
+ * Returns the CRC32 of the given SSID to identify the network of a WIFI connection cache.
+ *
+ * @param[in] ssid - null-terminated SSID
+ * @return CRC32
+ */
+static inline uint32_t wifiSsidCrc(const char * ssid) noexcept {
+	return esp_rom_crc32_le(0, reinterpret_cast<const uint8_t *>(ssid), uint32_t(strlen(ssid)));
+}
+
+
+/**
+ * Loads the WIFI connection cache from `WIFI_CACHE_FILE`.
+ *
+ * @param[in] ssid - SSID of the configured network
+ * @return true if a valid cache of the given network was loaded, else false
+ */
+static bool wifiCacheLoad(const char * ssid) noexcept {
+	WifiCache tmp;
+	File file = LittleFS.open(WIFI_CACHE_FILE, FILE_READ);
+	if ( ! file ) {
+		return false;
+	}
+	const bool complete = file.read(reinterpret_cast<uint8_t *>(&tmp), sizeof(tmp)) == sizeof(tmp);
+	file.close();
+	if (( ! complete ) || tmp.magic != WIFI_CACHE_MAGIC || tmp.crc != wifiCacheCrc(tmp)) {
+		log_w("Ignoring invalid WIFI cache file.");
+		return false;
+	}
+	if (tmp.ssidCrc != wifiSsidCrc(ssid)) {
+		return false; /* other network */
+	}
+	wifiCache = tmp;
+	return true;
+}
+
+
+/**
+ * Stores the WIFI connection cache in `WIFI_CACHE_FILE`.
+ *
+ * @return true on success, else false
+ */
+static bool wifiCacheStore() noexcept {
+	File file = LittleFS.open(WIFI_CACHE_FILE CONFIG_TEMP_SUFFIX, FILE_WRITE, true);
+	if ( ! file ) {
+		return false;
+	}
+	const bool complete = file.write(reinterpret_cast<const uint8_t *>(&wifiCache), sizeof(wifiCache)) == sizeof(wifiCache);
+	file.close();
+	if (( ! complete ) || ( ! LittleFS.rename(WIFI_CACHE_FILE CONFIG_TEMP_SUFFIX, WIFI_CACHE_FILE) )) {
+		LittleFS.remove(WIFI_CACHE_FILE CONFIG_TEMP_SUFFIX);
+		return false;
+	}
 	return true;
 }
 
 
+/**
+ * Starts a new WIFI connection attempt. A direct connection uses the access point
+ * and channel of `wifiCache` to skip the scan. Otherwise, all channels are scanned
+ * for the configured network.
+ *
+ * @param[in] config - system configuration
+ * @param[in] direct - true to connect directly, false to scan
+ */
+static void wifiConnect(const Config & config, const bool direct) noexcept {
+	wifiDirect = direct && wifiCacheValid;
+	wifiConnectStart = millis();
+	WiFi.disconnect();
+	if ( wifiDirect ) {
+#ifdef WIFI_IP_CACHE
+		WiFi.config(IPAddress(wifiCache.ip), IPAddress(wifiCache.gateway), IPAddress(wifiCache.subnet), IPAddress(wifiCache.dns));
+#endif /* WIFI_IP_CACHE */
+		WiFi.begin(config.wifiSsid, config.wifiPass, int32_t(wifiCache.channel), wifiCache.bssid);
+		wifiRetryMs = WIFI_DIRECT_MS;
+	} else {
+#ifdef WIFI_IP_CACHE
+		WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); /* use DHCP */
+#endif /* WIFI_IP_CACHE */
+		WiFi.begin(config.wifiSsid, config.wifiPass);
+		wifiScans++;
+		/* spread the attempts of many devices after a common outage */
+		wifiRetryMs = WIFI_RETRY_MS + (esp_random() % WIFI_RETRY_MS);
+	}
+}
+
+
+/**
+ * Updates the WIFI connection cache after connecting successfully.
+ * The file is only written if the connection parameters changed.
+ *
+ * @param[in] config - system configuration
+ */
+static void wifiConnected(const Config & config) noexcept {
+	wifiConnectMs = millis() - wifiConnectStart;
+	wifiDirect = false;
+	const uint8_t * bssid = WiFi.BSSID();
+	if (bssid == NULL) {
+		return;
+	}
+	WifiCache tmp;
+	memset(&tmp, 0, sizeof(tmp));
+	tmp.magic = WIFI_CACHE_MAGIC;
+	tmp.ssidCrc = wifiSsidCrc(config.wifiSsid);
+	memcpy(tmp.bssid, bssid, sizeof(tmp.bssid));
+	tmp.channel = uint8_t(WiFi.channel());
+	tmp.ip = uint32_t(WiFi.localIP());
+	tmp.gateway = uint32_t(WiFi.gatewayIP());
+	tmp.subnet = uint32_t(WiFi.subnetMask());
+	tmp.dns = uint32_t(WiFi.dnsIP());
+	tmp.crc = wifiCacheCrc(tmp);
+	if (wifiCacheValid && memcmp(&tmp, &wifiCache, sizeof(tmp)) == 0) {
+		return; /* unchanged */
+	}
+	wifiCache = tmp;
+	wifiCacheValid = true;
+	if ( ! wifiCacheStore() ) {
+		log_w("Failed to store WIFI cache file.");
+	}
+}
+
+
+/**
+ * Retries to connect to the configured network once the current attempt timed out.
+ * A failed direct connection falls back to a scan. Further attempts start with
+ * a direct connection again.
+ *
+ * @param[in] config - system configuration
+ * @return time until the next attempt in milliseconds
+ */
+static uint32_t wifiRetry(const Config & config) noexcept {
+	const uint32_t elapsed = millis() - wifiConnectStart;
+	if (elapsed < wifiRetryMs) {
+		return wifiRetryMs - elapsed;
+	}
+	if ( wifiDirect ) {
+		log_w("Failed to connect to the cached WIFI access point. Scanning.");
+		wifiConnect(config, false);
+	} else {
+		wifiConnect(config, true);
+	}
+	return wifiRetryMs;
+}
+
+
+/**
+ * Sends the given embedded web file to the client.
+ * Replies with 304 if the client already has the current version.
+ *
+ * @param[in,out] request - web request to reply to
+ * @param[in] asset - embedded web file
+ */
+static void webSendAsset(AsyncWebServerRequest * request, const WebAsset & asset) noexcept {
+	const AsyncWebHeader * ifNoneMatch = request->getHeader("If-None-Match");
+	AsyncWebServerResponse * response;
+	if (ifNoneMatch != NULL && strcmp(ifNoneMatch->value().c_str(), asset.etag) == 0) {
+		response = request->beginResponse(304);
+	} else {
+		response = request->beginResponse(200, asset.type, asset.data, asset.size);
+		response->addHeader("Content-Encoding", "gzip");
+	}
+	response->addHeader("ETag", asset.etag);
+	response->addHeader("Cache-Control", "no-cache"); /* revalidate to pick up firmware updates */
+	request->send(response);
+}
+
+
+/**
+ * Sends the JSON document created by the given function to the client.
+ * The function is called once to check if the document can be created and
+ * then again for each response chunk without buffering the document. It
+ * needs to create the same document each time and returns false if this is
+ * no longer possible. The chunked response then ends early, which leaves an
+ * incomplete document for the client.
+ *
+ * @param[in,out] request - web request to reply to
+ * @param[in] writeFn - function with the signature `bool writeFn(JsonWriter &)`
+ * @tparam WriteFn - type of `writeFn`
+ */
+template <typename WriteFn>
+static void webSendJson(AsyncWebServerRequest * request, const WriteFn & writeFn) noexcept {
+	JsonWriter probe(NULL, 0);
+	if ( ! writeFn(probe) ) {
+		request->send(503); /* service unavailable */
+		return;
+	}
+	AsyncWebServerResponse * response = request->beginChunkedResponse("application/json",
+		[writeFn] (uint8_t * buffer, const size_t maxLen, const size_t index) -> size_t {
+			JsonWriter json(reinterpret_cast<char *>(buffer), maxLen, index);
+			if ( ! writeFn(json) ) {
+				return 0; /* ends the response */
+			}
+			return json.length(); /* 0 past the end of the document */
+		}
+	);
+	response->addHeader("Cache-Control", "no-cache");
+	request->send(response);
+}
+
+
 /**
  * Initializes the system.
  */
 void setup() {
-	mutex = xSemaphoreCreateBinary();
-	xSemaphoreGive(mutex);
+	loopTask = xTaskGetCurrentTaskHandle();
 	/* mount flash file system */
 	if ( ! LittleFS.begin(false, "/root", 10, "root") ) {
 		log_e("Failed to mount flash file system.");
 		esp_deep_sleep_start();
 	}
 	/* load system configuration */
-	if ( ! config.load() ) {
-		log_e("Failed to load system configuration.");
-		esp_deep_sleep_start();
+	Config & initial = configSlots[0].config; /* no readers exist yet */
+	if ( ! initial.loadShadow() ) {
+		if ( ! initial.load() ) {
+			log_e("Failed to load system configuration.");
+			esp_deep_sleep_start();
+		}
+		if ( ! initial.storeShadow() ) {
+			log_w("Failed to store configuration shadow file.");
+		}
 	}
+	configSlots[0].schedule.set(initial);
 	/* setup TFT */
-	pinMode(TFT_BACKLIGHT, OUTPUT);
-	analogWrite(TFT_BACKLIGHT, tftBl[tftBlIndex]);
+	tftInitBacklight();
+	powerInit(initial); /* before the render task uses `powerLock` */
+	tftUpdateBacklight();
 	tft.init();
 	tft.setRotation(1);
 	tft.setTextFont(8);
@@ -777,236 +2354,347 @@ void setup() {
 	tft.setTextDatum(CC_DATUM);
 	tft.setTextPadding(320);
 	tft.setSwapBytes(true);
-	/* initialize analog clock */
-	char * svgStr = strdup(svgData);
-	if (svgStr == NULL) {
-		log_e("Failed to create string from SVG data.");
+	/* initialize the built-in analog clock face; other faces are loaded on first use */
+	const AnalogClock * builtinClock = faceGet(FACE_BUILTIN);
+	if (builtinClock == NULL) {
 		esp_deep_sleep_start();
 	}
-	svgImg = nsvgParse(svgStr, "px", 96);
-	free(svgStr);
-	if (svgImg == NULL) {
-		log_e("Failed to parse analog clock data.");
-		esp_deep_sleep_start();
+#ifdef SVG_STRIP_LINES
+	for (size_t i = 0; i < ARRAY_SIZE(stripBuf); i++) {
+		stripBuf[i] = static_cast<uint16_t *>(heap_caps_malloc(320 * SVG_STRIP_LINES * sizeof(uint16_t), MALLOC_CAP_DMA));
+		if (stripBuf[i] == NULL) {
+			log_e("Memory exhausted while trying to allocate analog clock DMA buffers.");
+			esp_deep_sleep_start();
+		}
 	}
-	svgPathsHour = svgDuplicateShapePaths("hour");
-	if (svgPathsHour == NULL) {
-		log_e("Failed to copy SVG paths for hour clock hand.");
+	tft.initDMA();
+#else /* ! SVG_STRIP_LINES */
+	imgBuf = static_cast<uint16_t *>(malloc(320 * 240 * sizeof(uint16_t)));
+	if (imgBuf == NULL) {
+		log_e("Memory exhausted while trying to allocate analog clock image buffer.");
 		esp_deep_sleep_start();
 	}
-	svgPathsMin = svgDuplicateShapePaths("min");
-	if (svgPathsMin == NULL) {
-		log_e("Failed to copy SVG paths for minutes clock hand.");
+#endif /* ! SVG_STRIP_LINES */
+#ifdef BOARD_HAS_PSRAM
+	if ( ! builtinClock->hasBackground() ) {
+		log_e("Failed to allocate analog clock background cache. Rendering without.");
+	}
+#endif /* BOARD_HAS_PSRAM */
+#ifdef DIGITAL_ATLAS
+	digitalAtlas = digitalClock.begin(svgDigits, ps_malloc);
+	if ( ! digitalAtlas ) {
+		log_e("%s Using the built-in font.", digitalClock.error());
+	}
+#endif /* DIGITAL_ATLAS */
+	/* start render task */
+	renderQueue = xQueueCreate(1, sizeof(RenderJob));
+	if (renderQueue == NULL) {
+		log_e("Memory exhausted while trying to allocate render queue.");
 		esp_deep_sleep_start();
 	}
-	svgRast = nsvgCreateRasterizer();
-	if (svgRast == NULL) {
-		log_e("Memory exhausted while trying to allocate SVG rasterizer instance.");
+	ntpQueue = xQueueCreate(4, sizeof(NtpResult));
+	if (ntpQueue == NULL) {
+		log_e("Memory exhausted while trying to allocate NTP queue.");
 		esp_deep_sleep_start();
 	}
-	imgBuf = static_cast<unsigned char *>(malloc(320 * 240 * 4));
-	if (imgBuf == NULL) {
-		log_e("Memory exhausted while trying to allocate analog clock image buffer.");
+	metricsCpuMhz = ESP.getCpuFreqMHz();
+	if (xTaskCreatePinnedToCore(renderTask, "render", RENDER_TASK_STACK, NULL, RENDER_TASK_PRIORITY, &renderTaskHandle, RENDER_TASK_CORE) != pdPASS) {
+		log_e("Failed to create render task.");
 		esp_deep_sleep_start();
 	}
 	/* setup WIFI */
+	WiFi.persistent(false); /* credentials are taken from the configuration */
 	WiFi.mode(WIFI_STA);
-	WiFi.begin(config.wifiSsid, config.wifiPass);
+	WiFi.setAutoReconnect(false); /* see wifiRetry() */
+	WiFi.onEvent([] (arduino_event_id_t /* event */, arduino_event_info_t /* info */) {
+		loopWake(); /* connection state may have changed */
+	});
+	const ConfigRef initConfig;
+	wifiCacheValid = wifiCacheLoad(initConfig->wifiSsid);
+	wifiConnect(*initConfig, true);
+	if (strcmp(initConfig->powerMode, "none") != 0) {
+		/* the minimum modem sleep wakes up for each DTIM beacon to keep the web server responsive */
+		WiFi.setSleep((initConfig->powerMode[0] == 'l') ? WIFI_PS_MIN_MODEM : WIFI_PS_MAX_MODEM);
+	}
+	powerWindowStart = esp_timer_get_time();
 	/* setup Over-the-Air updater */
-	ArduinoOTA.setHostname(config.mdnsHost);
-	ArduinoOTA.setPassword(config.otaPass);
+	ArduinoOTA.setHostname(initConfig->mdnsHost);
+	ArduinoOTA.setPassword(initConfig->otaPass);
+	ArduinoOTA.onStart([] () {
+		otaActive = true;
+		configStore(); /* the device reboots after the update */
+	});
+	ArduinoOTA.onError([] (ota_error_t /* error */) {
+		otaActive = false;
+	});
+	/* NTP client */
+	NTP.onNTPSyncEvent([] (NTPEvent_t event) {
+		NtpResult res;
+		switch (event.event) {
+		case timeSyncd:
+		case syncNotNeeded:
+			res.ok = true;
+			break;
+		case noResponse:
+		case invalidAddress:
+		case invalidPort:
+		case accuracyError:
+			res.ok = false;
+			break;
+		default:
+			return;
+		}
+		/* offsets beyond about 35 minutes are clamped, e.g. on first synchronization after boot */
+		const float offsetUs = event.info.offset * 1e6f;
+		const float delayUs = event.info.delay * 1e6f;
+		res.offsetUs = (offsetUs >= 2e9f) ? INT32_MAX : ((offsetUs <= -2e9f) ? -INT32_MAX : int32_t(offsetUs));
+		res.delayUs = (delayUs <= 0.0f) ? 0 : ((delayUs >= 4e9f) ? UINT32_MAX : uint32_t(delayUs));
+		xQueueSend(ntpQueue, &res, 0); /* dropped if the main loop lags behind */
+		loopWake(); /* time may have jumped */
+	});
 	/* web server */
-	server.on("/", HTTP_GET, [] (AsyncWebServerRequest * request) {
-		/* do not use server.serveStatic("/", LittleFS, "/web/index.html") to avoid access to ../config.ini */
-		if (xSemaphoreTake(mutex, TickType_t(100)) == pdTRUE) {
-			request->send(LittleFS, "/web/index.html");
-			xSemaphoreGive(mutex);
-		} else {
-			request->send(503); /* service unavailable */
+	configUploadInit();
+	/* web files are embedded to avoid file system access and thereby access to ../config.ini */
+	for (const WebAsset & asset : webAssets) {
+		server.on(asset.path, HTTP_GET, [&asset] (AsyncWebServerRequest * request) {
+			webSendAsset(request, asset);
+		});
+		if (strcmp(asset.path, "/index.html") == 0) {
+			server.on("/", HTTP_GET, [&asset] (AsyncWebServerRequest * request) {
+				webSendAsset(request, asset);
+			});
 		}
+	}
+	server.on("/config", HTTP_GET, [] (AsyncWebServerRequest * request) {
+		/* Send current configuration in JSON format to the client. */
+		uint32_t version;
+		{
+			const ConfigRef config;
+			version = config.version();
+		}
+		webSendJson(request, [version] (JsonWriter & json) -> bool {
+			const ConfigRef config;
+			if (config.version() != version) {
+				return false; /* changed while sending */
+			}
+			config->toJson(json);
+			return true;
+		});
 	});
-	server.on("/index.html", HTTP_GET, [] (AsyncWebServerRequest * request) {
-		if (xSemaphoreTake(mutex, TickType_t(100)) == pdTRUE) {
-			request->send(LittleFS, "/web/index.html");
-			xSemaphoreGive(mutex);
-		} else {
-			request->send(503); /* service unavailable */
+	server.on("/faces", HTTP_GET, [] (AsyncWebServerRequest * request) {
+		/* Send the names of all analog clock faces in JSON format to the client. */
+		struct FaceList {
+			char names[FACE_LIST_MAX][FACE_NAME_SIZE + 1];
+			size_t count;
+		} list;
+		snprintf(list.names[0], sizeof(list.names[0]), "%s", FACE_BUILTIN);
+		list.count = 1;
+		File dir = LittleFS.open(FACE_DIR);
+		if (dir && dir.isDirectory()) {
+			for (File file = dir.openNextFile(); file && list.count < FACE_LIST_MAX; file = dir.openNextFile()) {
+				const char * fileName = file.name();
+				const size_t len = strlen(fileName);
+				const size_t suffixLen = sizeof(FACE_SUFFIX) - 1;
+				char * name = list.names[list.count];
+				if (len > suffixLen && (len - suffixLen) <= FACE_NAME_SIZE && strcmp(fileName + len - suffixLen, FACE_SUFFIX) == 0) {
+					memcpy(name, fileName, len - suffixLen);
+					name[len - suffixLen] = 0;
+					if (faceNameValid(name) && strcmp(name, FACE_BUILTIN) != 0 && strcmp(name, "digital") != 0) {
+						list.count++;
+					}
+				}
+				file.close();
+			}
 		}
+		webSendJson(request, [list] (JsonWriter & json) -> bool {
+			json.beginArray();
+			for (size_t i = 0; i < list.count; i++) {
+				json.value(list.names[i]);
+			}
+			json.endArray();
+			return true;
+		});
 	});
-	server.on("/favicon.ico", HTTP_GET, [] (AsyncWebServerRequest * request) {
-		if (xSemaphoreTake(mutex, TickType_t(100)) == pdTRUE) {
-			request->send(LittleFS, "/web/favicon.ico");
-			xSemaphoreGive(mutex);
-		} else {
-			request->send(503); /* service unavailable */
+	server.on("/status", HTTP_GET, [] (AsyncWebServerRequest * request) {
+		/* Send current system status in JSON format to the client. */
+		uint32_t version;
+		{
+			const ConfigRef config;
+			version = config.version();
 		}
+		const uint32_t awakeMs = powerAwakeMs;
+		/* a window is closed once per second while animating; report idle otherwise */
+		const bool animated = (millis() - renderStats.updated) < 2000;
+		const uint32_t render[4] = {
+			animated ? uint32_t(renderStats.fps) : 0,
+			renderStats.frameUs,
+			renderStats.frameMaxUs,
+			renderStats.dropped
+		};
+		webSendJson(request, [version, awakeMs, render] (JsonWriter & json) -> bool {
+			const ConfigRef config;
+			if (config.version() != version) {
+				return false; /* changed while sending */
+			}
+			json.beginObject();
+			json.key("power").beginObject();
+			json.key("mode").value(config->powerMode);
+			json.key("awakeMsPerMinute").value(awakeMs);
+			json.endObject();
+			json.key("render").beginObject();
+			json.key("targetFps").value(uint32_t(config->showSeconds() ? ((config->clockSeconds[0] == 's') ? config->clockFps : 1) : 0));
+			json.key("fps").value(render[0]);
+			json.key("frameUs").value(render[1]);
+			json.key("frameMaxUs").value(render[2]);
+			json.key("droppedFrames").value(render[3]);
+			json.endObject();
+			json.endObject();
+			return true;
+		});
 	});
-	server.on("/config", HTTP_GET, [] (AsyncWebServerRequest * request) {
-		/* Send current configuration in JSON format to the client. */
-		static const char * fmt = R"({
-"mdns": {
-	"host": "%s"
-}, "ntp": {
-	"timeout": %lu,
-	"server": "%s"
-}, "clock": {
-	"passColor": "#%06lX",
-	"failColor": "#%06lX",
-	"passFrom": "%s",
-	"passTo": "%s",
-	"type": "%s"
-}})";
-		AsyncResponseStream * response = request->beginResponseStream("application/json");
-		response->addHeader("Cache-Control", "no-cache");
-		response->printf(fmt,
-			config.mdnsHost,
-			config.ntpTimeout,
-			config.ntpServer,
-			fromRgb565(config.clockPassColor),
-			fromRgb565(config.clockFailColor),
-			config.clockPassFrom,
-			config.clockPassTo,
-			config.clockType
-		);
-		request->send(response);
+	server.on("/metrics", HTTP_GET, [] (AsyncWebServerRequest * request) {
+		/* Send stage timings and memory high-water marks in JSON format to the client. */
+		if (metricsRequest != NULL) {
+			request->send(503); /* service unavailable; the snapshot is still in use */
+			return;
+		}
+		metricsRequest = request;
+		request->onDisconnect([] () {
+			metricsRequest = NULL;
+		});
+		portENTER_CRITICAL(&metricsLock);
+		memcpy(metricsSnapshot, metrics, sizeof(metricsSnapshot));
+		metricsNtp = ntpManager;
+		portEXIT_CRITICAL(&metricsLock);
+		const uint32_t memory[14] = {
+			uint32_t(heap_caps_get_free_size(MALLOC_CAP_INTERNAL)),
+			uint32_t(heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL)),
+			uint32_t(heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL)),
+			uint32_t(heap_caps_get_free_size(MALLOC_CAP_SPIRAM)),
+			uint32_t(heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM)),
+			uint32_t(heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM)),
+			uint32_t(uxTaskGetStackHighWaterMark(loopTask)),
+			uint32_t(uxTaskGetStackHighWaterMark(renderTaskHandle)),
+			faceArena[0],
+			faceArena[1],
+			faceCached,
+			faceLoads,
+			wifiConnectMs,
+			wifiScans
+		};
+		webSendJson(request, [memory] (JsonWriter & json) -> bool {
+			json.beginObject();
+			json.key("stagesUs").beginObject();
+			for (size_t i = 0; i < METRICS_STAGES; i++) {
+				json.key(metricsNames[i]);
+				metricsSnapshot[i].toJson(json);
+			}
+			json.endObject();
+			json.key("heap").beginObject();
+			json.key("free").value(memory[0]);
+			json.key("minFree").value(memory[1]);
+			json.key("largestBlock").value(memory[2]);
+			json.endObject();
+			json.key("psram").beginObject();
+			json.key("free").value(memory[3]);
+			json.key("minFree").value(memory[4]);
+			json.key("largestBlock").value(memory[5]);
+			json.endObject();
+			json.key("stackMinFree").beginObject();
+			json.key("loop").value(memory[6]);
+			json.key("render").value(memory[7]);
+			json.endObject();
+			json.key("svgArena").beginObject();
+			json.key("size").value(memory[8]);
+			json.key("used").value(memory[9]);
+			json.endObject();
+			json.key("faces").beginObject();
+			json.key("cached").value(memory[10]);
+			json.key("loads").value(memory[11]);
+			json.endObject();
+			json.key("ntp");
+			metricsNtp.toJson(json);
+			json.key("wifi").beginObject();
+			json.key("connectMs").value(memory[12]);
+			json.key("scans").value(memory[13]);
+			json.endObject();
+			json.endObject();
+			return true;
+		});
 	});
 	server.on("/config", HTTP_POST, [] (AsyncWebServerRequest * request) {
 		/* Request completed. Update the current configuration from client configuration (INI format). */
-		if (request->_tempObject != NULL && request->contentLength() > 0) {
-			enum {
-				HAS_MDNS_HOST        = 0x01,
-				HAS_NTP_TIMEOUT      = 0x02,
-				HAS_NTP_SERVER       = 0x04,
-				HAS_CLOCK_PASS_COLOR = 0x08,
-				HAS_CLOCK_FAIL_COLOR = 0x10,
-				HAS_CLOCK_PASS_FROM  = 0x20,
-				HAS_CLOCK_PASS_TO    = 0x40,
-				HAS_CLOCK_TYPE       = 0x80
-			};
-			Config * tmp = static_cast<Config *>(malloc(sizeof(tmp)));
-			if ( ! tmp ) {
-				request->send(500); /* internal server error */
-				return;
-			}
-			uint32_t found = 0;
-			bool (Config::* checker)() const noexcept = NULL;
-			const auto valueMapper = [&] (IniParser::Context & ctx, const bool parsed) -> bool {
-				checker = NULL;
-				if ( ! parsed ) {
-					if (ctx.group == "MDNS") {
-						if (ctx.key == "HOST") {
-							found |= HAS_MDNS_HOST;
-							ctx.mapString(tmp->mdnsHost);
-							checker = &Config::checkMdnsHost;
-						}
-					} else if (ctx.group == "NTP") {
-						if (ctx.key == "TIMEOUT") {
-							found |= HAS_NTP_TIMEOUT;
-							ctx.mapNumber(tmp->ntpTimeout, 0, 0xFFFF);
-						} else if (ctx.key == "SERVER") {
-							found |= HAS_NTP_SERVER;
-							ctx.mapString(tmp->ntpServer);
-							checker = &Config::checkNtpServer;
-						}
-					} else if (ctx.group == "CLOCK") {
-						if (ctx.key == "PASS_COLOR") {
-							found |= HAS_CLOCK_PASS_COLOR;
-							ctx.mapNumber(tmp->clockPassColor, 0, 0xFFFF);
-						} else if (ctx.key == "FAIL_COLOR") {
-							found |= HAS_CLOCK_FAIL_COLOR;
-							ctx.mapNumber(tmp->clockFailColor, 0, 0xFFFF);
-						} else if (ctx.key == "PASS_FROM") {
-							found |= HAS_CLOCK_PASS_FROM;
-							ctx.mapString(tmp->clockPassFrom);
-							checker = &Config::checkClockPassFrom;
-						} else if (ctx.key == "PASS_TO") {
-							found |= HAS_CLOCK_PASS_TO;
-							ctx.mapString(tmp->clockPassTo);
-							checker = &Config::checkClockPassTo;
-						} else if (ctx.key == "TYPE") {
-							found |= HAS_CLOCK_TYPE;
-							ctx.mapString(tmp->clockType);
-							checker = &Config::checkClockType;
-						}
-					}
-				} else if (checker != NULL && ((*tmp).*checker)() == false) {
-					return false;
+		ConfigUpload * upload = configUploadFind(request);
+		if (request->contentLength() == 0) {
+			request->send(204); /* no content */
+		} else if (upload == NULL) {
+			request->send(503); /* service unavailable */
+		} else if (upload->failed || upload->received != request->contentLength()) {
+			request->send(400); /* bad request */
+		} else {
+			/* the web server is the only configuration writer after setup */
+			const ConfigRef config;
+			const IniParser::KeyMap<Config> & keys = Config::keys();
+			uint32_t events = 0;
+			bool changed = false;
+			for (size_t i = 0; i < keys.size(); i++) {
+				if ((upload->found & (uint32_t(1) << i)) == 0) {
+					keys.assign(upload->config, *config, i); /* keep current value */
+					continue;
 				}
-				return true; /* ignore unknown keys */
-			};
-			const size_t res = iniParseString<16>(static_cast<const char *>(request->_tempObject), request->contentLength(), valueMapper);
-			int code = 200;
-			if (res == 0) {
-				if (xSemaphoreTake(mutex, TickType_t(100)) == pdTRUE) {
-					bool changed = false;
-					if ((found & HAS_MDNS_HOST) && strcmp(config.mdnsHost, tmp->mdnsHost) != 0) {
-						memcpy(config.mdnsHost, tmp->mdnsHost, sizeof(config.mdnsHost));
-						changed = true;
-					}
-					if ((found & HAS_NTP_TIMEOUT) && config.ntpTimeout != tmp->ntpTimeout) {
-						config.ntpTimeout = tmp->ntpTimeout;
-						changed = true;
-					}
-					if ((found & HAS_NTP_SERVER) && strcmp(config.ntpServer, tmp->ntpServer) != 0) {
-						memcpy(config.ntpServer, tmp->ntpServer, sizeof(config.ntpServer));
-						state.ntpStarted = false;
-						changed = true;
-					}
-					if ((found & HAS_CLOCK_PASS_COLOR) && config.clockPassColor != tmp->clockPassColor) {
-						config.clockPassColor = tmp->clockPassColor;
-						state.clockChanged = true;
-						changed = true;
-					}
-					if ((found & HAS_CLOCK_FAIL_COLOR) && config.clockFailColor != tmp->clockFailColor) {
-						config.clockFailColor = tmp->clockFailColor;
-						state.clockChanged = true;
-						changed = true;
-					}
-					if ((found & HAS_CLOCK_PASS_FROM) && strcmp(config.clockPassFrom, tmp->clockPassFrom) != 0) {
-						memcpy(config.clockPassFrom, tmp->clockPassFrom, sizeof(config.clockPassFrom));
-						state.clockChanged = true;
-						changed = true;
-					}
-					if ((found & HAS_CLOCK_PASS_TO) && strcmp(config.clockPassTo, tmp->clockPassTo) != 0) {
-						memcpy(config.clockPassTo, tmp->clockPassTo, sizeof(config.clockPassTo));
-						state.clockChanged = true;
-						changed = true;
-					}
-					if ((found & HAS_CLOCK_TYPE) && config.clockType[0] != tmp->clockType[0]) {
-						memcpy(config.clockType, tmp->clockType, sizeof(config.clockType));
-						state.clockChanged = true;
-						changed = true;
-					}
-					if ( changed ) {
-						state.configChanged = true;
-					}
-					xSemaphoreGive(mutex);
-				} else {
-					code = 503; /* service unavailable */
+				if ( keys.equal(upload->config, *config, i) ) {
+					continue;
 				}
-			} else {
+				if ((keys[i].flags & Config::KEY_NTP) != 0) {
+					events |= CONFIG_EV_NTP;
+				}
+				if ((keys[i].flags & Config::KEY_CLOCK) != 0) {
+					events |= CONFIG_EV_CLOCK;
+				}
+				changed = true;
+			}
+			int code = 200;
+			if ( ! changed ) {
+				/* nothing to do */
+			} else if ( ! upload->config.checkClockPass() ) {
 				code = 400; /* bad request */
+			} else if ( configPublish(upload->config) ) {
+				configEvents.fetch_or(events);
+				loopWake();
+			} else {
+				code = 503; /* service unavailable */
 			}
 			request->send(code);
-			free(tmp);
-		} else {
-			request->send(204); /* no content */
 		}
+		configUploadEnd(request);
 	}, NULL /* handleUpload() */,
 	[] (AsyncWebServerRequest * request, uint8_t * bodyData, size_t bodyLen, size_t index, size_t total) {
-		/* Ongoing reception of the body data. */
-		if (total > 0 && request->_tempObject == NULL && total < 2048) {
-			request->_tempObject = malloc(total); /* automatically freed by `AsyncWebServerRequest` */
+		/* Ongoing reception of the body data. Parse it as it arrives. */
+		ConfigUpload * upload = (index == 0) ? configUploadBegin(request) : configUploadFind(request);
+		if (upload == NULL || upload->failed) {
+			return;
 		}
-		if (request->_tempObject != NULL) {
-			memcpy(static_cast<uint8_t *>(request->_tempObject) + index, bodyData, bodyLen);
+		upload->received += bodyLen;
+		if ( ! upload->ini().parse(reinterpret_cast<const char *>(bodyData), bodyLen) ) {
+			upload->failed = true;
+		} else if (upload->received >= total && ( ! upload->ini().parse(-1) )) {
+			upload->failed = true;
 		}
 	});
 	server.on("/reboot", HTTP_POST, [] (AsyncWebServerRequest * request) {
-		/* Reboot the ESP32. */
+		/* Reboot the ESP32 from the main loop once pending configuration changes are stored. */
 		request->send(200);
-		delay(200);
-		ESP.restart();
+		configEvents.fetch_or(CONFIG_EV_REBOOT);
+		loopWake();
+	});
+	eventsSource.onConnect([] (AsyncEventSourceClient * /* client */) {
+		eventsResync = true;
+		loopWake();
+	});
+	server.addHandler(&eventsSource);
+	server.addMiddleware([] (AsyncWebServerRequest * /* request */, ArMiddlewareNext next) {
+		webLast = millis(); /* keeps the device awake in light sleep mode */
+		next();
 	});
 	server.onNotFound([] (AsyncWebServerRequest * request) {
 		if (request->method() == HTTP_OPTIONS) {
@@ -1021,8 +2709,8 @@ void setup() {
 	pinMode(BUTTON_DOWN, INPUT);
 	bUpLast = millis();
 	bDownLast = millis();
-	attachInterrupt(BUTTON_UP, buttonUpIsr, FALLING);
-	attachInterrupt(BUTTON_DOWN, buttonDownIsr, FALLING);
+	attachInterrupt(BUTTON_UP, buttonUpIsr, ONLOW_WE); /* see buttonArm() */
+	attachInterrupt(BUTTON_DOWN, buttonDownIsr, ONLOW_WE);
 	log_e("free heap: %lu bytes", static_cast<unsigned long>(ESP.getFreeHeap()));
 }
 
@@ -1031,17 +2719,31 @@ void setup() {
  * Updates the system state and displays the current time.
  */
 void loop() {
-#define LOOP_DELAY_MS 1000
-	const bool lockTaken = (xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE);
+	const uint32_t loopStart = ESP.getCycleCount();
+	tftUpdateBacklight();
+	powerUpdateStats();
+	static uint32_t storeSince = 0;
+	static bool storePending = false;
+	const uint32_t events = configEvents.exchange(0);
+	const ConfigRef config; /* after the events to be at least as new as these */
 	State newState = state;
-	const bool clockChanged = newState.clockChanged;
-	newState.clockChanged = false;
-	newState.configChanged = false;
+	const bool clockChanged = (events & CONFIG_EV_CLOCK) != 0;
+	if ((events & CONFIG_EV_NTP) != 0) {
+		newState.ntpStarted = false;
+	}
 	newState.wifiOnline = (WiFi.status() == WL_CONNECTED);
+	uint32_t wifiWaitMs = UINT32_MAX;
 	if (state.wifiOnline && !newState.wifiOnline) {
-		/* went offline -> reset states */
+		/* went offline -> reset states and reconnect */
 		newState.setOffline();
+		wifiConnect(*config, true);
+		wifiWaitMs = wifiRetryMs;
+	} else if (( ! state.wifiOnline ) && newState.wifiOnline) {
+		wifiConnected(*config);
+	} else if ( ! newState.wifiOnline ) {
+		wifiWaitMs = wifiRetry(*config);
 	}
+	metricsEnd(METRICS_STATE, loopStart);
 	if ( newState.wifiOnline ) {
 		/* Over-the-Air updater */
 		if ( ! newState.otaStarted ) {
@@ -1050,86 +2752,104 @@ void loop() {
 			MDNS.addService("http", "tcp", 80);
 			newState.otaStarted = true;
 		}
+		const uint32_t otaStart = ESP.getCycleCount();
 		ArduinoOTA.handle();
+		metricsEnd(METRICS_OTA, otaStart);
 		/* NTP client */
+		const uint32_t ntpStart = ESP.getCycleCount();
 		if ( ! newState.ntpStarted ) {
 			/* setup client */
-			NTP.setNTPTimeout(uint16_t(config.ntpTimeout));
-			NTP.setInterval(63);
-			NTP.setTimeZone(TZ_Europe_Berlin);
-			NTP.begin(config.ntpServer);
+			portENTER_CRITICAL(&metricsLock);
+			ntpManager.begin(config->ntpServer);
+			portEXIT_CRITICAL(&metricsLock);
+			NTP.setNTPTimeout(uint16_t(config->ntpTimeout));
+			NTP.setInterval(NtpManager::MIN_INTERVAL, int(ntpManager.interval()));
+			NTP.setTimeZone(config->ntpTz);
+			NTP.begin(ntpManager.server());
 			newState.ntpStarted = true;
 		}
+		if ( newState.ntpStarted ) {
+			/* all up and running -> update time */
+			ntpUpdate();
+			newState.updateTime();
+		}
+		metricsEnd(METRICS_NTP, ntpStart);
 	}
-	if (newState.wifiOnline && newState.ntpStarted) {
-		/* all up and running -> update time */
-		newState.updateNtp();
+	const uint32_t eventsStart = ESP.getCycleCount();
+	eventsUpdate(newState);
+	metricsEnd(METRICS_EVENTS, eventsStart);
+	if (config.version() == configStoredVersion) {
+		storePending = false;
+	} else if ( ! storePending ) {
+		storePending = true;
+		storeSince = millis();
 	}
-	if (memcmp(&state, &newState, sizeof(newState)) != 0) {
-		/* state changed */
-		if ( state.configChanged ) {
-			/* Store updated configuration.
-			 * This is not done within the web server to as it takes long and
-			 * degenerates the flash if done too often.
-			 */
-			if ( ! config.store() ) {
-				log_e("Failed to store new configuration on flash.");
-			}
-		}
+	if (storePending && ((events & CONFIG_EV_REBOOT) != 0 || (millis() - storeSince) >= CONFIG_STORE_DELAY_MS)) {
+		/* Store updated configuration.
+		 * This is not done within the web server to as it takes long and
+		 * degenerates the flash if done too often. Changes within
+		 * `CONFIG_STORE_DELAY_MS` are stored at once.
+		 */
+		const uint32_t storeStart = ESP.getCycleCount();
+		configStore();
+		metricsEnd(METRICS_STORE, storeStart);
+		storePending = false;
+	}
+	if ((events & CONFIG_EV_REBOOT) != 0) {
+		delay(200); /* let the web server send its response */
+		ESP.restart();
+	}
+	metricsEnd(METRICS_LOOP, loopStart);
+	if (clockChanged || state != newState) {
+		/* state or clock configuration changed */
 		state = newState;
-		if ( lockTaken ) {
-			xSemaphoreGive(mutex);
-		}
-		/* update display */
-		if (config.clockType[0] == 'd') {
-			/* display digital clock */
-			if ( clockChanged ) {
-				tft.fillScreen(TFT_BLACK);
-			}
-			tft.setTextColor(
-				uint16_t(
-					newState.withinTimeSpan(config.clockPassFrom, config.clockPassTo)
-						? config.clockPassColor : config.clockFailColor
-				),
-				TFT_BLACK
-			);
-			tft.drawString(newState.time, 160, 120);
+		/* pass the snapshot to the render task; this replaces any update not yet drawn */
+		RenderJob job{};
+		job.state = newState;
+		job.clockChanged = clockChanged;
+		job.digital = config->digital();
+		memcpy(job.face, config->clockType, sizeof(job.face));
+		if ( config->showSeconds() ) {
+			job.seconds = uint8_t((config->clockSeconds[0] == 's') ? RENDER_SECONDS_SWEEP : RENDER_SECONDS_TICK);
 		} else {
-			/* display analog clock */
-			const float hour = float((10 * (newState.time[0] - '0')) + (newState.time[1] - '0'));
-			const float min = float((10 * (newState.time[3] - '0')) + (newState.time[4] - '0'));
-			/* adjust angle of clock hands */
-			svgRotateShape("hour", (hour + (min / 60.0f)) * 30.0f);
-			svgRotateShape("min", min * 6.0f);
-			/* set colors */
-			const uint16_t rgb565 = uint16_t(newState.withinTimeSpan(config.clockPassFrom, config.clockPassTo)
-				? config.clockPassColor : config.clockFailColor);
-			svgSetFill("circle", svgFromRgb565(rgb565));
-			/* raster SVG */
-			nsvgRasterize(svgRast, svgImg, 0, 0, 1, imgBuf, 320, 240, 320 * 4);
-			/* convert RGBA32 to RGB565 in-place */
-			size_t i = 0;
-			uint16_t * ptr = reinterpret_cast<uint16_t *>(imgBuf);
-			for (size_t y = 0; y < 240; y++) {
-				for (size_t x = 0; x < 320; x++) {
-					const uint8_t r = imgBuf[i++];
-					const uint8_t g = imgBuf[i++];
-					const uint8_t b = imgBuf[i++];
-					i++;
-					*ptr++ = uint16_t((uint16_t(r & 0xF8) << 8) | (uint16_t(g & 0xFC) << 3) | (b >> 3));
-				}
-			}
-			/* flush to screen */
-			tft.pushImage(0, 0, 320, 240, reinterpret_cast<uint16_t *>(imgBuf));
-			/* restore clock hands angle */
-			svgSetPaths("hour", svgPathsHour);
-			svgSetPaths("min", svgPathsMin);
+			job.seconds = uint8_t(RENDER_SECONDS_NONE);
+		}
+		job.fps = uint8_t(config->clockFps);
+		job.color = uint16_t(config.schedule().contains(newState.minute)
+			? config->clockPassColor : config->clockFailColor);
+		RenderJob pending;
+		if (xQueuePeek(renderQueue, &pending, 0) == pdTRUE && pending.clockChanged) {
+			job.clockChanged = true; /* keep pending full redraw */
 		}
+		xQueueOverwrite(renderQueue, &job);
 	} else {
-		if ( lockTaken ) {
-			xSemaphoreGive(mutex);
+		/* keep power consumption low by sleeping until the next event */
+		uint32_t waitMs = msUntilNextMinute();
+		const uint32_t now = millis();
+		if (wifiWaitMs < waitMs) {
+			waitMs = wifiWaitMs;
+		}
+		if ( storePending ) {
+			const uint32_t storeElapsed = now - storeSince;
+			const uint32_t storeMs = (storeElapsed < CONFIG_STORE_DELAY_MS) ? (CONFIG_STORE_DELAY_MS - storeElapsed) : 0;
+			if (storeMs < waitMs) {
+				waitMs = storeMs;
+			}
+		}
+		if (newState.otaStarted && waitMs > OTA_POLL_MS) {
+			waitMs = OTA_POLL_MS;
+		}
+		/* light sleep delays the seconds clock hand and the web server */
+		const bool sleep = powerLock != NULL && ( ! config->showSeconds() ) && ( ! otaActive ) && eventsSource.count() == 0
+			&& (now - bUpLast) >= POWER_AWAKE_MS && (now - bDownLast) >= POWER_AWAKE_MS && (now - webLast) >= POWER_AWAKE_MS;
+		const int64_t sleepStart = esp_timer_get_time();
+		if ( sleep ) {
+			powerAllowSleep();
+		}
+		ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+		if ( sleep ) {
+			powerStayAwake();
+			powerWindowSlept += esp_timer_get_time() - sleepStart;
 		}
-		/* keep power consumption low by doing less updates */
-		delay(LOOP_DELAY_MS);
 	}
 }
@@ -25,11 +25,15 @@
  * Bounding box calculation based on http://blog.hackers-cafe.net/2009/06/how-to-calculate-bezier-curves-bounding.html
  *
  * @remarks Modified by Daniel Starke to suppress compiler warnings.
+ * @remarks Modified by Daniel Starke to copy images into a pre-allocated arena.
+ * @remarks Modified by Daniel Starke to copy only the shapes of constant pre-parsed images.
  */
 
 #ifndef NANOSVG_H
 #define NANOSVG_H
 
+#include <stddef.h>
+
 #ifndef NANOSVG_CPLUSPLUS
 #ifdef __cplusplus
 extern "C" {
@@ -177,6 +181,45 @@ NSVGimage* nsvgParse(char* input, const char* units, float dpi);
 // Duplicates a path.
 NSVGpath* nsvgDuplicatePath(NSVGpath* p);
 
+// Bump allocator within a caller provided memory region which is only released as a whole.
+typedef struct NSVGarena
+{
+	unsigned char* mem;			// Start of the memory region.
+	size_t size;				// Size of the memory region in bytes.
+	size_t used;				// Number of allocated bytes.
+	size_t last;				// Offset of the last allocation which can be resized in place.
+} NSVGarena;
+
+// Initializes the arena for the given memory region.
+void nsvgArenaInit(NSVGarena* arena, void* mem, size_t size);
+
+// Allocates memory aligned to 8 bytes from the arena. Returns NULL if the arena is exhausted.
+void* nsvgArenaAlloc(NSVGarena* arena, size_t size);
+
+// Resizes memory allocated from the arena. Only the last allocation grows in place.
+// Returns NULL and keeps the passed memory if the arena is exhausted.
+void* nsvgArenaRealloc(NSVGarena* arena, void* ptr, size_t oldSize, size_t size);
+
+// Returns the number of arena bytes needed to copy the image via nsvgCopyImage().
+size_t nsvgImageSize(const NSVGimage* image);
+
+// Copies the image into the arena. The copy must not be passed to nsvgDelete().
+// Returns NULL if the arena is exhausted.
+NSVGimage* nsvgCopyImage(const NSVGimage* image, NSVGarena* arena);
+
+// Returns the number of arena bytes needed to copy the path list via nsvgCopyPaths().
+size_t nsvgPathsSize(const NSVGpath* paths);
+
+// Copies the path list into the arena. Returns NULL if the arena is exhausted.
+NSVGpath* nsvgCopyPaths(const NSVGpath* paths, NSVGarena* arena);
+
+// Returns the number of arena bytes needed to copy the image via nsvgCopyShapes().
+size_t nsvgShapesSize(const NSVGimage* image);
+
+// Copies the image and its shapes into the arena. The paths and gradients are shared
+// with the passed image, e.g. a constant pre-parsed image. Returns NULL if the arena is exhausted.
+NSVGimage* nsvgCopyShapes(const NSVGimage* image, NSVGarena* arena);
+
 // Deletes an image.
 void nsvgDelete(NSVGimage* image);
 
@@ -3078,6 +3121,163 @@ error:
     return NULL;
 }
 
+#define NSVG__ARENA_ALIGN(x) (((x) + 7) & ~(size_t)7)
+
+void nsvgArenaInit(NSVGarena* arena, void* mem, size_t size)
+{
+	arena->mem = (unsigned char*)mem;
+	arena->size = (mem != NULL) ? size : 0;
+	arena->used = 0;
+	arena->last = 0;
+}
+
+void* nsvgArenaAlloc(NSVGarena* arena, size_t size)
+{
+	size_t offset = NSVG__ARENA_ALIGN(arena->used);
+	if (offset > arena->size || size > arena->size - offset)
+		return NULL;
+	arena->last = offset;
+	arena->used = offset + size;
+	return arena->mem + offset;
+}
+
+void* nsvgArenaRealloc(NSVGarena* arena, void* ptr, size_t oldSize, size_t size)
+{
+	unsigned char* res;
+	if (ptr == NULL)
+		return nsvgArenaAlloc(arena, size);
+	if ((unsigned char*)ptr == arena->mem + arena->last) {
+		// grow or shrink in place
+		if (size > arena->size - arena->last)
+			return NULL;
+		arena->used = arena->last + size;
+		return ptr;
+	}
+	if (size <= oldSize)
+		return ptr;
+	res = (unsigned char*)nsvgArenaAlloc(arena, size);
+	if (res != NULL)
+		memcpy(res, ptr, oldSize);
+	return res;
+}
+
+static size_t nsvg__gradientSize(const NSVGpaint* paint)
+{
+	if (paint->type != NSVG_PAINT_LINEAR_GRADIENT && paint->type != NSVG_PAINT_RADIAL_GRADIENT)
+		return 0;
+	return sizeof(NSVGgradient) + sizeof(NSVGgradientStop) * (size_t)(paint->gradient->nstops - 1);
+}
+
+static int nsvg__copyPaint(NSVGpaint* dst, const NSVGpaint* src, NSVGarena* arena)
+{
+	size_t size = nsvg__gradientSize(src);
+	*dst = *src;
+	if (size == 0)
+		return 1;
+	dst->gradient = (NSVGgradient*)nsvgArenaAlloc(arena, size);
+	if (dst->gradient == NULL)
+		return 0;
+	memcpy(dst->gradient, src->gradient, size);
+	return 1;
+}
+
+size_t nsvgPathsSize(const NSVGpath* paths)
+{
+	size_t size = 0;
+	for (; paths != NULL; paths = paths->next) {
+		size += NSVG__ARENA_ALIGN(sizeof(NSVGpath));
+		size += NSVG__ARENA_ALIGN((size_t)paths->npts * 2 * sizeof(float));
+	}
+	return size;
+}
+
+NSVGpath* nsvgCopyPaths(const NSVGpath* paths, NSVGarena* arena)
+{
+	NSVGpath* res = NULL;
+	NSVGpath** next = &res;
+	for (; paths != NULL; paths = paths->next) {
+		NSVGpath* path = (NSVGpath*)nsvgArenaAlloc(arena, sizeof(NSVGpath));
+		if (path == NULL) return NULL;
+		*path = *paths;
+		path->pts = (float*)nsvgArenaAlloc(arena, (size_t)paths->npts * 2 * sizeof(float));
+		if (path->pts == NULL) return NULL;
+		memcpy(path->pts, paths->pts, (size_t)paths->npts * 2 * sizeof(float));
+		path->next = NULL;
+		*next = path;
+		next = &path->next;
+	}
+	return res;
+}
+
+size_t nsvgImageSize(const NSVGimage* image)
+{
+	const NSVGshape* shape;
+	size_t size = NSVG__ARENA_ALIGN(sizeof(NSVGimage));
+	for (shape = image->shapes; shape != NULL; shape = shape->next) {
+		size += NSVG__ARENA_ALIGN(sizeof(NSVGshape));
+		size += NSVG__ARENA_ALIGN(nsvg__gradientSize(&shape->fill));
+		size += NSVG__ARENA_ALIGN(nsvg__gradientSize(&shape->stroke));
+		size += nsvgPathsSize(shape->paths);
+	}
+	return size;
+}
+
+NSVGimage* nsvgCopyImage(const NSVGimage* image, NSVGarena* arena)
+{
+	const NSVGshape* src;
+	NSVGshape** next;
+	NSVGimage* res = (NSVGimage*)nsvgArenaAlloc(arena, sizeof(NSVGimage));
+	if (res == NULL) return NULL;
+	*res = *image;
+	res->shapes = NULL;
+	next = &res->shapes;
+	for (src = image->shapes; src != NULL; src = src->next) {
+		NSVGshape* shape = (NSVGshape*)nsvgArenaAlloc(arena, sizeof(NSVGshape));
+		if (shape == NULL) return NULL;
+		*shape = *src;
+		shape->next = NULL;
+		if (!nsvg__copyPaint(&shape->fill, &src->fill, arena)) return NULL;
+		if (!nsvg__copyPaint(&shape->stroke, &src->stroke, arena)) return NULL;
+		shape->paths = NULL;
+		if (src->paths != NULL) {
+			shape->paths = nsvgCopyPaths(src->paths, arena);
+			if (shape->paths == NULL) return NULL;
+		}
+		*next = shape;
+		next = &shape->next;
+	}
+	return res;
+}
+
+size_t nsvgShapesSize(const NSVGimage* image)
+{
+	const NSVGshape* shape;
+	size_t size = NSVG__ARENA_ALIGN(sizeof(NSVGimage));
+	for (shape = image->shapes; shape != NULL; shape = shape->next)
+		size += NSVG__ARENA_ALIGN(sizeof(NSVGshape));
+	return size;
+}
+
+NSVGimage* nsvgCopyShapes(const NSVGimage* image, NSVGarena* arena)
+{
+	const NSVGshape* src;
+	NSVGshape** next;
+	NSVGimage* res = (NSVGimage*)nsvgArenaAlloc(arena, sizeof(NSVGimage));
+	if (res == NULL) return NULL;
+	*res = *image;
+	res->shapes = NULL;
+	next = &res->shapes;
+	for (src = image->shapes; src != NULL; src = src->next) {
+		NSVGshape* shape = (NSVGshape*)nsvgArenaAlloc(arena, sizeof(NSVGshape));
+		if (shape == NULL) return NULL;
+		*shape = *src;
+		shape->next = NULL;
+		*next = shape;
+		next = &shape->next;
+	}
+	return res;
+}
+
 void nsvgDelete(NSVGimage* image)
 {
 	NSVGshape *snext, *shape;
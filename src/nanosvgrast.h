@@ -21,6 +21,14 @@
  * by Sean Barrett - http://nothings.org/
  *
  * @remarks Modified by Daniel Starke to suppress compiler warnings.
+ * @remarks Modified by Daniel Starke to rasterize image regions and skip shapes outside of these.
+ * @remarks Modified by Daniel Starke to compose over existing image content.
+ * @remarks Modified by Daniel Starke to support RGB565 output.
+ * @remarks Modified by Daniel Starke to rasterize shapes from pre-flattened edges.
+ * @remarks Modified by Daniel Starke to measure the time spent per rasterizer stage.
+ * @remarks Modified by Daniel Starke to optionally sort edges by scanline buckets and keep active edges in arrays.
+ * @remarks Modified by Daniel Starke to pre-allocate the rasterizer within an arena and report allocation failures.
+ * @remarks Modified by Daniel Starke to optionally blend solid RGB565 spans with packed 32-bit operations.
  */
 
 #ifndef NANOSVGRAST_H
@@ -35,6 +43,33 @@ extern "C" {
 #endif
 
 typedef struct NSVGrasterizer NSVGrasterizer;
+typedef struct NSVGedge NSVGedge;
+
+// Pre-flattened shape edges which can be rasterized without flattening and sorting.
+typedef struct NSVGshapeEdges {
+	NSVGedge* edges;	// Fill edges followed by the stroke edges, each sorted for rasterization.
+	int nfill;			// Number of fill edges.
+	int nstroke;		// Number of stroke edges.
+	float bounds[4];	// Bounding box of all edges within the rendered image [minx,miny,maxx,maxy].
+} NSVGshapeEdges;
+
+enum NSVGpixelFormat {
+	NSVG_PIXEL_RGBA32 = 0,	// 4 bytes per pixel (RGBA), non-premultiplied alpha
+	NSVG_PIXEL_RGB565 = 1	// 2 bytes per pixel (native endian 16-bit RGB565), opaque
+};
+
+enum NSVGrasterFlags {
+	NSVG_RASTER_COMPOSE = 0x01	// Blend over the existing opaque destination content instead of clearing it.
+};
+
+// Rasterizer stages passed to NSVG_PROFILE(). The blend stage is nested within the fill stage.
+enum NSVGprofileStage {
+	NSVG_PROFILE_FLATTEN = 0,	// Flattening of paths into edges.
+	NSVG_PROFILE_SORT = 1,		// Sorting of the edges.
+	NSVG_PROFILE_FILL = 2,		// Scanline traversal of the sorted edges.
+	NSVG_PROFILE_BLEND = 3,		// Blending of the scanline coverage into the output pixel format.
+	NSVG_PROFILE_STAGES = 4
+};
 
 /* Example Usage:
 	// Load SVG
@@ -52,6 +87,23 @@ typedef struct NSVGrasterizer NSVGrasterizer;
 // Allocated rasterizer context.
 NSVGrasterizer* nsvgCreateRasterizer(void);
 
+// Returns the number of arena bytes needed by nsvgCreateRasterizerInArena() for the given image.
+// Returns 0 on allocation failure.
+//   image - pointer to image to rasterize
+//   scale - image scale
+//   w - maximum width of the regions to render
+size_t nsvgRasterizerSize(NSVGimage* image, float scale, int w);
+
+// Creates a rasterizer context with all of its buffers within the arena.
+// The buffers are sized by flattening all shapes of the image once with 25% headroom.
+// Rasterization fails instead of growing the buffers beyond the arena size.
+// Returns NULL if the arena is exhausted.
+//   arena - arena to allocate from
+//   image - pointer to image to rasterize
+//   scale - image scale
+//   w - maximum width of the regions to render
+NSVGrasterizer* nsvgCreateRasterizerInArena(NSVGarena* arena, NSVGimage* image, float scale, int w);
+
 // Rasterizes SVG image, returns RGBA image (non-premultiplied alpha)
 //   r - pointer to rasterizer context
 //   image - pointer to image to rasterize
@@ -65,6 +117,45 @@ void nsvgRasterize(NSVGrasterizer* r,
 				   NSVGimage* image, float tx, float ty, float scale,
 				   unsigned char* dst, int w, int h, int stride);
 
+// Rasterizes a region of the SVG image in the given pixel format
+// The result is identical to the same region of a full image rasterization.
+//   r - pointer to rasterizer context
+//   image - pointer to image to rasterize
+//   tx,ty - image offset (applied after scaling)
+//   scale - image scale
+//   dst - pointer to destination image data in the given pixel format
+//   x,y - position of the region within the rendered image
+//   w - width of the region to render
+//   h - height of the region to render
+//   stride - number of bytes per scaleline in the destination buffer
+//   format - destination pixel format (see NSVGpixelFormat)
+//   flags - combination of NSVGrasterFlags
+// Returns 1 on success and 0 if shapes were skipped due to allocation failures.
+int nsvgRasterizeRegion(NSVGrasterizer* r,
+				   NSVGimage* image, float tx, float ty, float scale,
+				   unsigned char* dst, int x, int y, int w, int h, int stride, int format, int flags);
+
+// Flattens the fill and stroke of the shape into rasterizer edges.
+// The edges are only valid for the given image offset and scale.
+// The returned edges point into rasterizer memory which gets overwritten by the next
+// rasterization. Copy them to keep them. Returns 1 on success and 0 on allocation failure.
+//   r - pointer to rasterizer context
+//   shape - pointer to shape to flatten
+//   tx,ty - image offset (applied after scaling)
+//   scale - image scale
+//   out - receives the flattened edges
+int nsvgFlattenShapeEdges(NSVGrasterizer* r, NSVGshape* shape, float tx, float ty, float scale,
+						  NSVGshapeEdges* out);
+
+// Rasterizes the shape from the given pre-flattened edges instead of its paths.
+// The edges need to be created with the same image offset and scale as used for rasterization
+// and need to outlive their use. Passing NULL as edges restores the default.
+// Returns 1 on success and 0 if the maximum number of shapes has been reached.
+//   r - pointer to rasterizer context
+//   shape - pointer to shape to set the edges for
+//   edges - pointer to the pre-flattened edges or NULL
+int nsvgSetShapeEdges(NSVGrasterizer* r, NSVGshape* shape, const NSVGshapeEdges* edges);
+
 // Deletes rasterizer context.
 void nsvgDeleteRasterizer(NSVGrasterizer*);
 
@@ -86,12 +177,29 @@ void nsvgDeleteRasterizer(NSVGrasterizer*);
 #define NSVG__FIX			(1 << NSVG__FIXSHIFT)
 #define NSVG__FIXMASK		(NSVG__FIX-1)
 #define NSVG__MEMPAGE_SIZE	1024
+#define NSVG__MAX_SHAPE_EDGES	4
+#define NSVG__MAX_BUCKETS	4096
+#define NSVG__ARENA_ALIGN8(x)	(((x) + 7) & ~(size_t)7)
+
+// Define NSVG_PROFILE(stage, statement) before including the implementation
+// to measure the time spent within each stage (see NSVGprofileStage).
+#ifndef NSVG_PROFILE
+#define NSVG_PROFILE(stage, statement) statement
+#endif
+
+// Define NSVG_FAST_EDGES before including the implementation to sort the edges
+// into scanline buckets instead of using qsort() and to keep the active edges in
+// contiguous arrays instead of a linked list. The output is identical.
+
+// Define NSVG_PACKED_PIXELS before including the implementation to blend solid
+// colored RGB565 spans with red and blue packed into the two 16-bit halves of a
+// 32-bit word and to store opaque runs two pixels per word. The output is identical.
 
-typedef struct NSVGedge {
+struct NSVGedge {
 	float x0,y0, x1,y1;
 	int dir;
 	struct NSVGedge* next;
-} NSVGedge;
+};
 
 typedef struct NSVGpoint {
 	float x, y;
@@ -148,9 +256,61 @@ struct NSVGrasterizer
 	int cscanline;
 
 	unsigned char* bitmap;
-	int width, height, stride;
+	int width, height, stride, format;
+	int ox, oy; // region offset within the rendered image
+
+	NSVGshape* edgeShapes[NSVG__MAX_SHAPE_EDGES]; // shapes using pre-flattened edges
+	const NSVGshapeEdges* shapeEdges[NSVG__MAX_SHAPE_EDGES];
+
+#ifdef NSVG_FAST_EDGES
+	int* order; // bucket sort output as source edge index
+	int corder;
+
+	int* buckets; // bucket start indices
+	int cbuckets;
+
+	int* active; // active edge table: x, dx, end and dir arrays of cactive entries each
+	int cactive;
+#endif
+
+	NSVGarena* arena; // source of all allocations or NULL for the heap
+	int nomem; // set if an allocation failed
 };
 
+// Resizes rasterizer memory without recording failures.
+static void* nsvg__tryRealloc(NSVGrasterizer* r, void* ptr, size_t oldSize, size_t size)
+{
+	if (r->arena != NULL)
+		return nsvgArenaRealloc(r->arena, ptr, oldSize, size);
+	return realloc(ptr, size);
+}
+
+// Resizes rasterizer memory. Keeps the passed memory and sets nomem on failure.
+static void* nsvg__rasterRealloc(NSVGrasterizer* r, void* ptr, size_t oldSize, size_t size)
+{
+	void* res = nsvg__tryRealloc(r, ptr, oldSize, size);
+	if (res == NULL)
+		r->nomem = 1;
+	return res;
+}
+
+#ifdef NSVG_FAST_EDGES
+static void nsvg__rasterFree(NSVGrasterizer* r, void* ptr)
+{
+	if (r->arena == NULL)
+		free(ptr);
+}
+#endif
+
+// Resizes the buffer of *cap elements to n elements and updates *cap on success.
+static void* nsvg__resizeBuffer(NSVGrasterizer* r, void* buf, int* cap, int n, size_t elemSize)
+{
+	void* res = nsvg__rasterRealloc(r, buf, elemSize * (size_t)*cap, elemSize * (size_t)n);
+	if (res != NULL)
+		*cap = n;
+	return res;
+}
+
 NSVGrasterizer* nsvgCreateRasterizer(void)
 {
 	NSVGrasterizer* r = (NSVGrasterizer*)malloc(sizeof(NSVGrasterizer));
@@ -172,6 +332,7 @@ void nsvgDeleteRasterizer(NSVGrasterizer* r)
 	NSVGmemPage* p;
 
 	if (r == NULL) return;
+	if (r->arena != NULL) return; // released with the arena
 
 	p = r->pages;
 	while (p != NULL) {
@@ -184,10 +345,16 @@ void nsvgDeleteRasterizer(NSVGrasterizer* r)
 	if (r->points) free(r->points);
 	if (r->points2) free(r->points2);
 	if (r->scanline) free(r->scanline);
+#ifdef NSVG_FAST_EDGES
+	if (r->order) free(r->order);
+	if (r->buckets) free(r->buckets);
+	if (r->active) free(r->active);
+#endif
 
 	free(r);
 }
 
+#ifndef NSVG_FAST_EDGES
 static NSVGmemPage* nsvg__nextPage(NSVGrasterizer* r, NSVGmemPage* cur)
 {
 	NSVGmemPage *newp;
@@ -198,7 +365,7 @@ static NSVGmemPage* nsvg__nextPage(NSVGrasterizer* r, NSVGmemPage* cur)
 	}
 
 	// Alloc new page
-	newp = (NSVGmemPage*)malloc(sizeof(NSVGmemPage));
+	newp = (NSVGmemPage*)nsvg__rasterRealloc(r, NULL, 0, sizeof(NSVGmemPage));
 	if (newp == NULL) return NULL;
 	memset(newp, 0, sizeof(NSVGmemPage));
 
@@ -210,6 +377,7 @@ static NSVGmemPage* nsvg__nextPage(NSVGrasterizer* r, NSVGmemPage* cur)
 
 	return newp;
 }
+#endif
 
 static void nsvg__resetPool(NSVGrasterizer* r)
 {
@@ -221,6 +389,7 @@ static void nsvg__resetPool(NSVGrasterizer* r)
 	r->curpage = r->pages;
 }
 
+#ifndef NSVG_FAST_EDGES
 static unsigned char* nsvg__alloc(NSVGrasterizer* r, int size)
 {
 	unsigned char* buf;
@@ -232,6 +401,7 @@ static unsigned char* nsvg__alloc(NSVGrasterizer* r, int size)
 	r->curpage->size += size;
 	return buf;
 }
+#endif
 
 static int nsvg__ptEquals(float x1, float y1, float x2, float y2, float tol)
 {
@@ -253,9 +423,9 @@ static void nsvg__addPathPoint(NSVGrasterizer* r, float x, float y, int flags)
 	}
 
 	if (r->npoints+1 > r->cpoints) {
-		r->cpoints = r->cpoints > 0 ? r->cpoints * 2 : 64;
-		r->points = (NSVGpoint*)realloc(r->points, sizeof(NSVGpoint) * r->cpoints);
-		if (r->points == NULL) return;
+		NSVGpoint* mem = (NSVGpoint*)nsvg__resizeBuffer(r, r->points, &r->cpoints, r->cpoints > 0 ? r->cpoints * 2 : 64, sizeof(NSVGpoint));
+		if (mem == NULL) return;
+		r->points = mem;
 	}
 
 	pt = &r->points[r->npoints];
@@ -268,9 +438,9 @@ static void nsvg__addPathPoint(NSVGrasterizer* r, float x, float y, int flags)
 static void nsvg__appendPathPoint(NSVGrasterizer* r, NSVGpoint pt)
 {
 	if (r->npoints+1 > r->cpoints) {
-		r->cpoints = r->cpoints > 0 ? r->cpoints * 2 : 64;
-		r->points = (NSVGpoint*)realloc(r->points, sizeof(NSVGpoint) * r->cpoints);
-		if (r->points == NULL) return;
+		NSVGpoint* mem = (NSVGpoint*)nsvg__resizeBuffer(r, r->points, &r->cpoints, r->cpoints > 0 ? r->cpoints * 2 : 64, sizeof(NSVGpoint));
+		if (mem == NULL) return;
+		r->points = mem;
 	}
 	r->points[r->npoints] = pt;
 	r->npoints++;
@@ -279,9 +449,9 @@ static void nsvg__appendPathPoint(NSVGrasterizer* r, NSVGpoint pt)
 static void nsvg__duplicatePoints(NSVGrasterizer* r)
 {
 	if (r->npoints > r->cpoints2) {
-		r->cpoints2 = r->npoints;
-		r->points2 = (NSVGpoint*)realloc(r->points2, sizeof(NSVGpoint) * r->cpoints2);
-		if (r->points2 == NULL) return;
+		NSVGpoint* mem = (NSVGpoint*)nsvg__resizeBuffer(r, r->points2, &r->cpoints2, r->npoints, sizeof(NSVGpoint));
+		if (mem == NULL) return;
+		r->points2 = mem;
 	}
 
 	memcpy(r->points2, r->points, sizeof(NSVGpoint) * r->npoints);
@@ -297,9 +467,9 @@ static void nsvg__addEdge(NSVGrasterizer* r, float x0, float y0, float x1, float
 		return;
 
 	if (r->nedges+1 > r->cedges) {
-		r->cedges = r->cedges > 0 ? r->cedges * 2 : 64;
-		r->edges = (NSVGedge*)realloc(r->edges, sizeof(NSVGedge) * r->cedges);
-		if (r->edges == NULL) return;
+		NSVGedge* mem = (NSVGedge*)nsvg__resizeBuffer(r, r->edges, &r->cedges, r->cedges > 0 ? r->cedges * 2 : 64, sizeof(NSVGedge));
+		if (mem == NULL) return;
+		r->edges = mem;
 	}
 
 	e = &r->edges[r->nedges];
@@ -855,7 +1025,100 @@ static int nsvg__cmpEdge(const void *p, const void *q)
 	return 0;
 }
 
+// Returns the first subsample scanline whose center lies at or below the given coordinate.
+static int nsvg__scanlineOf(float y)
+{
+	return (int)ceilf(y - 0.5f);
+}
+
+#ifdef NSVG_FAST_EDGES
+static void nsvg__sortEdges(NSVGrasterizer* r, NSVGedge* edges, int nedges)
+{
+	int i, j, k, kmin, kmax, range;
+	int* start;
+	int* order;
+
+	if (nedges < 2) return;
+
+	// bucket by the integer part of y0 which keeps the order of y0
+	kmin = kmax = (int)edges[0].y0;
+	for (i = 1; i < nedges; i++) {
+		k = (int)edges[i].y0;
+		if (k < kmin) kmin = k;
+		if (k > kmax) kmax = k;
+	}
+	range = kmax - kmin + 1;
+	if (range > NSVG__MAX_BUCKETS) {
+		qsort(edges, nedges, sizeof(NSVGedge), nsvg__cmpEdge);
+		return;
+	}
+	if (nedges > r->corder) {
+		int* mem = (int*)nsvg__tryRealloc(r, r->order, sizeof(int) * (size_t)r->corder, sizeof(int) * (size_t)nedges);
+		if (mem == NULL) {
+			qsort(edges, nedges, sizeof(NSVGedge), nsvg__cmpEdge);
+			return;
+		}
+		r->order = mem;
+		r->corder = nedges;
+	}
+	if (range + 1 > r->cbuckets) {
+		int* mem = (int*)nsvg__tryRealloc(r, r->buckets, sizeof(int) * (size_t)r->cbuckets, sizeof(int) * (size_t)(range + 1));
+		if (mem == NULL) {
+			qsort(edges, nedges, sizeof(NSVGedge), nsvg__cmpEdge);
+			return;
+		}
+		r->buckets = mem;
+		r->cbuckets = range + 1;
+	}
+
+	// stable counting sort of the edge indices into the buckets
+	start = r->buckets;
+	order = r->order;
+	memset(start, 0, sizeof(int) * (range + 1));
+	for (i = 0; i < nedges; i++)
+		start[(int)edges[i].y0 - kmin + 1]++;
+	for (i = 1; i < range; i++)
+		start[i] += start[i - 1];
+	for (i = 0; i < nedges; i++)
+		order[start[(int)edges[i].y0 - kmin]++] = i;
+
+	// stable insertion sort by y0 which only moves edges within their bucket
+	for (i = 1; i < nedges; i++) {
+		k = order[i];
+		if (edges[order[i - 1]].y0 > edges[k].y0) {
+			for (j = i; j > 0 && edges[order[j - 1]].y0 > edges[k].y0; j--)
+				order[j] = order[j - 1];
+			order[j] = k;
+		}
+	}
 
+	// apply the permutation in place by following its cycles
+	for (i = 0; i < nedges; i++) {
+		NSVGedge t;
+		if (order[i] < 0) continue; // already moved
+		t = edges[i];
+		j = i;
+		for (;;) {
+			k = order[j];
+			order[j] = -1;
+			if (k == i) {
+				edges[j] = t;
+				break;
+			}
+			edges[j] = edges[k];
+			j = k;
+		}
+	}
+}
+#else
+static void nsvg__sortEdges(NSVGrasterizer* r, NSVGedge* edges, int nedges)
+{
+	NSVG_NOTUSED(r);
+	qsort(edges, nedges, sizeof(NSVGedge), nsvg__cmpEdge);
+}
+#endif
+
+#ifndef NSVG_FAST_EDGES
 static NSVGactiveEdge* nsvg__addActive(NSVGrasterizer* r, NSVGedge* e, float startPoint)
 {
 	 NSVGactiveEdge* z;
@@ -891,6 +1154,7 @@ static void nsvg__freeActive(NSVGrasterizer* r, NSVGactiveEdge* z)
 	z->next = r->freelist;
 	r->freelist = z;
 }
+#endif
 
 static void nsvg__fillScanline(unsigned char* scanline, int len, int x0, int x1, int maxWeight, int* xmin, int* xmax)
 {
@@ -919,10 +1183,11 @@ static void nsvg__fillScanline(unsigned char* scanline, int len, int x0, int x1,
 	}
 }
 
+#ifndef NSVG_FAST_EDGES
 // note: this routine clips fills that extend off the edges... ideally this
 // wouldn't happen, but it could happen if the truetype glyph bounding boxes
 // are wrong, or if the user supplies a too-small bitmap
-static void nsvg__fillActiveEdges(unsigned char* scanline, int len, NSVGactiveEdge* e, int maxWeight, int* xmin, int* xmax, char fillRule)
+static void nsvg__fillActiveEdges(unsigned char* scanline, int len, NSVGactiveEdge* e, int xoff, int maxWeight, int* xmin, int* xmax, char fillRule)
 {
 	// non-zero winding fill
 	int x0 = 0, w = 0;
@@ -932,9 +1197,9 @@ static void nsvg__fillActiveEdges(unsigned char* scanline, int len, NSVGactiveEd
 		while (e != NULL) {
 			if (w == 0) {
 				// if we're currently at zero, we need to record the edge start point
-				x0 = e->x; w += e->dir;
+				x0 = e->x - xoff; w += e->dir;
 			} else {
-				int x1 = e->x; w += e->dir;
+				int x1 = e->x - xoff; w += e->dir;
 				// if we went to zero, we need to draw
 				if (w == 0)
 					nsvg__fillScanline(scanline, len, x0, x1, maxWeight, xmin, xmax);
@@ -946,9 +1211,9 @@ static void nsvg__fillActiveEdges(unsigned char* scanline, int len, NSVGactiveEd
 		while (e != NULL) {
 			if (w == 0) {
 				// if we're currently at zero, we need to record the edge start point
-				x0 = e->x; w = 1;
+				x0 = e->x - xoff; w = 1;
 			} else {
-				int x1 = e->x; w = 0;
+				int x1 = e->x - xoff; w = 0;
 				nsvg__fillScanline(scanline, len, x0, x1, maxWeight, xmin, xmax);
 			}
 			e = e->next;
@@ -956,6 +1221,31 @@ static void nsvg__fillActiveEdges(unsigned char* scanline, int len, NSVGactiveEd
 	}
 }
 
+#else
+// Same as nsvg__fillActiveEdges() for the sorted arrays of the active edge table.
+static void nsvg__fillActiveTable(unsigned char* scanline, int len, const int* ax, const int* adir, int n, int xoff, int maxWeight, int* xmin, int* xmax, char fillRule)
+{
+	int i, x0 = 0, w = 0;
+
+	if (fillRule == NSVG_FILLRULE_NONZERO) {
+		// Non-zero
+		for (i = 0; i < n; i++) {
+			if (w == 0) {
+				x0 = ax[i] - xoff; w += adir[i];
+			} else {
+				int x1 = ax[i] - xoff; w += adir[i];
+				if (w == 0)
+					nsvg__fillScanline(scanline, len, x0, x1, maxWeight, xmin, xmax);
+			}
+		}
+	} else if (fillRule == NSVG_FILLRULE_EVENODD) {
+		// Even-odd
+		for (i = 0; i + 1 < n; i += 2)
+			nsvg__fillScanline(scanline, len, ax[i] - xoff, ax[i + 1] - xoff, maxWeight, xmin, xmax);
+	}
+}
+#endif
+
 static float nsvg__clampf(float a, float mn, float mx) { return a < mn ? mn : (a > mx ? mx : a); }
 
 static unsigned int nsvg__RGBA(unsigned char r, unsigned char g, unsigned char b, unsigned char a)
@@ -988,10 +1278,123 @@ static inline int nsvg__div255(int x)
     return ((x+1) * 257) >> 16;
 }
 
+// Blends the premultiplied color r,g,b with the coverage alpha a over an RGBA pixel.
+static inline void nsvg__blendRGBA(unsigned char* dst, int r, int g, int b, int a)
+{
+	int ia = 255 - a;
+
+	// Blend over
+	r += nsvg__div255(ia * (int)dst[0]);
+	g += nsvg__div255(ia * (int)dst[1]);
+	b += nsvg__div255(ia * (int)dst[2]);
+	a += nsvg__div255(ia * (int)dst[3]);
+
+	dst[0] = (unsigned char)r;
+	dst[1] = (unsigned char)g;
+	dst[2] = (unsigned char)b;
+	dst[3] = (unsigned char)a;
+}
+
+// Blends the premultiplied color r,g,b with the coverage alpha a over an opaque RGB565 pixel.
+static inline void nsvg__blendRGB565(unsigned char* dst, int r, int g, int b, int a)
+{
+	unsigned short* px = (unsigned short*)dst;
+	int ia = 255 - a;
+	int dr, dg, db;
+
+	if (a == 0) return;
+	if (ia != 0) {
+		// Expand to 8 bits per channel and blend over
+		dr = (*px >> 8) & 0xf8;
+		dg = (*px >> 3) & 0xfc;
+		db = (*px << 3) & 0xf8;
+		r += nsvg__div255(ia * (dr | (dr >> 5)));
+		g += nsvg__div255(ia * (dg | (dg >> 6)));
+		b += nsvg__div255(ia * (db | (db >> 5)));
+	}
+
+	*px = (unsigned short)(((r & 0xf8) << 8) | ((g & 0xfc) << 3) | (b >> 3));
+}
+
+#ifdef NSVG_PACKED_PIXELS
+#ifdef __GNUC__
+typedef unsigned int __attribute__((__may_alias__)) NSVGpixelPair;
+#else
+typedef unsigned int NSVGpixelPair;
+#endif
+
+// Divides both 16-bit halves of x by 255 (same as nsvg__div255() per half).
+static inline unsigned int nsvg__div255x2(unsigned int x)
+{
+	x += 0x00010001u;
+	return ((x + ((x >> 8) & 0x00ff00ffu)) >> 8) & 0x00ff00ffu;
+}
+
+// Fills count RGB565 pixels with the given color. Stores two pixels per 32-bit word.
+static void nsvg__fillRGB565(unsigned short* dst, int count, unsigned short color)
+{
+	NSVGpixelPair* pair;
+	unsigned int c2 = ((unsigned int)color << 16) | color;
+	if (count > 0 && ((size_t)dst & 2) != 0) {
+		*dst++ = color;
+		count--;
+	}
+	for (pair = (NSVGpixelPair*)dst; count >= 2; count -= 2)
+		*pair++ = c2;
+	if (count > 0)
+		*(unsigned short*)pair = color;
+}
+
+// Blends the non-premultiplied color c (RGBA) with the coverage scanline over count opaque
+// RGB565 pixels. Red and blue are processed within the two 16-bit halves of a 32-bit word.
+// The output is the same as with nsvg__blendRGB565().
+static void nsvg__blendSpanRGB565(unsigned short* dst, int count, const unsigned char* cover, unsigned int c)
+{
+	unsigned int crb = ((c & 0xff) << 16) | ((c >> 16) & 0xff);
+	unsigned int cg = (c >> 8) & 0xff;
+	unsigned int ca = (c >> 24) & 0xff;
+	unsigned short opaque = (unsigned short)(((crb >> 8) & 0xf800) | ((cg & 0xfc) << 3) | ((crb & 0xff) >> 3));
+	int i, n;
+
+	for (i = 0; i < count; i++) {
+		unsigned int a = cover[i];
+		unsigned int rb, g, drb, dg, px, ia;
+		if (ca != 255) a = (unsigned int)nsvg__div255((int)(a * ca));
+		if (a == 0) continue;
+		if (a == 255) {
+			// Opaque run
+			for (n = 1; (i + n) < count && cover[i + n] == 255; n++);
+			nsvg__fillRGB565(dst + i, n, opaque);
+			i += n - 1;
+			continue;
+		}
+		// Premultiply
+		rb = nsvg__div255x2(crb * a);
+		g = (unsigned int)nsvg__div255((int)(cg * a));
+		// Expand to 8 bits per channel and blend over
+		ia = 255 - a;
+		px = dst[i];
+		drb = ((px << 8) & 0xf80000) | ((px << 3) & 0xf8);
+		drb |= (drb >> 5) & 0x00070007;
+		dg = (px >> 3) & 0xfc;
+		rb += nsvg__div255x2(drb * ia);
+		g += (unsigned int)nsvg__div255((int)(ia * (dg | (dg >> 6))));
+		dst[i] = (unsigned short)(((rb >> 8) & 0xf800) | ((g & 0xfc) << 3) | ((rb & 0xff) >> 3));
+	}
+}
+#endif
+
 static void nsvg__scanlineSolid(unsigned char* dst, int count, unsigned char* cover, int x, int y,
-								float tx, float ty, float scale, NSVGcachedPaint* cache)
+								float tx, float ty, float scale, NSVGcachedPaint* cache, int format)
 {
+	int bpp = (format == NSVG_PIXEL_RGB565) ? 2 : 4;
 
+#ifdef NSVG_PACKED_PIXELS
+	if (cache->type == NSVG_PAINT_COLOR && format == NSVG_PIXEL_RGB565) {
+		nsvg__blendSpanRGB565((unsigned short*)dst, count, cover, cache->colors[0]);
+		return;
+	}
+#endif
 	if (cache->type == NSVG_PAINT_COLOR) {
 		int i, cr, cg, cb, ca;
 		cr = cache->colors[0] & 0xff;
@@ -1002,25 +1405,18 @@ static void nsvg__scanlineSolid(unsigned char* dst, int count, unsigned char* co
 		for (i = 0; i < count; i++) {
 			int r,g,b;
 			int a = nsvg__div255((int)cover[0] * ca);
-			int ia = 255 - a;
 			// Premultiply
 			r = nsvg__div255(cr * a);
 			g = nsvg__div255(cg * a);
 			b = nsvg__div255(cb * a);
 
-			// Blend over
-			r += nsvg__div255(ia * (int)dst[0]);
-			g += nsvg__div255(ia * (int)dst[1]);
-			b += nsvg__div255(ia * (int)dst[2]);
-			a += nsvg__div255(ia * (int)dst[3]);
-
-			dst[0] = (unsigned char)r;
-			dst[1] = (unsigned char)g;
-			dst[2] = (unsigned char)b;
-			dst[3] = (unsigned char)a;
+			if (format == NSVG_PIXEL_RGB565)
+				nsvg__blendRGB565(dst, r, g, b, a);
+			else
+				nsvg__blendRGBA(dst, r, g, b, a);
 
 			cover++;
-			dst += 4;
+			dst += bpp;
 		}
 	} else if (cache->type == NSVG_PAINT_LINEAR_GRADIENT) {
 		// TODO: spread modes.
@@ -1035,7 +1431,7 @@ static void nsvg__scanlineSolid(unsigned char* dst, int count, unsigned char* co
 		dx = 1.0f / scale;
 
 		for (i = 0; i < count; i++) {
-			int r,g,b,a,ia;
+			int r,g,b,a;
 			gy = fx*t[1] + fy*t[3] + t[5];
 			c = cache->colors[(int)nsvg__clampf(gy*255.0f, 0, 255.0f)];
 			cr = (c) & 0xff;
@@ -1044,26 +1440,19 @@ static void nsvg__scanlineSolid(unsigned char* dst, int count, unsigned char* co
 			ca = (c >> 24) & 0xff;
 
 			a = nsvg__div255((int)cover[0] * ca);
-			ia = 255 - a;
 
 			// Premultiply
 			r = nsvg__div255(cr * a);
 			g = nsvg__div255(cg * a);
 			b = nsvg__div255(cb * a);
 
-			// Blend over
-			r += nsvg__div255(ia * (int)dst[0]);
-			g += nsvg__div255(ia * (int)dst[1]);
-			b += nsvg__div255(ia * (int)dst[2]);
-			a += nsvg__div255(ia * (int)dst[3]);
-
-			dst[0] = (unsigned char)r;
-			dst[1] = (unsigned char)g;
-			dst[2] = (unsigned char)b;
-			dst[3] = (unsigned char)a;
+			if (format == NSVG_PIXEL_RGB565)
+				nsvg__blendRGB565(dst, r, g, b, a);
+			else
+				nsvg__blendRGBA(dst, r, g, b, a);
 
 			cover++;
-			dst += 4;
+			dst += bpp;
 			fx += dx;
 		}
 	} else if (cache->type == NSVG_PAINT_RADIAL_GRADIENT) {
@@ -1080,7 +1469,7 @@ static void nsvg__scanlineSolid(unsigned char* dst, int count, unsigned char* co
 		dx = 1.0f / scale;
 
 		for (i = 0; i < count; i++) {
-			int r,g,b,a,ia;
+			int r,g,b,a;
 			gx = fx*t[0] + fy*t[2] + t[4];
 			gy = fx*t[1] + fy*t[3] + t[5];
 			gd = sqrtf(gx*gx + gy*gy);
@@ -1091,43 +1480,190 @@ static void nsvg__scanlineSolid(unsigned char* dst, int count, unsigned char* co
 			ca = (c >> 24) & 0xff;
 
 			a = nsvg__div255((int)cover[0] * ca);
-			ia = 255 - a;
 
 			// Premultiply
 			r = nsvg__div255(cr * a);
 			g = nsvg__div255(cg * a);
 			b = nsvg__div255(cb * a);
 
-			// Blend over
-			r += nsvg__div255(ia * (int)dst[0]);
-			g += nsvg__div255(ia * (int)dst[1]);
-			b += nsvg__div255(ia * (int)dst[2]);
-			a += nsvg__div255(ia * (int)dst[3]);
-
-			dst[0] = (unsigned char)r;
-			dst[1] = (unsigned char)g;
-			dst[2] = (unsigned char)b;
-			dst[3] = (unsigned char)a;
+			if (format == NSVG_PIXEL_RGB565)
+				nsvg__blendRGB565(dst, r, g, b, a);
+			else
+				nsvg__blendRGBA(dst, r, g, b, a);
 
 			cover++;
-			dst += 4;
+			dst += bpp;
 			fx += dx;
 		}
 	}
 }
 
-static void nsvg__rasterizeSortedEdges(NSVGrasterizer *r, float tx, float ty, float scale, NSVGcachedPaint* cache, char fillRule)
+#ifdef NSVG_FAST_EDGES
+// Grows the active edge table to c entries keeping its first n entries.
+static int nsvg__growActive(NSVGrasterizer* r, int n, int c)
+{
+	int* mem = (int*)nsvg__rasterRealloc(r, NULL, 0, sizeof(int) * 4 * (size_t)c);
+	int i;
+	if (mem == NULL) return 0;
+	if (r->active != NULL) {
+		for (i = 0; i < 4; i++)
+			memcpy(mem + i * c, r->active + i * r->cactive, sizeof(int) * (size_t)n);
+		nsvg__rasterFree(r, r->active);
+	}
+	r->active = mem;
+	r->cactive = c;
+	return 1;
+}
+
+static void nsvg__rasterizeSortedEdges(NSVGrasterizer *r, NSVGedge* edges, int nedges, float tx, float ty, float scale, NSVGcachedPaint* cache, char fillRule)
+{
+	int *ax, *adx, *aend, *adir;
+	int nactive = 0;
+	int y, s, i, j;
+	int e = 0, estart = 0;
+	int maxWeight = (255 / NSVG__SUBSAMPLES);  // weight per vertical scanline
+	int xmin = 0, xmax = 0;
+	int xoff = r->ox * NSVG__FIX; // exact region offset in fixed point
+	int ystart = 0;
+
+	if (r->cactive == 0 && !nsvg__growActive(r, 0, 64)) return;
+	ax = r->active;
+	adx = ax + r->cactive;
+	aend = adx + r->cactive;
+	adir = aend + r->cactive;
+
+	// skip empty lines above the first edge
+	if (nedges > 0) {
+		if (edges[0].y0 > 0.0f)
+			ystart = (int)(edges[0].y0 / NSVG__SUBSAMPLES);
+		estart = nsvg__scanlineOf(edges[0].y0);
+	}
+
+	// lines above the region only advance the active edges to stay identical to a full rasterization
+	for (y = ystart; y < r->oy + r->height; y++) {
+		int draw = y >= r->oy;
+		if (draw) {
+			memset(r->scanline, 0, r->width);
+			xmin = r->width;
+			xmax = 0;
+		}
+		for (s = 0; s < NSVG__SUBSAMPLES; ++s) {
+			// the center of this subsample scanline is at line + 0.5
+			int line = y*NSVG__SUBSAMPLES + s;
+
+			// remove all active edges that terminate before the center of this scanline
+			// and advance the others to their position on this scanline
+			for (i = 0, j = 0; i < nactive; i++) {
+				if (aend[i] > line) {
+					ax[j] = ax[i] + adx[i];
+					adx[j] = adx[i];
+					aend[j] = aend[i];
+					adir[j] = adir[i];
+					j++;
+				}
+			}
+			nactive = j;
+
+			// resort the table if needed (stable, edges rarely cross)
+			for (i = 1; i < nactive; i++) {
+				if (ax[i - 1] > ax[i]) {
+					int tx0 = ax[i], tdx = adx[i], tend = aend[i], tdir = adir[i];
+					for (j = i; j > 0 && ax[j - 1] > tx0; j--) {
+						ax[j] = ax[j - 1];
+						adx[j] = adx[j - 1];
+						aend[j] = aend[j - 1];
+						adir[j] = adir[j - 1];
+					}
+					ax[j] = tx0;
+					adx[j] = tdx;
+					aend[j] = tend;
+					adir[j] = tdir;
+				}
+			}
+
+			// insert all edges that start before the center of this scanline -- omit ones that also end on this scanline
+			while (e < nedges && estart <= line) {
+				int eend = nsvg__scanlineOf(edges[e].y1);
+				if (eend > line) {
+					NSVGedge* z = &edges[e];
+					float scany = (float)line + 0.5f;
+					float dxdy = (z->x1 - z->x0) / (z->y1 - z->y0);
+					int zx, zdx, pos;
+					// round dx down to avoid going too far
+					if (dxdy < 0)
+						zdx = (int)(-nsvg__roundf(NSVG__FIX * -dxdy));
+					else
+						zdx = (int)nsvg__roundf(NSVG__FIX * dxdy);
+					zx = (int)nsvg__roundf(NSVG__FIX * (z->x0 + dxdy * (scany - z->y0)));
+					if (nactive == r->cactive) {
+						if (!nsvg__growActive(r, nactive, r->cactive * 2)) break;
+						ax = r->active;
+						adx = ax + r->cactive;
+						aend = adx + r->cactive;
+						adir = aend + r->cactive;
+					}
+					// same insertion point as the linked list version
+					pos = 0;
+					if (nactive > 0 && zx >= ax[0]) {
+						pos = 1;
+						while (pos < nactive && ax[pos] < zx)
+							pos++;
+					}
+					for (j = nactive; j > pos; j--) {
+						ax[j] = ax[j - 1];
+						adx[j] = adx[j - 1];
+						aend[j] = aend[j - 1];
+						adir[j] = adir[j - 1];
+					}
+					ax[pos] = zx;
+					adx[pos] = zdx;
+					aend[pos] = eend;
+					adir[pos] = z->dir;
+					nactive++;
+				}
+				e++;
+				if (e < nedges)
+					estart = nsvg__scanlineOf(edges[e].y0);
+			}
+
+			// now process all active edges in non-zero fashion
+			if (nactive > 0 && draw)
+				nsvg__fillActiveTable(r->scanline, r->width, ax, adir, nactive, xoff, maxWeight, &xmin, &xmax, fillRule);
+		}
+		if (!draw)
+			continue;
+		// Blit
+		if (xmin < 0) xmin = 0;
+		if (xmax > r->width-1) xmax = r->width-1;
+		if (xmin <= xmax) {
+			int bpp = (r->format == NSVG_PIXEL_RGB565) ? 2 : 4;
+			NSVG_PROFILE(NSVG_PROFILE_BLEND, nsvg__scanlineSolid(&r->bitmap[(y - r->oy) * r->stride] + xmin*bpp, xmax-xmin+1, &r->scanline[xmin], xmin + r->ox, y, tx,ty, scale, cache, r->format));
+		}
+	}
+}
+#else
+static void nsvg__rasterizeSortedEdges(NSVGrasterizer *r, NSVGedge* edges, int nedges, float tx, float ty, float scale, NSVGcachedPaint* cache, char fillRule)
 {
 	NSVGactiveEdge *active = NULL;
 	int y, s;
 	int e = 0;
 	int maxWeight = (255 / NSVG__SUBSAMPLES);  // weight per vertical scanline
-	int xmin, xmax;
-
-	for (y = 0; y < r->height; y++) {
-		memset(r->scanline, 0, r->width);
-		xmin = r->width;
-		xmax = 0;
+	int xmin = 0, xmax = 0;
+	int xoff = r->ox * NSVG__FIX; // exact region offset in fixed point
+	int ystart = 0;
+
+	// skip empty lines above the first edge
+	if (nedges > 0 && edges[0].y0 > 0.0f)
+		ystart = (int)(edges[0].y0 / NSVG__SUBSAMPLES);
+
+	// lines above the region only advance the active edges to stay identical to a full rasterization
+	for (y = ystart; y < r->oy + r->height; y++) {
+		int draw = y >= r->oy;
+		if (draw) {
+			memset(r->scanline, 0, r->width);
+			xmin = r->width;
+			xmax = 0;
+		}
 		for (s = 0; s < NSVG__SUBSAMPLES; ++s) {
 			// find center of pixel for this scanline
 			float scany = (float)(y*NSVG__SUBSAMPLES + s) + 0.5f;
@@ -1166,9 +1702,9 @@ static void nsvg__rasterizeSortedEdges(NSVGrasterizer *r, float tx, float ty, fl
 			}
 
 			// insert all edges that start before the center of this scanline -- omit ones that also end on this scanline
-			while (e < r->nedges && r->edges[e].y0 <= scany) {
-				if (r->edges[e].y1 > scany) {
-					NSVGactiveEdge* z = nsvg__addActive(r, &r->edges[e], scany);
+			while (e < nedges && edges[e].y0 <= scany) {
+				if (edges[e].y1 > scany) {
+					NSVGactiveEdge* z = nsvg__addActive(r, &edges[e], scany);
 					if (z == NULL) break;
 					// find insertion point
 					if (active == NULL) {
@@ -1191,18 +1727,22 @@ static void nsvg__rasterizeSortedEdges(NSVGrasterizer *r, float tx, float ty, fl
 			}
 
 			// now process all active edges in non-zero fashion
-			if (active != NULL)
-				nsvg__fillActiveEdges(r->scanline, r->width, active, maxWeight, &xmin, &xmax, fillRule);
+			if (active != NULL && draw)
+				nsvg__fillActiveEdges(r->scanline, r->width, active, xoff, maxWeight, &xmin, &xmax, fillRule);
 		}
+		if (!draw)
+			continue;
 		// Blit
 		if (xmin < 0) xmin = 0;
 		if (xmax > r->width-1) xmax = r->width-1;
 		if (xmin <= xmax) {
-			nsvg__scanlineSolid(&r->bitmap[y * r->stride] + xmin*4, xmax-xmin+1, &r->scanline[xmin], xmin, y, tx,ty, scale, cache);
+			int bpp = (r->format == NSVG_PIXEL_RGB565) ? 2 : 4;
+			NSVG_PROFILE(NSVG_PROFILE_BLEND, nsvg__scanlineSolid(&r->bitmap[(y - r->oy) * r->stride] + xmin*bpp, xmax-xmin+1, &r->scanline[xmin], xmin + r->ox, y, tx,ty, scale, cache, r->format));
 		}
 	}
 
 }
+#endif
 
 static void nsvg__unpremultiplyAlpha(unsigned char* image, int w, int h, int stride)
 {
@@ -1367,12 +1907,272 @@ static void dumpEdges(NSVGrasterizer* r, const char* name)
 }
 */
 
+// Returns non-zero if the shape including its stroke lies completely outside of the
+// destination region and can be skipped.
+static int nsvg__isShapeClipped(NSVGshape* shape, float tx, float ty, float scale, int x, int y, int w, int h)
+{
+	float pad = 1.0f; // anti-aliasing
+	if (shape->stroke.type != NSVG_PAINT_NONE) {
+		// miter joins may exceed half the line width up to the miter limit
+		pad += shape->strokeWidth * scale * 0.5f * nsvg__maxf(shape->miterLimit, 1.5f);
+	}
+	return (shape->bounds[2] * scale + tx + pad) < (float)x
+		|| (shape->bounds[3] * scale + ty + pad) < (float)y
+		|| (shape->bounds[0] * scale + tx - pad) > (float)(x + w)
+		|| (shape->bounds[1] * scale + ty - pad) > (float)(y + h);
+}
+
+// Returns non-zero if the given edge bounds lie completely outside of the destination region.
+static int nsvg__isEdgeBoundsClipped(const float* bounds, int x, int y, int w, int h)
+{
+	return (bounds[2] + 1.0f) < (float)x
+		|| (bounds[3] + 1.0f) < (float)y
+		|| (bounds[0] - 1.0f) > (float)(x + w)
+		|| (bounds[1] - 1.0f) > (float)(y + h);
+}
+
+// Scales and translates the edges to subsample coordinates.
+static void nsvg__translateEdges(NSVGedge* edges, int nedges, float tx, float ty)
+{
+	NSVGedge *e = NULL;
+	int i;
+	for (i = 0; i < nedges; i++) {
+		e = &edges[i];
+		e->x0 = tx + e->x0;
+		e->y0 = (ty + e->y0) * NSVG__SUBSAMPLES;
+		e->x1 = tx + e->x1;
+		e->y1 = (ty + e->y1) * NSVG__SUBSAMPLES;
+	}
+}
+
+static const NSVGshapeEdges* nsvg__findShapeEdges(NSVGrasterizer* r, NSVGshape* shape)
+{
+	int i;
+	for (i = 0; i < NSVG__MAX_SHAPE_EDGES; i++) {
+		if (r->edgeShapes[i] == shape)
+			return r->shapeEdges[i];
+	}
+	return NULL;
+}
+
+int nsvgFlattenShapeEdges(NSVGrasterizer* r, NSVGshape* shape, float tx, float ty, float scale,
+						  NSVGshapeEdges* out)
+{
+	NSVGedge *e = NULL;
+	int i;
+
+	r->nedges = 0;
+	r->nomem = 0;
+	if (shape->fill.type != NSVG_PAINT_NONE)
+		NSVG_PROFILE(NSVG_PROFILE_FLATTEN, nsvg__flattenShape(r, shape, scale));
+	out->nfill = r->nedges;
+	if (shape->stroke.type != NSVG_PAINT_NONE && (shape->strokeWidth * scale) > 0.01f)
+		NSVG_PROFILE(NSVG_PROFILE_FLATTEN, nsvg__flattenShapeStroke(r, shape, scale));
+	out->nstroke = r->nedges - out->nfill;
+	if (r->nomem)
+		return 0;
+
+	nsvg__translateEdges(r->edges, r->nedges, tx, ty);
+	if (out->nfill != 0)
+		NSVG_PROFILE(NSVG_PROFILE_SORT, nsvg__sortEdges(r, r->edges, out->nfill));
+	if (out->nstroke != 0)
+		NSVG_PROFILE(NSVG_PROFILE_SORT, nsvg__sortEdges(r, r->edges + out->nfill, out->nstroke));
+
+	out->edges = r->edges;
+	out->bounds[0] = out->bounds[1] = out->bounds[2] = out->bounds[3] = 0.0f;
+	for (i = 0; i < r->nedges; i++) {
+		e = &r->edges[i];
+		if (i == 0) {
+			out->bounds[0] = nsvg__minf(e->x0, e->x1);
+			out->bounds[1] = e->y0;
+			out->bounds[2] = nsvg__maxf(e->x0, e->x1);
+			out->bounds[3] = e->y1;
+		} else {
+			out->bounds[0] = nsvg__minf(out->bounds[0], nsvg__minf(e->x0, e->x1));
+			out->bounds[1] = nsvg__minf(out->bounds[1], e->y0);
+			out->bounds[2] = nsvg__maxf(out->bounds[2], nsvg__maxf(e->x0, e->x1));
+			out->bounds[3] = nsvg__maxf(out->bounds[3], e->y1);
+		}
+	}
+	out->bounds[1] /= NSVG__SUBSAMPLES;
+	out->bounds[3] /= NSVG__SUBSAMPLES;
+	return 1;
+}
+
+int nsvgSetShapeEdges(NSVGrasterizer* r, NSVGshape* shape, const NSVGshapeEdges* edges)
+{
+	int i, slot = -1;
+	for (i = 0; i < NSVG__MAX_SHAPE_EDGES; i++) {
+		if (r->edgeShapes[i] == shape) {
+			slot = i;
+			break;
+		}
+		if (slot < 0 && r->edgeShapes[i] == NULL)
+			slot = i;
+	}
+	if (slot < 0)
+		return edges == NULL;
+	r->edgeShapes[slot] = (edges != NULL) ? shape : NULL;
+	r->shapeEdges[slot] = edges;
+	return 1;
+}
+
+typedef struct NSVGrasterLimits {
+	int edges, points, points2; // buffer capacities in elements
+	int order, buckets; // bucket sort capacities in elements
+	int active; // maximum number of active edges
+} NSVGrasterLimits;
+
+// Returns the maximum number of edges active at once or -1 on allocation failure.
+static int nsvg__maxActiveEdges(const NSVGedge* edges, int nedges)
+{
+	int i, n = 0, res = 0, lmin, lmax;
+	int* diff;
+
+	if (nedges == 0) return 0;
+
+	lmin = lmax = nsvg__scanlineOf(edges[0].y0);
+	for (i = 0; i < nedges; i++) {
+		int s0 = nsvg__scanlineOf(edges[i].y0);
+		int s1 = nsvg__scanlineOf(edges[i].y1);
+		if (s0 < lmin) lmin = s0;
+		if (s1 > lmax) lmax = s1;
+	}
+	diff = (int*)malloc(sizeof(int) * (size_t)(lmax - lmin + 1));
+	if (diff == NULL) return -1;
+	memset(diff, 0, sizeof(int) * (size_t)(lmax - lmin + 1));
+	for (i = 0; i < nedges; i++) {
+		int s0 = nsvg__scanlineOf(edges[i].y0);
+		int s1 = nsvg__scanlineOf(edges[i].y1);
+		if (s1 > s0) {
+			diff[s0 - lmin]++;
+			diff[s1 - lmin]--;
+		}
+	}
+	for (i = 0; i <= lmax - lmin; i++) {
+		n += diff[i];
+		if (n > res) res = n;
+	}
+	free(diff);
+	return res;
+}
+
+// Flattens all shapes of the image with a temporary heap rasterizer to find the
+// buffer sizes plus 25% headroom for transformed shapes.
+static int nsvg__measureRasterizer(NSVGimage* image, float scale, NSVGrasterLimits* lim)
+{
+	NSVGrasterizer* r = nsvgCreateRasterizer();
+	NSVGshape* shape;
+	NSVGshapeEdges out;
+	int ok = 1;
+
+	if (r == NULL) return 0;
+	memset(lim, 0, sizeof(NSVGrasterLimits));
+
+	for (shape = image->shapes; shape != NULL; shape = shape->next) {
+		int nfill, nstroke;
+		if (!nsvgFlattenShapeEdges(r, shape, 0, 0, scale, &out)) {
+			ok = 0;
+			break;
+		}
+		nfill = nsvg__maxActiveEdges(out.edges, out.nfill);
+		nstroke = nsvg__maxActiveEdges(out.edges + out.nfill, out.nstroke);
+		if (nfill < 0 || nstroke < 0) {
+			ok = 0;
+			break;
+		}
+		if (nfill > lim->active) lim->active = nfill;
+		if (nstroke > lim->active) lim->active = nstroke;
+	}
+
+	lim->edges = r->cedges + r->cedges / 4;
+	lim->points = r->cpoints + r->cpoints / 4;
+	lim->points2 = r->cpoints2 + r->cpoints2 / 4;
+#ifdef NSVG_FAST_EDGES
+	lim->order = r->corder + r->corder / 4;
+	lim->buckets = r->cbuckets + r->cbuckets / 4;
+#endif
+	lim->active = lim->active + lim->active / 4;
+
+	nsvgDeleteRasterizer(r);
+	return ok;
+}
+
+size_t nsvgRasterizerSize(NSVGimage* image, float scale, int w)
+{
+	NSVGrasterLimits lim;
+	size_t size;
+
+	if (!nsvg__measureRasterizer(image, scale, &lim)) return 0;
+
+	size = NSVG__ARENA_ALIGN8(sizeof(NSVGrasterizer));
+	size += NSVG__ARENA_ALIGN8(sizeof(NSVGedge) * (size_t)lim.edges);
+	size += NSVG__ARENA_ALIGN8(sizeof(NSVGpoint) * (size_t)lim.points);
+	size += NSVG__ARENA_ALIGN8(sizeof(NSVGpoint) * (size_t)lim.points2);
+	size += NSVG__ARENA_ALIGN8((size_t)w);
+#ifdef NSVG_FAST_EDGES
+	size += NSVG__ARENA_ALIGN8(sizeof(int) * (size_t)lim.order);
+	size += NSVG__ARENA_ALIGN8(sizeof(int) * (size_t)lim.buckets);
+	size += NSVG__ARENA_ALIGN8(sizeof(int) * 4 * (size_t)lim.active);
+#else
+	{
+		const int perPage = NSVG__MEMPAGE_SIZE / (int)sizeof(NSVGactiveEdge);
+		size += NSVG__ARENA_ALIGN8(sizeof(NSVGmemPage)) * (size_t)((lim.active + perPage - 1) / perPage);
+	}
+#endif
+	return size;
+}
+
+NSVGrasterizer* nsvgCreateRasterizerInArena(NSVGarena* arena, NSVGimage* image, float scale, int w)
+{
+	NSVGrasterLimits lim;
+	NSVGrasterizer* r;
+
+	if (!nsvg__measureRasterizer(image, scale, &lim)) return NULL;
+
+	r = (NSVGrasterizer*)nsvgArenaAlloc(arena, sizeof(NSVGrasterizer));
+	if (r == NULL) return NULL;
+	memset(r, 0, sizeof(NSVGrasterizer));
+
+	r->tessTol = 0.25f;
+	r->distTol = 0.01f;
+	r->arena = arena;
+
+	r->edges = (NSVGedge*)nsvg__resizeBuffer(r, NULL, &r->cedges, lim.edges, sizeof(NSVGedge));
+	r->points = (NSVGpoint*)nsvg__resizeBuffer(r, NULL, &r->cpoints, lim.points, sizeof(NSVGpoint));
+	r->points2 = (NSVGpoint*)nsvg__resizeBuffer(r, NULL, &r->cpoints2, lim.points2, sizeof(NSVGpoint));
+	r->scanline = (unsigned char*)nsvg__resizeBuffer(r, NULL, &r->cscanline, w, 1);
+#ifdef NSVG_FAST_EDGES
+	r->order = (int*)nsvg__resizeBuffer(r, NULL, &r->corder, lim.order, sizeof(int));
+	r->buckets = (int*)nsvg__resizeBuffer(r, NULL, &r->cbuckets, lim.buckets, sizeof(int));
+	if (lim.active > 0)
+		nsvg__growActive(r, 0, lim.active);
+#else
+	{
+		const int perPage = NSVG__MEMPAGE_SIZE / (int)sizeof(NSVGactiveEdge);
+		NSVGmemPage* p = NULL;
+		int i;
+		for (i = 0; i < (lim.active + perPage - 1) / perPage && !r->nomem; i++)
+			p = nsvg__nextPage(r, p);
+	}
+#endif
+	if (r->nomem) return NULL;
+	return r;
+}
+
 void nsvgRasterize(NSVGrasterizer* r,
 				   NSVGimage* image, float tx, float ty, float scale,
 				   unsigned char* dst, int w, int h, int stride)
+{
+	nsvgRasterizeRegion(r, image, tx, ty, scale, dst, 0, 0, w, h, stride, NSVG_PIXEL_RGBA32, 0);
+}
+
+int nsvgRasterizeRegion(NSVGrasterizer* r,
+				   NSVGimage* image, float tx, float ty, float scale,
+				   unsigned char* dst, int x, int y, int w, int h, int stride, int format, int flags)
 {
 	NSVGshape *shape = NULL;
-	NSVGedge *e = NULL;
+	const NSVGshapeEdges *edges = NULL;
 	NSVGcachedPaint cache;
 	int i;
 
@@ -1380,80 +2180,108 @@ void nsvgRasterize(NSVGrasterizer* r,
 	r->width = w;
 	r->height = h;
 	r->stride = stride;
+	r->format = format;
+	r->ox = x;
+	r->oy = y;
 
+	r->nomem = 0;
 	if (w > r->cscanline) {
-		r->cscanline = w;
-		r->scanline = (unsigned char*)realloc(r->scanline, w);
-		if (r->scanline == NULL) return;
+		unsigned char* mem = (unsigned char*)nsvg__resizeBuffer(r, r->scanline, &r->cscanline, w, 1);
+		if (mem == NULL) return 0;
+		r->scanline = mem;
 	}
 
-	for (i = 0; i < h; i++)
-		memset(&dst[i*stride], 0, w*4);
+	if (!(flags & NSVG_RASTER_COMPOSE)) {
+		for (i = 0; i < h; i++)
+			memset(&dst[i*stride], 0, w * ((format == NSVG_PIXEL_RGB565) ? 2 : 4));
+	}
 
 	for (shape = image->shapes; shape != NULL; shape = shape->next) {
 		if (!(shape->flags & NSVG_FLAGS_VISIBLE))
 			continue;
 
+		edges = nsvg__findShapeEdges(r, shape);
+		if (edges != NULL) {
+			// use pre-flattened edges
+			if (nsvg__isEdgeBoundsClipped(edges->bounds, x, y, w, h))
+				continue;
+			if (shape->fill.type != NSVG_PAINT_NONE) {
+				nsvg__resetPool(r);
+				r->freelist = NULL;
+				nsvg__initPaint(&cache, &shape->fill, shape->opacity);
+				NSVG_PROFILE(NSVG_PROFILE_FILL, nsvg__rasterizeSortedEdges(r, edges->edges, edges->nfill, tx,ty,scale, &cache, shape->fillRule));
+			}
+			if (shape->stroke.type != NSVG_PAINT_NONE && edges->nstroke > 0) {
+				nsvg__resetPool(r);
+				r->freelist = NULL;
+				nsvg__initPaint(&cache, &shape->stroke, shape->opacity);
+				NSVG_PROFILE(NSVG_PROFILE_FILL, nsvg__rasterizeSortedEdges(r, edges->edges + edges->nfill, edges->nstroke, tx,ty,scale, &cache, NSVG_FILLRULE_NONZERO));
+			}
+			continue;
+		}
+
+		if (nsvg__isShapeClipped(shape, tx, ty, scale, x, y, w, h))
+			continue;
+
 		if (shape->fill.type != NSVG_PAINT_NONE) {
 			nsvg__resetPool(r);
 			r->freelist = NULL;
 			r->nedges = 0;
 
-			nsvg__flattenShape(r, shape, scale);
+			NSVG_PROFILE(NSVG_PROFILE_FLATTEN, nsvg__flattenShape(r, shape, scale));
 
 			// Scale and translate edges
-			for (i = 0; i < r->nedges; i++) {
-				e = &r->edges[i];
-				e->x0 = tx + e->x0;
-				e->y0 = (ty + e->y0) * NSVG__SUBSAMPLES;
-				e->x1 = tx + e->x1;
-				e->y1 = (ty + e->y1) * NSVG__SUBSAMPLES;
-			}
+			nsvg__translateEdges(r->edges, r->nedges, tx, ty);
 
 			// Rasterize edges
 			if (r->nedges != 0)
-				qsort(r->edges, r->nedges, sizeof(NSVGedge), nsvg__cmpEdge);
+				NSVG_PROFILE(NSVG_PROFILE_SORT, nsvg__sortEdges(r, r->edges, r->nedges));
 
 			// now, traverse the scanlines and find the intersections on each scanline, use non-zero rule
 			nsvg__initPaint(&cache, &shape->fill, shape->opacity);
 
-			nsvg__rasterizeSortedEdges(r, tx,ty,scale, &cache, shape->fillRule);
+			// incomplete edges after an allocation failure are not rasterized
+			if (!r->nomem)
+				NSVG_PROFILE(NSVG_PROFILE_FILL, nsvg__rasterizeSortedEdges(r, r->edges, r->nedges, tx,ty,scale, &cache, shape->fillRule));
 		}
 		if (shape->stroke.type != NSVG_PAINT_NONE && (shape->strokeWidth * scale) > 0.01f) {
 			nsvg__resetPool(r);
 			r->freelist = NULL;
 			r->nedges = 0;
 
-			nsvg__flattenShapeStroke(r, shape, scale);
+			NSVG_PROFILE(NSVG_PROFILE_FLATTEN, nsvg__flattenShapeStroke(r, shape, scale));
 
 //			dumpEdges(r, "edge.svg");
 
 			// Scale and translate edges
-			for (i = 0; i < r->nedges; i++) {
-				e = &r->edges[i];
-				e->x0 = tx + e->x0;
-				e->y0 = (ty + e->y0) * NSVG__SUBSAMPLES;
-				e->x1 = tx + e->x1;
-				e->y1 = (ty + e->y1) * NSVG__SUBSAMPLES;
-			}
+			nsvg__translateEdges(r->edges, r->nedges, tx, ty);
 
 			// Rasterize edges
 			if (r->nedges != 0)
-				qsort(r->edges, r->nedges, sizeof(NSVGedge), nsvg__cmpEdge);
+				NSVG_PROFILE(NSVG_PROFILE_SORT, nsvg__sortEdges(r, r->edges, r->nedges));
 
 			// now, traverse the scanlines and find the intersections on each scanline, use non-zero rule
 			nsvg__initPaint(&cache, &shape->stroke, shape->opacity);
 
-			nsvg__rasterizeSortedEdges(r, tx,ty,scale, &cache, NSVG_FILLRULE_NONZERO);
+			// incomplete edges after an allocation failure are not rasterized
+			if (!r->nomem)
+				NSVG_PROFILE(NSVG_PROFILE_FILL, nsvg__rasterizeSortedEdges(r, r->edges, r->nedges, tx,ty,scale, &cache, NSVG_FILLRULE_NONZERO));
 		}
 	}
 
-	nsvg__unpremultiplyAlpha(dst, w, h, stride);
+	// opaque destination content stays opaque and needs no unpremultiplication
+	if (format == NSVG_PIXEL_RGBA32 && !(flags & NSVG_RASTER_COMPOSE))
+		nsvg__unpremultiplyAlpha(dst, w, h, stride);
 
 	r->bitmap = NULL;
 	r->width = 0;
 	r->height = 0;
 	r->stride = 0;
+	r->format = 0;
+	r->ox = 0;
+	r->oy = 0;
+
+	return !r->nomem;
 }
 
 #endif // NANOSVGRAST_IMPLEMENTATION
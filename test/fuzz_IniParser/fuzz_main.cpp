@@ -0,0 +1,368 @@
+/**
+ * @file fuzz_main.cpp
+ * @author Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Copyright (c) 2026 Daniel Starke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Fuzz harness for `IniParser::parse()`. Build with libFuzzer:
+ * @code
+ * clang++ -std=c++14 -g -O1 -fsanitize=fuzzer,address,undefined -Isrc test/fuzz_IniParser/fuzz_main.cpp -o fuzz_IniParser
+ * @endcode
+ * Define `FUZZ_MAIN` to build a stand-alone executable for AFL or to reproduce
+ * a crash with any compiler.
+ *
+ * The first input byte selects the maximum group/key length, the second one
+ * the chunk size. The remaining bytes are parsed character wise, as block,
+ * in chunks and through a chunk data provider. All variants need to yield the
+ * same result and the same sequence of mapping function calls, also when
+ * reusing a parser after `reset()`. Any difference aborts.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "IniParser.hpp"
+
+
+/** Result of a single parsing run. */
+struct FuzzTrace {
+	const uint8_t * data; /**< Parsed input. */
+	size_t size; /**< Number of bytes in `data`. */
+	size_t maxId; /**< Maximum number of characters for group and key strings including null-terminator. */
+	char shortStr[4]; /**< Short string value to hit the length limit. */
+	char str[32]; /**< String value. */
+	uint32_t u32; /**< Unsigned number value. */
+	int32_t i32; /**< Signed number value. */
+	int type; /**< Value type of the current key. */
+	size_t calls; /**< Number of mapping function calls. */
+	uint32_t hash; /**< Hash over all mapping function calls. */
+};
+
+
+/**
+ * Aborts if the given condition is not met.
+ *
+ * @param[in] cond - condition to check
+ * @param[in] msg - message to output on failure
+ */
+static inline void check(const bool cond, const char * msg) {
+	if ( ! cond ) {
+		fprintf(stderr, "fuzz_IniParser: %s\n", msg);
+		abort();
+	}
+}
+
+
+/**
+ * Returns whether the given string is part of the parsed input.
+ *
+ * @param[in] trace - parsing run
+ * @param[in] str - group or key string
+ * @return true if found, else false
+ */
+static bool isInput(const FuzzTrace & trace, const char * str) {
+	const size_t len = strlen(str);
+	if (len > trace.size) {
+		return false;
+	}
+	for (size_t i = 0; (i + len) <= trace.size; i++) {
+		if (memcmp(trace.data + i, str, len) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/**
+ * Combines the given value with the trace hash.
+ *
+ * @param[in,out] trace - parsing run
+ * @param[in] value - value to add
+ */
+static inline void addHash(FuzzTrace & trace, const uint32_t value) {
+	trace.hash = (trace.hash ^ value) * 16777619UL;
+}
+
+
+/**
+ * Mapping function for arbitrary input. The value type is derived from the key
+ * hash to cover all types. Values with the key `fail` or the string value `bad`
+ * are rejected to cover the error paths of the parser.
+ */
+class FuzzMapping {
+private:
+	FuzzTrace * trace;
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param[out] t - parsing run
+	 */
+	explicit inline FuzzMapping(FuzzTrace & t) noexcept:
+		trace(&t)
+	{}
+
+	/**
+	 * Maps the current key and records its value once parsed.
+	 *
+	 * @param[in,out] ctx - parsing context
+	 * @param[in] parsed - true if the value has been parsed, false if it needs to be mapped
+	 * @return true on success, else false
+	 */
+	bool operator() (IniParser::Context & ctx, const bool parsed) {
+		FuzzTrace & t = *(this->trace);
+		const char * group = ctx.group;
+		const char * key = ctx.key;
+		check(strlen(group) < t.maxId, "group exceeds limit");
+		check(strlen(key) < t.maxId && key[0] != 0, "key exceeds limit or is empty");
+		check(isInput(t, group), "group is not part of the input");
+		check(isInput(t, key), "key is not part of the input");
+		t.calls++;
+		addHash(t, IniParser::hashKey(group, key));
+		if ( ! parsed ) {
+			t.type = int(IniParser::hashString(key) % 7);
+			addHash(t, uint32_t(t.type));
+			switch (t.type) {
+			case 0: ctx.mapString(t.shortStr); break;
+			case 1: ctx.mapString(t.str); break;
+			case 2: ctx.mapNumber(t.u32, 10, 100000); break;
+			case 3: ctx.mapNumber(t.i32, -1000, 1000); break;
+			case 4: ctx.mapHexNumber(t.u32); break;
+			case 5: ctx.mapHexNumber(t.i32); break;
+			default: break; /* ignore value */
+			}
+			return strcmp(key, "fail") != 0;
+		}
+		switch (t.type) {
+		case 0:
+			check(strlen(t.shortStr) < sizeof(t.shortStr), "short string exceeds limit");
+			addHash(t, IniParser::hashString(t.shortStr));
+			return true;
+		case 1:
+			check(strlen(t.str) < sizeof(t.str), "string exceeds limit");
+			addHash(t, IniParser::hashString(t.str));
+			return strcmp(t.str, "bad") != 0;
+		case 2:
+			check(t.u32 >= 10 && t.u32 <= 100000, "number out of range");
+			addHash(t, t.u32);
+			return true;
+		case 3:
+			check(t.i32 >= -1000 && t.i32 <= 1000, "number out of range");
+			addHash(t, uint32_t(t.i32));
+			return true;
+		case 4:
+			addHash(t, t.u32);
+			return true;
+		case 5:
+			addHash(t, uint32_t(t.i32));
+			return true;
+		default:
+			check(false, "unexpected verification of an ignored value");
+			return false;
+		}
+	}
+};
+
+
+/**
+ * Provides the input in chunks of a fixed size.
+ */
+class FuzzChunks {
+private:
+	const uint8_t * ptr;
+	const uint8_t * end;
+	size_t chunkSize;
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param[in] data - input data
+	 * @param[in] size - number of bytes in `data`
+	 * @param[in] maxChunk - maximum number of bytes to return at once
+	 */
+	explicit inline FuzzChunks(const uint8_t * data, const size_t size, const size_t maxChunk):
+		ptr(data),
+		end(data + size),
+		chunkSize(maxChunk)
+	{}
+
+	/**
+	 * Function operator which provides the next chunk of data.
+	 *
+	 * @param[out] buf - buffer to write to
+	 * @param[in] size - size of `buf` in bytes
+	 * @return number of bytes written or 0 on end of input
+	 */
+	size_t operator() (char * buf, const size_t size) {
+		size_t len = size_t(this->end - this->ptr);
+		if (len > size) {
+			len = size;
+		}
+		if (len > this->chunkSize) {
+			len = this->chunkSize;
+		}
+		memcpy(buf, this->ptr, len);
+		this->ptr += len;
+		return len;
+	}
+};
+
+
+/**
+ * Initializes a parsing run.
+ *
+ * @param[out] trace - parsing run
+ * @param[in] data - input data
+ * @param[in] size - number of bytes in `data`
+ * @param[in] maxId - maximum number of characters for group and key strings including null-terminator
+ */
+static void initTrace(FuzzTrace & trace, const uint8_t * data, const size_t size, const size_t maxId) {
+	memset(&trace, 0, sizeof(trace));
+	trace.data = data;
+	trace.size = size;
+	trace.maxId = maxId;
+	trace.hash = 2166136261UL;
+}
+
+
+/**
+ * Checks that both parsing runs yield the same result.
+ *
+ * @param[in] a - first parsing run
+ * @param[in] resA - result of the first parsing run
+ * @param[in] b - second parsing run
+ * @param[in] resB - result of the second parsing run
+ * @param[in] msg - message to output on failure
+ */
+static void checkEqual(const FuzzTrace & a, const size_t resA, const FuzzTrace & b, const size_t resB, const char * msg) {
+	check(resA == resB && a.calls == b.calls && a.hash == b.hash, msg);
+}
+
+
+/**
+ * Parses the given input with all variants and checks that they yield the same result.
+ *
+ * @param[in] data - input data
+ * @param[in] size - number of bytes in `data`
+ * @param[in] chunkSize - maximum number of bytes per chunk
+ * @tparam MaxId - maximum number of characters for group and key strings including null-terminator
+ */
+template <size_t MaxId>
+static void fuzzParse(const uint8_t * data, const size_t size, const size_t chunkSize) {
+	FuzzTrace traceChar, traceBlock, traceChunks, traceFn;
+	size_t resChar = 0, resChunks = 0;
+	/* character wise */
+	initTrace(traceChar, data, size, MaxId);
+	{
+		IniParserSized<MaxId, sizeof(FuzzMapping)> ini{FuzzMapping(traceChar)};
+		for (size_t i = 0; i < size; i++) {
+			if ( ! ini.parse(int(data[i])) ) {
+				resChar = ini.getLine();
+				check(ini.getLine() >= 1 && ! ini, "invalid error state");
+				check( ! ini.parse(int(data[i])), "parser recovered from error state");
+				break;
+			}
+		}
+		if (resChar == 0 && ( ! ini.parse(-1) )) {
+			resChar = ini.getLine();
+		}
+	}
+	/* as block */
+	initTrace(traceBlock, data, size, MaxId);
+	const size_t resBlock = iniParseBlock<MaxId>(reinterpret_cast<const char *>(data), size, FuzzMapping(traceBlock));
+	checkEqual(traceChar, resChar, traceBlock, resBlock, "block parsing differs from character wise parsing");
+	/* in chunks, reusing the same parser after reset */
+	{
+		IniParserSized<MaxId, sizeof(FuzzMapping)> ini{FuzzMapping(traceChunks)};
+		for (int run = 0; run < 2; run++) {
+			initTrace(traceChunks, data, size, MaxId);
+			ini.reset();
+			resChunks = ini.parseChunks(FuzzChunks(data, size, chunkSize));
+			checkEqual(traceChar, resChar, traceChunks, resChunks, "chunk parsing differs from character wise parsing");
+		}
+	}
+	/* chunk data provider function */
+	initTrace(traceFn, data, size, MaxId);
+	const size_t resFn = iniParseFn<MaxId>(FuzzChunks(data, size, chunkSize), FuzzMapping(traceFn));
+	checkEqual(traceChar, resChar, traceFn, resFn, "data provider parsing differs from character wise parsing");
+}
+
+
+/**
+ * libFuzzer entry point.
+ *
+ * @param[in] data - fuzzer generated input
+ * @param[in] size - number of bytes in `data`
+ * @return always 0
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t * data, size_t size) {
+	if (size < 2) {
+		return 0;
+	}
+	const uint8_t maxIdSel = data[0];
+	const size_t chunkSize = size_t(1 + (data[1] % INI_PARSER_CHUNK_SIZE));
+	data += 2;
+	size -= 2;
+	switch (maxIdSel % 8) {
+	case 0: fuzzParse<1>(data, size, chunkSize); break;
+	case 1: fuzzParse<2>(data, size, chunkSize); break;
+	case 2: fuzzParse<3>(data, size, chunkSize); break;
+	case 3: fuzzParse<4>(data, size, chunkSize); break;
+	case 4: fuzzParse<5>(data, size, chunkSize); break;
+	case 5: fuzzParse<8>(data, size, chunkSize); break;
+	case 6: fuzzParse<13>(data, size, chunkSize); break;
+	default: fuzzParse<16>(data, size, chunkSize); break;
+	}
+	return 0;
+}
+
+
+#ifdef FUZZ_MAIN
+/**
+ * Stand-alone entry point. Each argument is passed as input file to the
+ * fuzz target. The standard input is used if no argument was given.
+ *
+ * @param[in] argc - number of arguments
+ * @param[in] argv - arguments
+ * @return 0 on success, else 1
+ */
+int main(int argc, char ** argv) {
+	static uint8_t buf[1 << 20];
+	for (int i = (argc > 1) ? 1 : 0; i < argc; i++) {
+		FILE * fin = (argc > 1) ? fopen(argv[i], "rb") : stdin;
+		if (fin == NULL) {
+			fprintf(stderr, "Error: Failed to open '%s'.\n", argv[i]);
+			return 1;
+		}
+		const size_t size = fread(buf, 1, sizeof(buf), fin);
+		if (fin != stdin) {
+			fclose(fin);
+		}
+		LLVMFuzzerTestOneInput(buf, size);
+	}
+	return 0;
+}
+#endif /* FUZZ_MAIN */
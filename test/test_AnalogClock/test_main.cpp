@@ -0,0 +1,657 @@
+/**
+ * @file test_main.cpp
+ * @author Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Copyright (c) 2026 Daniel Starke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <unity.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/** Number of allocations since the last `allocReset()`. */
+static size_t allocCount = 0;
+/** Number of currently allocated bytes. */
+static size_t allocBytes = 0;
+/** Maximum of `allocBytes` since the last `allocReset()`. */
+static size_t allocPeak = 0;
+/** Time spent within each rasterizer stage in nanoseconds (see `NSVGprofileStage`). */
+static int64_t stageNs[4];
+
+
+/**
+ * Resets the allocation statistics.
+ */
+static void allocReset() {
+	allocCount = 0;
+	allocPeak = allocBytes;
+}
+
+
+/**
+ * Allocates memory and records the allocation statistics.
+ * The allocation size is stored in front of the returned block.
+ *
+ * @param[in] size - number of bytes to allocate
+ * @return allocated memory or `NULL`
+ */
+static void * countMalloc(size_t size) {
+	size_t * ptr = static_cast<size_t *>(std::malloc(size + 16));
+	if (ptr == NULL) {
+		return NULL;
+	}
+	*ptr = size;
+	allocCount++;
+	allocBytes += size;
+	if (allocBytes > allocPeak) {
+		allocPeak = allocBytes;
+	}
+	return reinterpret_cast<char *>(ptr) + 16;
+}
+
+
+/**
+ * Frees memory allocated via `countMalloc()`.
+ *
+ * @param[in] mem - memory to free or `NULL`
+ */
+static void countFree(void * mem) {
+	if (mem == NULL) {
+		return;
+	}
+	size_t * ptr = reinterpret_cast<size_t *>(static_cast<char *>(mem) - 16);
+	allocBytes -= *ptr;
+	std::free(ptr);
+}
+
+
+/**
+ * Reallocates memory allocated via `countMalloc()`.
+ *
+ * @param[in] mem - memory to reallocate or `NULL`
+ * @param[in] size - new number of bytes
+ * @return reallocated memory or `NULL`
+ */
+static void * countRealloc(void * mem, size_t size) {
+	void * res = countMalloc(size);
+	if (res != NULL && mem != NULL) {
+		const size_t oldSize = *reinterpret_cast<size_t *>(static_cast<char *>(mem) - 16);
+		memcpy(res, mem, (oldSize < size) ? oldSize : size);
+		countFree(mem);
+	}
+	return res;
+}
+
+
+/* route all renderer allocations through the counting functions */
+#define malloc(size) countMalloc(size)
+#define realloc(mem, size) countRealloc(mem, size)
+#define free(mem) countFree(mem)
+#ifndef SVG_NO_FAST_EDGES
+#define NSVG_FAST_EDGES /* same as the firmware */
+#endif /* SVG_NO_FAST_EDGES */
+#ifndef SVG_NO_PACKED_PIXELS
+#define NSVG_PACKED_PIXELS /* same as the firmware */
+#endif /* SVG_NO_PACKED_PIXELS */
+#define NSVG_PROFILE(stage, statement) do { \
+		const auto profileStart = std::chrono::steady_clock::now(); \
+		statement; \
+		stageNs[stage] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profileStart).count(); \
+	} while (0)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wshadow"
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wimplicit-fallthrough"
+extern "C" {
+#define NANOSVG_IMPLEMENTATION
+#include "nanosvg.h"
+#define NANOSVGRAST_IMPLEMENTATION
+#include "nanosvgrast.h"
+} /* C */
+#pragma GCC diagnostic pop
+#include "AnalogClock.hpp"
+#undef malloc
+#undef realloc
+#undef free
+#include "SvgData.hpp"
+#include "SvgImage.hpp" /* generated by build-pre-svg.py */
+
+
+/**
+ * Output sink which composes the rendered bands into a frame buffer.
+ * Uses the same band size as the device in strip mode.
+ */
+struct FrameSink {
+	enum {
+		LINES = 16 /**< Lines per band buffer (see `SVG_STRIP_LINES`). */
+	};
+	uint16_t band[2][AnalogClock::WIDTH * LINES]; /**< Band buffers. */
+	uint16_t frame[AnalogClock::WIDTH * AnalogClock::HEIGHT]; /**< Composed frame buffer in RGB565. */
+	size_t pixels; /**< Number of pixels pushed. */
+
+	FrameSink():
+		pixels(0)
+	{
+		memset(this->frame, 0, sizeof(this->frame));
+	}
+
+	inline size_t capacity() const {
+		return size_t(AnalogClock::WIDTH * LINES);
+	}
+
+	inline uint16_t * buffer(const size_t i) {
+		return this->band[i];
+	}
+
+	inline void begin() {
+	}
+
+	inline void push(const int x, const int y, const int w, const int h, uint16_t * buf) {
+		for (int i = 0; i < h; i++) {
+			memcpy(this->frame + ((y + i) * AnalogClock::WIDTH) + x, buf + (i * w), size_t(w) * sizeof(uint16_t));
+		}
+		this->pixels += size_t(w * h);
+	}
+
+	inline void end() {
+	}
+
+	/**
+	 * Returns the FNV-1a hash of the frame buffer.
+	 *
+	 * @return 32-bit hash
+	 */
+	uint32_t hash() const {
+		uint32_t res = 2166136261UL;
+		for (const uint16_t pixel : this->frame) {
+			res = (res ^ (pixel & 0xFF)) * 16777619UL;
+			res = (res ^ (pixel >> 8)) * 16777619UL;
+		}
+		return res;
+	}
+
+	/**
+	 * Returns the largest difference of a single color channel between both frames.
+	 * Red and blue are compared in 5-bit and green in 6-bit resolution.
+	 *
+	 * @param[in] o - frame to compare with
+	 * @return maximum channel difference
+	 */
+	int maxDiff(const FrameSink & o) const {
+		int res = 0;
+		for (size_t i = 0; i < (AnalogClock::WIDTH * AnalogClock::HEIGHT); i++) {
+			const int a = this->frame[i], b = o.frame[i];
+			const int d[3] = {abs((a >> 11) - (b >> 11)), abs(((a >> 5) & 0x3F) - ((b >> 5) & 0x3F)), abs((a & 0x1F) - (b & 0x1F))};
+			for (const int v : d) {
+				if (v > res) {
+					res = v;
+				}
+			}
+		}
+		return res;
+	}
+};
+
+
+/** Clock face color used for all tests in RGB565. */
+static const uint16_t testColor = 0x07E0;
+
+
+/**
+ * Allocator passed to `AnalogClock::begin()`.
+ *
+ * @param[in] size - number of bytes to allocate
+ * @return allocated memory or `NULL`
+ */
+static void * testAlloc(size_t size) {
+	return countMalloc(size);
+}
+
+
+/**
+ * Allocator passed to `AnalogClock::begin()` which always fails.
+ *
+ * @param[in] size - number of bytes to allocate
+ * @return always `NULL`
+ */
+static void * failAlloc(size_t size) {
+	(void)size;
+	return NULL;
+}
+
+
+void setUp(void) {
+	/* test setup */
+}
+
+
+void tearDown(void) {
+	/* test clean-up */
+}
+
+
+void test_begin() {
+	{
+		AnalogClock clock;
+		TEST_ASSERT_TRUE(clock.begin(svgData));
+		TEST_ASSERT_TRUE(clock.error() == NULL);
+		TEST_ASSERT_FALSE(clock.hasBackground());
+	}
+	{
+		AnalogClock clock;
+		TEST_ASSERT_TRUE(clock.begin(svgData, testAlloc, testAlloc));
+		TEST_ASSERT_TRUE(clock.hasBackground());
+	}
+	{
+		AnalogClock clock;
+		TEST_ASSERT_FALSE(clock.begin("<svg width=\"320\" height=\"240\"></svg>"));
+		TEST_ASSERT_TRUE(clock.error() != NULL);
+	}
+	{
+		AnalogClock clock;
+		TEST_ASSERT_TRUE(clock.begin(svgImage));
+		TEST_ASSERT_TRUE(clock.error() == NULL);
+		TEST_ASSERT_TRUE(clock.arenaSize() > 0);
+	}
+	{
+		AnalogClock clock;
+		TEST_ASSERT_FALSE(clock.begin(svgImage, NULL, NULL, failAlloc));
+		TEST_ASSERT_TRUE(clock.error() != NULL);
+	}
+	{
+		AnalogClock clock;
+		TEST_ASSERT_FALSE(clock.begin(svgData, NULL, NULL, failAlloc));
+		TEST_ASSERT_TRUE(clock.error() != NULL);
+		TEST_ASSERT_EQUAL_size_t(0, clock.arenaSize());
+	}
+	TEST_ASSERT_EQUAL_size_t(0, allocBytes); /* no leaks */
+}
+
+
+void test_golden() {
+	/* golden images as FNV-1a hash of the RGB565 frame buffer rendered without any cache */
+	static const struct {
+		int minute;
+		int32_t secPos;
+		uint32_t hash;
+	} golden[] = {
+		{   0,    -1, 0xDE9B2F13UL}, /* 00:00 */
+		{ 190,    -1, 0xD250D6C4UL}, /* 03:10 */
+		{ 610,    -1, 0xDB780DE0UL}, /* 10:10 */
+		{1439, 45500, 0xBA0F0A3DUL}  /* 23:59:45.5 */
+	};
+	AnalogClock clock, compiled;
+	TEST_ASSERT_TRUE(clock.begin(svgData));
+	TEST_ASSERT_TRUE(compiled.begin(svgImage));
+	FrameSink * sink = new FrameSink();
+	for (const auto & frame : golden) {
+		char msg[64];
+		clock.draw(*sink, frame.minute, frame.secPos, testColor, true);
+		snprintf(msg, sizeof(msg), "minute %i: got 0x%08lX", frame.minute, static_cast<unsigned long>(sink->hash()));
+		TEST_ASSERT_EQUAL_UINT32_MESSAGE(frame.hash, sink->hash(), msg);
+		/* the pre-parsed image needs to give the same result */
+		compiled.draw(*sink, frame.minute, frame.secPos, testColor, true);
+		snprintf(msg, sizeof(msg), "compiled minute %i: got 0x%08lX", frame.minute, static_cast<unsigned long>(sink->hash()));
+		TEST_ASSERT_EQUAL_UINT32_MESSAGE(frame.hash, sink->hash(), msg);
+	}
+	delete sink;
+}
+
+
+void test_compiled() {
+	/* the generated image needs to equal the parsed one except for rounding within the arc approximations */
+	char * str = static_cast<char *>(std::malloc(strlen(svgData) + 1));
+	memcpy(str, svgData, strlen(svgData) + 1);
+	NSVGimage * img = nsvgParse(str, "px", 96);
+	std::free(str);
+	TEST_ASSERT_TRUE(img != NULL);
+	TEST_ASSERT_TRUE(svgImage.width == img->width && svgImage.height == img->height);
+	const NSVGshape * a = img->shapes;
+	const NSVGshape * b = svgImage.shapes;
+	float maxDiff = 0.0f;
+	for (; a != NULL && b != NULL; a = a->next, b = b->next) {
+		TEST_ASSERT_EQUAL_STRING(a->id, b->id);
+		TEST_ASSERT_EQUAL_INT(a->fill.type, b->fill.type);
+		TEST_ASSERT_EQUAL_UINT32(a->fill.color, b->fill.color);
+		TEST_ASSERT_EQUAL_INT(a->stroke.type, b->stroke.type);
+		TEST_ASSERT_EQUAL_UINT32(a->stroke.color, b->stroke.color);
+		TEST_ASSERT_TRUE(a->strokeWidth == b->strokeWidth);
+		TEST_ASSERT_EQUAL_INT(a->flags, b->flags);
+		for (size_t i = 0; i < 4; i++) {
+			maxDiff = fmaxf(maxDiff, fabsf(a->bounds[i] - b->bounds[i]));
+		}
+		const NSVGpath * p = a->paths;
+		const NSVGpath * q = b->paths;
+		for (; p != NULL && q != NULL; p = p->next, q = q->next) {
+			TEST_ASSERT_EQUAL_INT(p->npts, q->npts);
+			TEST_ASSERT_EQUAL_INT(p->closed, q->closed);
+			if (p->npts != q->npts) {
+				break;
+			}
+			for (int i = 0; i < (p->npts * 2); i++) {
+				maxDiff = fmaxf(maxDiff, fabsf(p->pts[i] - q->pts[i]));
+			}
+		}
+		TEST_ASSERT_TRUE(p == NULL && q == NULL);
+	}
+	TEST_ASSERT_TRUE(a == NULL && b == NULL);
+	TEST_ASSERT_TRUE(maxDiff < 0.001f);
+	nsvgDelete(img);
+}
+
+
+void test_incremental() {
+	/* drawing only the moved clock hands needs to give the same result as a full redraw */
+	AnalogClock clock, ref;
+	TEST_ASSERT_TRUE(clock.begin(svgData, testAlloc, testAlloc));
+	TEST_ASSERT_TRUE(ref.begin(svgData, testAlloc));
+	FrameSink * sink = new FrameSink();
+	FrameSink * refSink = new FrameSink();
+	size_t mismatches = 0;
+	for (int minute = 0; minute < (24 * 60); minute++) {
+		const int32_t secPos = int32_t((minute % 60) * 1000); /* also move the seconds clock hand */
+		clock.draw(*sink, minute, secPos, testColor, minute == 0);
+		ref.draw(*refSink, minute, secPos, testColor, true);
+		if (memcmp(sink->frame, refSink->frame, sizeof(sink->frame)) != 0) {
+			if (mismatches == 0) {
+				printf("first mismatch at minute %i\n", minute);
+			}
+			mismatches++;
+		}
+	}
+	TEST_ASSERT_EQUAL_size_t(0, mismatches);
+	/* hiding the seconds clock hand needs to restore the area below */
+	clock.draw(*sink, 0, -1, testColor, false);
+	ref.draw(*refSink, 0, -1, testColor, true);
+	TEST_ASSERT_EQUAL_MEMORY(refSink->frame, sink->frame, sizeof(sink->frame));
+	delete refSink;
+	delete sink;
+}
+
+
+void test_background() {
+	/* composing over the cached RGB565 background differs only by rounding */
+	AnalogClock clock, ref;
+	TEST_ASSERT_TRUE(clock.begin(svgData, testAlloc));
+	TEST_ASSERT_TRUE(ref.begin(svgData));
+	FrameSink * sink = new FrameSink();
+	FrameSink * refSink = new FrameSink();
+	for (int minute = 0; minute < (24 * 60); minute += 37) {
+		clock.draw(*sink, minute, 30000, testColor, true);
+		ref.draw(*refSink, minute, 30000, testColor, true);
+		TEST_ASSERT_TRUE(sink->maxDiff(*refSink) <= 2);
+	}
+	delete refSink;
+	delete sink;
+}
+
+
+void test_center() {
+	/* clock hands rotate around the center of the clock face circle */
+	static const char * face = "<svg width=\"320\" height=\"240\">"
+		"<circle id=\"circle\" cx=\"80\" cy=\"100\" r=\"60\" fill=\"#fff\"/>"
+		"<path id=\"min\" fill=\"#f00\" d=\"M78 100V50h4v50z\"/>"
+		"<path id=\"hour\" fill=\"#00f\" d=\"M78 100V70h4v30z\"/>"
+		"<path id=\"sec\" fill=\"#0f0\" d=\"M79 100V45h2v55z\"/>"
+		"</svg>";
+	AnalogClock clock;
+	TEST_ASSERT_TRUE(clock.begin(face));
+	FrameSink * sink = new FrameSink();
+	TEST_ASSERT_TRUE(clock.draw(*sink, (6 * 60) + 15, -1, testColor, true));
+	/* minute hand points to 3 o'clock and hour hand to a quarter past 6 o'clock */
+	TEST_ASSERT_EQUAL_UINT32(0xF800, sink->frame[(100 * AnalogClock::WIDTH) + 125]);
+	TEST_ASSERT_EQUAL_UINT32(0x001F, sink->frame[(120 * AnalogClock::WIDTH) + 77]);
+	TEST_ASSERT_EQUAL_UINT32(testColor, sink->frame[(60 * AnalogClock::WIDTH) + 80]);
+	delete sink;
+	/* faces without clock face circle are rejected */
+	AnalogClock invalid;
+	TEST_ASSERT_FALSE(invalid.begin("<svg width=\"320\" height=\"240\">"
+		"<path id=\"min\" d=\"M78 100V50h4v50z\"/><path id=\"hour\" d=\"M78 100V70h4v30z\"/>"
+		"<path id=\"sec\" d=\"M79 100V45h2v55z\"/></svg>"));
+	TEST_ASSERT_TRUE(invalid.error() != NULL);
+}
+
+
+/**
+ * Renders all minutes of a day incrementally with a full redraw every 97 minutes.
+ *
+ * @param[in,out] clock - analog clock renderer
+ * @param[in,out] sink - output sink
+ * @return combined hash of all frames or 0 if drawing failed
+ */
+static uint32_t drawDay(AnalogClock & clock, FrameSink & sink) {
+	uint32_t res = 0;
+	for (int minute = 0; minute < (24 * 60); minute++) {
+		const int32_t secPos = int32_t((minute % 60) * 1000);
+		if ( ! clock.draw(sink, minute, secPos, testColor, (minute % 97) == 0) ) {
+			return 0;
+		}
+		res = (res * 31) ^ sink.hash();
+	}
+	return res;
+}
+
+
+void test_arena() {
+	/* rendering from the arena needs to give the same result without any further heap allocation */
+	AnalogClock clock, ref;
+	TEST_ASSERT_TRUE(clock.begin(svgData, testAlloc, NULL, testAlloc));
+	TEST_ASSERT_TRUE(ref.begin(svgData, testAlloc));
+	TEST_ASSERT_TRUE(clock.error() == NULL);
+	TEST_ASSERT_TRUE(clock.arenaSize() > 0);
+	TEST_ASSERT_TRUE(clock.arenaUsed() <= clock.arenaSize());
+	TEST_ASSERT_EQUAL_size_t(0, ref.arenaSize());
+	FrameSink * sink = new FrameSink();
+	allocReset();
+	const uint32_t hash = drawDay(clock, *sink);
+	TEST_ASSERT_EQUAL_size_t(0, allocCount);
+	TEST_ASSERT_TRUE(clock.arenaUsed() <= clock.arenaSize());
+	TEST_ASSERT_EQUAL_UINT32(drawDay(ref, *sink), hash);
+	/* the same applies to the pre-parsed image */
+	AnalogClock compiled;
+	TEST_ASSERT_TRUE(compiled.begin(svgImage, testAlloc, NULL, testAlloc));
+	TEST_ASSERT_TRUE(compiled.arenaUsed() <= compiled.arenaSize());
+	allocReset();
+	TEST_ASSERT_EQUAL_UINT32(hash, drawDay(compiled, *sink));
+	TEST_ASSERT_EQUAL_size_t(0, allocCount);
+	delete sink;
+}
+
+
+#ifdef NSVG_PACKED_PIXELS
+/**
+ * Blends the given color with the coverage scanline over the passed RGB565 pixels
+ * with the scalar reference implementation of NanoSVG.
+ *
+ * @param[in,out] dst - RGB565 pixels
+ * @param[in] count - number of pixels
+ * @param[in] cover - coverage scanline
+ * @param[in] color - non-premultiplied color in RGBA
+ */
+static void blendSpanScalar(uint16_t * dst, const int count, const unsigned char * cover, const unsigned int color) {
+	const int cr = int(color & 0xFF);
+	const int cg = int((color >> 8) & 0xFF);
+	const int cb = int((color >> 16) & 0xFF);
+	const int ca = int((color >> 24) & 0xFF);
+	for (int i = 0; i < count; i++) {
+		const int a = nsvg__div255(int(cover[i]) * ca);
+		nsvg__blendRGB565(reinterpret_cast<unsigned char *>(dst + i), nsvg__div255(cr * a), nsvg__div255(cg * a), nsvg__div255(cb * a), a);
+	}
+}
+
+
+void test_kernels() {
+	/* the packed pixel kernels need to give the same result as the scalar ones */
+	static const unsigned int colors[] = {0xFF00FF00, 0xFFFFFFFF, 0xFF3366CC, 0x80FF8040, 0x01010101};
+	unsigned char cover[256];
+	for (size_t i = 0; i < sizeof(cover); i++) {
+		cover[i] = static_cast<unsigned char>(i);
+	}
+	uint16_t packed[sizeof(cover)], scalar[sizeof(cover)];
+	for (const unsigned int color : colors) {
+		for (unsigned int px = 0; px < 0x10000; px += 7) {
+			for (size_t i = 0; i < sizeof(cover); i++) {
+				packed[i] = scalar[i] = static_cast<uint16_t>(px + (i * 13));
+			}
+			nsvg__blendSpanRGB565(packed, int(sizeof(cover)), cover, color);
+			blendSpanScalar(scalar, int(sizeof(cover)), cover, color);
+			if (memcmp(packed, scalar, sizeof(packed)) != 0) {
+				char msg[64];
+				snprintf(msg, sizeof(msg), "color 0x%08X, pixel 0x%04X", color, px);
+				TEST_ASSERT_EQUAL_MEMORY_MESSAGE(scalar, packed, sizeof(packed), msg);
+				return;
+			}
+		}
+	}
+	/* opaque runs for all alignments and lengths */
+	memset(cover, 255, sizeof(cover));
+	for (int offset = 0; offset < 2; offset++) {
+		for (int count = 0; count < 8; count++) {
+			for (size_t i = 0; i < sizeof(cover); i++) {
+				packed[i] = scalar[i] = 0x1234;
+			}
+			nsvg__blendSpanRGB565(packed + offset, count, cover, colors[2]);
+			blendSpanScalar(scalar + offset, count, cover, colors[2]);
+			TEST_ASSERT_EQUAL_MEMORY(scalar, packed, sizeof(packed));
+		}
+	}
+	/* time per span of a typical anti-aliased scanline */
+	for (size_t i = 0; i < sizeof(cover); i++) {
+		cover[i] = (i < 2 || i > 253) ? static_cast<unsigned char>(i * 85) : ((i % 64) < 48 ? 255 : 0);
+	}
+	const int spans = 20000;
+	int64_t ns[2];
+	for (int kernel = 0; kernel < 2; kernel++) {
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < spans; i++) {
+			if (kernel == 0) {
+				blendSpanScalar(scalar, int(sizeof(cover)), cover, colors[2]);
+			} else {
+				nsvg__blendSpanRGB565(packed, int(sizeof(cover)), cover, colors[2]);
+			}
+		}
+		ns[kernel] = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / spans;
+	}
+	TEST_ASSERT_EQUAL_MEMORY(scalar, packed, sizeof(packed));
+	printf("blend span of %zu px: %lli ns scalar, %lli ns packed\n", sizeof(cover), static_cast<long long>(ns[0]), static_cast<long long>(ns[1]));
+}
+#endif /* NSVG_PACKED_PIXELS */
+
+
+/**
+ * Renders all minutes of a day and prints the timing and memory statistics.
+ *
+ * @param[in] name - benchmark name
+ * @param[in] bgAlloc - background cache allocator or `NULL`
+ * @param[in] handAlloc - clock hand cache allocator or `NULL`
+ * @param[in] full - true for full redraws, false to redraw only the moved clock hands
+ * @param[in] arenaAlloc - arena allocator or `NULL`
+ * @param[in] compiled - true to use the pre-parsed image, false to parse the SVG image
+ */
+static void benchmark(const char * name, AnalogClock::Allocator bgAlloc, AnalogClock::Allocator handAlloc, const bool full, AnalogClock::Allocator arenaAlloc = NULL, const bool compiled = false) {
+	const size_t baseBytes = allocBytes;
+	allocReset();
+	AnalogClock clock;
+	const auto beginStart = std::chrono::steady_clock::now();
+	if ( compiled ) {
+		TEST_ASSERT_TRUE(clock.begin(svgImage, bgAlloc, handAlloc, arenaAlloc));
+	} else {
+		TEST_ASSERT_TRUE(clock.begin(svgData, bgAlloc, handAlloc, arenaAlloc));
+	}
+	const int64_t beginNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - beginStart).count();
+	FrameSink * sink = new FrameSink();
+	/* the first frame includes all one time initializations */
+	clock.draw(*sink, 0, -1, testColor, true);
+	const size_t initCount = allocCount;
+	const size_t initPeak = allocPeak - baseBytes;
+	allocReset();
+	memset(stageNs, 0, sizeof(stageNs));
+	sink->pixels = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (int minute = 1; minute <= (24 * 60); minute++) {
+		clock.draw(*sink, minute % (24 * 60), -1, testColor, full);
+	}
+	const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	const int64_t frames = 24 * 60;
+	printf(
+		"%-24s %6lli us begin, %9lli ns/frame (flatten %lli, sort %lli, fill %lli, blend %lli), %7zu px/frame, %4zu init allocs, %7zu B init peak, %5zu allocs, %7zu B peak\n",
+		name,
+		static_cast<long long>(beginNs / 1000),
+		static_cast<long long>(ns / frames),
+		static_cast<long long>(stageNs[NSVG_PROFILE_FLATTEN] / frames),
+		static_cast<long long>(stageNs[NSVG_PROFILE_SORT] / frames),
+		static_cast<long long>((stageNs[NSVG_PROFILE_FILL] - stageNs[NSVG_PROFILE_BLEND]) / frames),
+		static_cast<long long>(stageNs[NSVG_PROFILE_BLEND] / frames),
+		sink->pixels / size_t(frames),
+		initCount,
+		initPeak,
+		allocCount,
+		allocPeak - baseBytes
+	);
+	delete sink;
+}
+
+
+void test_benchmark() {
+	benchmark("full", NULL, NULL, true);
+	benchmark("full+background", testAlloc, NULL, true);
+	benchmark("dirty", NULL, NULL, false);
+	benchmark("dirty+background", testAlloc, NULL, false);
+	benchmark("dirty+background+hands", testAlloc, testAlloc, false);
+	benchmark("dirty+background+arena", testAlloc, NULL, false, testAlloc);
+	benchmark("dirty+background+compiled", testAlloc, NULL, false, testAlloc, true);
+	TEST_ASSERT_EQUAL_size_t(0, allocBytes); /* no leaks */
+}
+
+
+/**
+ * Main entry point for all unit tests.
+ */
+int main() {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_begin);
+	RUN_TEST(test_golden);
+	RUN_TEST(test_compiled);
+	RUN_TEST(test_incremental);
+	RUN_TEST(test_background);
+	RUN_TEST(test_center);
+	RUN_TEST(test_arena);
+#ifdef NSVG_PACKED_PIXELS
+	RUN_TEST(test_kernels);
+#endif /* NSVG_PACKED_PIXELS */
+	RUN_TEST(test_benchmark);
+
+	UNITY_END();
+	return 0;
+}
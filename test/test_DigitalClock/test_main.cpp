@@ -0,0 +1,294 @@
+/**
+ * @file test_main.cpp
+ * @author Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Copyright (c) 2026 Daniel Starke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <unity.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef SVG_NO_FAST_EDGES
+#define NSVG_FAST_EDGES /* same as the firmware */
+#endif /* SVG_NO_FAST_EDGES */
+#ifndef SVG_NO_PACKED_PIXELS
+#define NSVG_PACKED_PIXELS /* same as the firmware */
+#endif /* SVG_NO_PACKED_PIXELS */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wshadow"
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wimplicit-fallthrough"
+extern "C" {
+#define NANOSVG_IMPLEMENTATION
+#include "nanosvg.h"
+#define NANOSVGRAST_IMPLEMENTATION
+#include "nanosvgrast.h"
+} /* C */
+#pragma GCC diagnostic pop
+#include "DigitalClock.hpp"
+#include "SvgDigits.hpp" /* generated by build-pre-svg.py */
+
+
+/**
+ * Output sink which composes the rendered bands into a frame buffer.
+ * Uses the same band size as the device in strip mode.
+ */
+struct FrameSink {
+	enum {
+		LINES = 16 /**< Lines per band buffer (see `SVG_STRIP_LINES`). */
+	};
+	uint16_t band[2][DigitalClock::WIDTH * LINES]; /**< Band buffers. */
+	uint16_t frame[DigitalClock::WIDTH * DigitalClock::HEIGHT]; /**< Composed frame buffer in RGB565. */
+	size_t pixels; /**< Number of pixels pushed. */
+	size_t regions; /**< Number of regions pushed. */
+
+	FrameSink():
+		pixels(0),
+		regions(0)
+	{
+		memset(this->frame, 0, sizeof(this->frame));
+	}
+
+	inline size_t capacity() const {
+		return size_t(DigitalClock::WIDTH * LINES);
+	}
+
+	inline uint16_t * buffer(const size_t i) {
+		return this->band[i];
+	}
+
+	inline void begin() {
+		this->regions++;
+	}
+
+	inline void push(const int x, const int y, const int w, const int h, uint16_t * buf) {
+		for (int i = 0; i < h; i++) {
+			memcpy(this->frame + ((y + i) * DigitalClock::WIDTH) + x, buf + (i * w), size_t(w) * sizeof(uint16_t));
+		}
+		this->pixels += size_t(w * h);
+	}
+
+	inline void end() {
+	}
+
+	/**
+	 * Resets the push statistics.
+	 */
+	inline void reset() {
+		this->pixels = 0;
+		this->regions = 0;
+	}
+
+	/**
+	 * Returns the FNV-1a hash of the frame buffer.
+	 *
+	 * @return 32-bit hash
+	 */
+	uint32_t hash() const {
+		uint32_t res = 2166136261UL;
+		for (const uint16_t pixel : this->frame) {
+			res = (res ^ (pixel & 0xFF)) * 16777619UL;
+			res = (res ^ (pixel >> 8)) * 16777619UL;
+		}
+		return res;
+	}
+};
+
+
+/** Passing clock color used for all tests in RGB565. */
+static const uint16_t passColor = 0x07FF;
+/** Failing clock color used for all tests in RGB565. */
+static const uint16_t failColor = 0xA082;
+/** Number of pixels of a digit cell. */
+static const size_t digitPixels = size_t(DigitalClock::DIGIT_WIDTH * DigitalClock::GLYPH_HEIGHT);
+
+
+/**
+ * Allocator passed to `DigitalClock::begin()` which always fails.
+ *
+ * @param[in] size - number of bytes to allocate
+ * @return always `NULL`
+ */
+static void * failAlloc(size_t size) {
+	(void)size;
+	return NULL;
+}
+
+
+void setUp(void) {
+	/* test setup */
+}
+
+
+void tearDown(void) {
+	/* test clean-up */
+}
+
+
+void test_begin() {
+	{
+		DigitalClock clock;
+		TEST_ASSERT_TRUE(clock.begin(svgDigits, malloc));
+		TEST_ASSERT_TRUE(clock.error() == NULL);
+		TEST_ASSERT_EQUAL_size_t(0, clock.renders());
+	}
+	{
+		DigitalClock clock;
+		TEST_ASSERT_FALSE(clock.begin(svgDigits, failAlloc));
+		TEST_ASSERT_TRUE(clock.error() != NULL);
+	}
+	{
+		NSVGimage image = svgDigits;
+		image.width = float(DigitalClock::WIDTH);
+		DigitalClock clock;
+		TEST_ASSERT_FALSE(clock.begin(image, malloc));
+		TEST_ASSERT_TRUE(clock.error() != NULL);
+	}
+	{
+		/* drawing fails without glyph atlas */
+		DigitalClock clock;
+		FrameSink * sink = new FrameSink();
+		TEST_ASSERT_FALSE(clock.draw(*sink, "12:00", passColor, true));
+		TEST_ASSERT_EQUAL_size_t(0, sink->pixels);
+		delete sink;
+	}
+}
+
+
+void test_cells() {
+	/* only the cells of changed characters are pushed */
+	DigitalClock clock;
+	TEST_ASSERT_TRUE(clock.begin(svgDigits, malloc));
+	FrameSink * sink = new FrameSink();
+	TEST_ASSERT_TRUE(clock.draw(*sink, "12:59", passColor, true));
+	TEST_ASSERT_EQUAL_size_t(DigitalClock::CELLS, sink->regions);
+	TEST_ASSERT_EQUAL_size_t(size_t(DigitalClock::TEXT_WIDTH * DigitalClock::GLYPH_HEIGHT), sink->pixels);
+	sink->reset();
+	TEST_ASSERT_TRUE(clock.draw(*sink, "13:00", passColor, false));
+	TEST_ASSERT_EQUAL_size_t(3, sink->regions);
+	TEST_ASSERT_EQUAL_size_t(3 * digitPixels, sink->pixels);
+	sink->reset();
+	TEST_ASSERT_TRUE(clock.draw(*sink, "13:01", passColor, false));
+	TEST_ASSERT_EQUAL_size_t(1, sink->regions);
+	TEST_ASSERT_EQUAL_size_t(digitPixels, sink->pixels);
+	sink->reset();
+	TEST_ASSERT_TRUE(clock.draw(*sink, "13:01", passColor, false));
+	TEST_ASSERT_EQUAL_size_t(0, sink->pixels);
+	TEST_ASSERT_TRUE(clock.draw(*sink, "13:01", passColor, true));
+	TEST_ASSERT_EQUAL_size_t(DigitalClock::CELLS, sink->regions);
+	/* incremental updates give the same frame as a full redraw */
+	FrameSink * ref = new FrameSink();
+	DigitalClock refClock;
+	TEST_ASSERT_TRUE(refClock.begin(svgDigits, malloc));
+	TEST_ASSERT_TRUE(refClock.draw(*ref, "13:01", passColor, true));
+	TEST_ASSERT_EQUAL_MEMORY(ref->frame, sink->frame, sizeof(ref->frame));
+	/* an empty time clears all cells */
+	sink->reset();
+	TEST_ASSERT_TRUE(clock.draw(*sink, "", passColor, false));
+	TEST_ASSERT_EQUAL_size_t(DigitalClock::CELLS, sink->regions);
+	memset(ref->frame, 0, sizeof(ref->frame));
+	TEST_ASSERT_EQUAL_MEMORY(ref->frame, sink->frame, sizeof(ref->frame));
+	delete ref;
+	delete sink;
+}
+
+
+void test_atlas() {
+	/* glyph atlases are rendered once per color */
+	DigitalClock clock;
+	TEST_ASSERT_TRUE(clock.begin(svgDigits, malloc));
+	FrameSink * sink = new FrameSink();
+	TEST_ASSERT_TRUE(clock.draw(*sink, "07:15", passColor, true));
+	TEST_ASSERT_EQUAL_size_t(1, clock.renders());
+	const uint32_t passHash = sink->hash();
+	/* a color change redraws all cells */
+	sink->reset();
+	TEST_ASSERT_TRUE(clock.draw(*sink, "07:15", failColor, false));
+	TEST_ASSERT_EQUAL_size_t(DigitalClock::CELLS, sink->regions);
+	TEST_ASSERT_EQUAL_size_t(2, clock.renders());
+	TEST_ASSERT_TRUE(sink->hash() != passHash);
+	TEST_ASSERT_TRUE(clock.draw(*sink, "07:15", passColor, false));
+	TEST_ASSERT_EQUAL_size_t(2, clock.renders());
+	TEST_ASSERT_EQUAL_UINT32(passHash, sink->hash());
+	/* a third color replaces the atlas used least recently */
+	TEST_ASSERT_TRUE(clock.draw(*sink, "07:15", 0xFFFF, false));
+	TEST_ASSERT_EQUAL_size_t(3, clock.renders());
+	TEST_ASSERT_TRUE(clock.draw(*sink, "07:15", passColor, false));
+	TEST_ASSERT_EQUAL_size_t(3, clock.renders());
+	TEST_ASSERT_TRUE(clock.draw(*sink, "07:15", failColor, false));
+	TEST_ASSERT_EQUAL_size_t(4, clock.renders());
+	/* glyph edges are anti-aliased */
+	size_t background = 0, foreground = 0, edges = 0;
+	for (const uint16_t pixel : sink->frame) {
+		if (pixel == 0) {
+			background++;
+		} else if (pixel == failColor) {
+			foreground++;
+		} else {
+			edges++;
+		}
+	}
+	TEST_ASSERT_TRUE(foreground > 0);
+	TEST_ASSERT_TRUE(edges > 0);
+	TEST_ASSERT_TRUE(background > (foreground + edges));
+	delete sink;
+}
+
+
+void test_golden() {
+	/* golden image as FNV-1a hash of the RGB565 frame buffer */
+	DigitalClock clock;
+	TEST_ASSERT_TRUE(clock.begin(svgDigits, malloc));
+	FrameSink * sink = new FrameSink();
+	TEST_ASSERT_TRUE(clock.draw(*sink, "01:23", passColor, true));
+	TEST_ASSERT_TRUE(clock.draw(*sink, "45:67", passColor, false));
+	TEST_ASSERT_TRUE(clock.draw(*sink, "89:00", passColor, false));
+	char msg[64];
+	snprintf(msg, sizeof(msg), "got 0x%08lX", static_cast<unsigned long>(sink->hash()));
+	TEST_ASSERT_EQUAL_UINT32_MESSAGE(0x687B084BUL, sink->hash(), msg);
+	delete sink;
+}
+
+
+/**
+ * Main entry point for all unit tests.
+ */
+int main() {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_begin);
+	RUN_TEST(test_cells);
+	RUN_TEST(test_atlas);
+	RUN_TEST(test_golden);
+
+	UNITY_END();
+	return 0;
+}
@@ -2,7 +2,7 @@
  * @file test_main.cpp
  * @author Daniel Starke
  * @date 2024-04-21
- * @version 2024-05-05
+ * @version 2026-10-14
  *
  * Copyright (c) 2024 Daniel Starke
  *
@@ -26,6 +26,7 @@
  * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include <unity.h>
+#include <cstddef>
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
@@ -42,6 +43,46 @@
 #endif /* ARRAY_SIZE */
 
 
+/** Number of heap allocations via `new`. */
+static size_t newCount = 0;
+
+
+/**
+ * Allocates memory and counts the allocation.
+ *
+ * @param[in] size - number of bytes to allocate
+ * @return allocated memory
+ */
+void * operator new(size_t size) {
+	newCount++;
+	void * ptr = std::malloc((size > 0) ? size : 1);
+	if (ptr == NULL) {
+		std::abort();
+	}
+	return ptr;
+}
+
+
+/**
+ * Frees memory allocated via `new`.
+ *
+ * @param[in] ptr - memory to free
+ */
+void operator delete(void * ptr) noexcept {
+	std::free(ptr);
+}
+
+
+/**
+ * Frees memory allocated via `new`.
+ *
+ * @param[in] ptr - memory to free
+ */
+void operator delete(void * ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+
 
 /**
  * Used by IniParser to iterate over all characters in a string.
@@ -72,6 +113,41 @@ public:
 };
 
 
+/**
+ * Used by IniParser to read a string in chunks.
+ */
+class ChunkProvider {
+private:
+	const char * ptr;
+	size_t chunkSize;
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param[in] str - pointer to the input string
+	 * @param[in] maxChunk - maximum number of bytes to return at once
+	 */
+	explicit inline ChunkProvider(const char * str, const size_t maxChunk = 3):
+		ptr(str),
+		chunkSize(maxChunk)
+	{}
+	/**
+	 * Function operator which provides the next chunk of data.
+	 *
+	 * @param[out] buf - buffer to write to
+	 * @param[in] size - size of `buf` in bytes
+	 * @return number of bytes written or 0 on end of input
+	 */
+	size_t operator() (char * buf, const size_t size) {
+		size_t len = 0;
+		while (ptr != NULL && *ptr != 0 && len < size && len < chunkSize) {
+			buf[len++] = *ptr++;
+		}
+		return len;
+	}
+};
+
+
 namespace variants {
 struct StrU32Pair {
 	const char * str;
@@ -812,16 +888,16 @@ void test_size_limits() {
 		return true;
 	};
 	/* group string length limit */
-	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString("[g123456]", ignoreAllValues, 8));
-	TEST_ASSERT_EQUAL_size_t(1, IniParser::parseString("[g1234567]", ignoreAllValues, 8));
+	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString<8>("[g123456]", ignoreAllValues));
+	TEST_ASSERT_EQUAL_size_t(1, IniParser::parseString<8>("[g1234567]", ignoreAllValues));
 	/* key string length limit */
-	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString("k123456 =", ignoreAllValues, 8));
-	TEST_ASSERT_EQUAL_size_t(1, IniParser::parseString("k1234567 =", ignoreAllValues, 8));
+	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString<8>("k123456 =", ignoreAllValues));
+	TEST_ASSERT_EQUAL_size_t(1, IniParser::parseString<8>("k1234567 =", ignoreAllValues));
 	/* value string length limit */
-	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString("key = v123456", mapString, 8));
-	TEST_ASSERT_EQUAL_size_t(1, IniParser::parseString("key = v1234567", mapString, 8));
-	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString("key = 'v123456'", mapString, 8));
-	TEST_ASSERT_EQUAL_size_t(1, IniParser::parseString("key = 'v1234567'", mapString, 8));
+	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString<8>("key = v123456", mapString));
+	TEST_ASSERT_EQUAL_size_t(1, IniParser::parseString<8>("key = v1234567", mapString));
+	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString<8>("key = 'v123456'", mapString));
+	TEST_ASSERT_EQUAL_size_t(1, IniParser::parseString<8>("key = 'v1234567'", mapString));
 }
 
 
@@ -913,17 +989,83 @@ void test_data_function() {
 }
 
 
+/**
+ * Test if `IniParser` handles chunk data providers and data blocks correctly.
+ */
+void test_chunk_data_function() {
+	static const char * iniStr = "[group]\r\nkey = 'value' # comment\r\nnum = 0x1F\n\n[other]\nkey = \"a b\"\n";
+	static const size_t chunkSizes[] = {1, 2, 3, 7, 64, 1024};
+	char str[8];
+	uint32_t num;
+	const auto mapValues = [&] (IniParser::Context & ctx) -> bool {
+		if (ctx.group == "group") {
+			if (ctx.key == "key") {
+				ctx.mapString(str);
+			} else if (ctx.key == "num") {
+				ctx.mapNumber(num);
+			}
+		}
+		return true;
+	};
+	for (const size_t chunkSize : chunkSizes) {
+		/* default group/key limit */
+		memset(str, 0, sizeof(str));
+		num = 0;
+		TEST_ASSERT_EQUAL_size_t(0, IniParser::parseFn(ChunkProvider(iniStr, chunkSize), mapValues));
+		TEST_ASSERT_EQUAL_STRING("value", str);
+		TEST_ASSERT_EQUAL_UINT32_MESSAGE(0x1F, num, "chunked number value");
+		TEST_ASSERT_EQUAL_size_t(1, IniParser::parseFn(ChunkProvider("[gr", chunkSize), ignoreAllValues));
+		TEST_ASSERT_EQUAL_size_t(3, IniParser::parseFn(ChunkProvider("[a]\r\n\r\nb = 'c\nd'", chunkSize), ignoreAllValues));
+		/* explicit group/key limit */
+		memset(str, 0, sizeof(str));
+		num = 0;
+		TEST_ASSERT_EQUAL_size_t(0, iniParseFn<8>(ChunkProvider(iniStr, chunkSize), mapValues));
+		TEST_ASSERT_EQUAL_STRING("value", str);
+		TEST_ASSERT_EQUAL_UINT32_MESSAGE(0x1F, num, "chunked number value");
+		TEST_ASSERT_EQUAL_size_t(1, iniParseFn<8>(ChunkProvider("[gr", chunkSize), ignoreAllValues));
+		TEST_ASSERT_EQUAL_size_t(3, iniParseFn<8>(ChunkProvider("[a]\r\n\r\nb = 'c\nd'", chunkSize), ignoreAllValues));
+	}
+	/* empty input */
+	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseFn(ChunkProvider(""), ignoreAllValues));
+	TEST_ASSERT_EQUAL_size_t(0, iniParseFn<8>(ChunkProvider(""), ignoreAllValues));
+	/* data block */
+	memset(str, 0, sizeof(str));
+	num = 0;
+	TEST_ASSERT_EQUAL_size_t(0, iniParseBlock<8>(iniStr, strlen(iniStr), mapValues));
+	TEST_ASSERT_EQUAL_STRING("value", str);
+	TEST_ASSERT_EQUAL_UINT32_MESSAGE(0x1F, num, "block number value");
+	TEST_ASSERT_EQUAL_size_t(0, iniParseBlock<8>("[group]x", 7, ignoreAllValues));
+	TEST_ASSERT_EQUAL_size_t(1, iniParseBlock<8>("[group]x", 8, ignoreAllValues));
+	TEST_ASSERT_EQUAL_size_t(1, iniParseBlock<8>("[group]\0", 8, ignoreAllValues));
+	TEST_ASSERT_EQUAL_size_t(0, iniParseBlock<8>(NULL, 0, ignoreAllValues));
+	/* characters above 127 are valid string characters */
+	memset(str, 0, sizeof(str));
+	TEST_ASSERT_EQUAL_size_t(0, iniParseBlock<8>("[group]\nkey = \xC3\xA4", 16, mapValues));
+	TEST_ASSERT_EQUAL_STRING("\xC3\xA4", str);
+	/* incremental blocks */
+	IniParserSized<16> ini(mapValues);
+	memset(str, 0, sizeof(str));
+	TEST_ASSERT_TRUE(ini.parse("[group]\nke", 10));
+	TEST_ASSERT_TRUE(ini.parse("y = 'val", 8));
+	TEST_ASSERT_TRUE(ini.parse("ue'", 3));
+	TEST_ASSERT_TRUE(ini.parse(-1));
+	TEST_ASSERT_EQUAL_STRING("value", str);
+	TEST_ASSERT_FALSE(ini.parse("\x03", 1));
+	TEST_ASSERT_FALSE(ini);
+}
+
+
 /**
  * Test if `IniParser` handles strings with size limit correctly.
  */
 void test_sized_string_input() {
-	/* heap allocated */
+	/* static member function */
 	TEST_ASSERT_EQUAL_size_t(1, IniParser::parseString("[gr", 3, ignoreAllValues));
 	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString("[group]", 7, ignoreAllValues));
 	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString("[group]x", 7, ignoreAllValues));
 	TEST_ASSERT_EQUAL_size_t(1, IniParser::parseString("[group]x", 8, ignoreAllValues));
 	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString("[group]", 8, ignoreAllValues));
-	/* stack allocated */
+	/* free function */
 	TEST_ASSERT_EQUAL_size_t(1, iniParseString<16>("[gr", 3, ignoreAllValues));
 	TEST_ASSERT_EQUAL_size_t(0, iniParseString<16>("[group]", 7, ignoreAllValues));
 	TEST_ASSERT_EQUAL_size_t(0, iniParseString<16>("[group]x", 7, ignoreAllValues));
@@ -950,7 +1092,7 @@ void test_special_errors() {
 	};
 	/* null character in handled string */
 	{
-		IniParser ini(mapString);
+		IniParserSized<16> ini(mapString);
 		const char * ptr = "[group]\nkey = abc";
 		while (*ptr != 0) {
 			TEST_ASSERT_TRUE(ini.parse(int(*ptr)));
@@ -961,7 +1103,7 @@ void test_special_errors() {
 	}
 	/* null character in unhandled string */
 	{
-		IniParser ini(ignoreAllValues);
+		IniParserSized<16> ini(ignoreAllValues);
 		const char * ptr = "[group]\nkey = abc";
 		while (*ptr != 0) {
 			TEST_ASSERT_TRUE(ini.parse(int(*ptr)));
@@ -972,7 +1114,7 @@ void test_special_errors() {
 	}
 	/* parse beyond error */
 	{
-		IniParser ini(ignoreAllValues);
+		IniParserSized<16> ini(ignoreAllValues);
 		const char * ptr = "[gr oup]";
 		while (*ptr != 0) {
 			ini.parse(int(*ptr));
@@ -1014,6 +1156,14 @@ void test_string_helper() {
 		return true;
 	};
 	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString("[group]\nkey = abc", mapString));
+	/* key directly followed by the assignment after a longer key */
+	char lastKey[16] = {0};
+	const auto copyKey = [&] (IniParser::Context & ctx) -> bool {
+		strcpy(lastKey, ctx.key);
+		return true;
+	};
+	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString("[group]\nlong_key = 1\nkey=2", copyKey));
+	TEST_ASSERT_EQUAL_STRING("key", lastKey);
 }
 
 
@@ -1061,6 +1211,56 @@ void test_template_sized_parser() {
 }
 
 
+/**
+ * Test reusing `IniParserSized` via `reset()` without heap allocation.
+ */
+void test_reset() {
+	static const char * iniStrOk = "[group]\nkey = 'abc'\nnum = 42";
+	static const char * iniStrNok = "[group]\nkey = 'abc\nnum = 42";
+	char str[8];
+	uint32_t num;
+	const auto mapValues = [&] (IniParser::Context & ctx) -> bool {
+		if (ctx.group == "group") {
+			if (ctx.key == "key") {
+				ctx.mapString(str);
+			} else if (ctx.key == "num") {
+				ctx.mapNumber(num);
+			}
+		}
+		return true;
+	};
+	const size_t newStart = newCount;
+	IniParserSized<8> ini(mapValues);
+	for (int run = 0; run < 3; run++) {
+		memset(str, 0, sizeof(str));
+		num = 0;
+		ini.reset();
+		TEST_ASSERT_TRUE(ini);
+		TEST_ASSERT_EQUAL_size_t(1, ini.getLine());
+		if (run == 1) {
+			/* syntax error in between */
+			TEST_ASSERT_FALSE(ini.parse(iniStrNok, strlen(iniStrNok)));
+			TEST_ASSERT_EQUAL_size_t(2, ini.getLine());
+			TEST_ASSERT_FALSE(ini);
+			continue;
+		}
+		TEST_ASSERT_TRUE(ini.parse(iniStrOk, strlen(iniStrOk)));
+		TEST_ASSERT_TRUE(ini.parse(-1));
+		TEST_ASSERT_EQUAL_STRING("abc", str);
+		TEST_ASSERT_EQUAL_UINT32(42, num);
+		TEST_ASSERT_EQUAL_size_t(3, ini.getLine());
+	}
+	/* no entry point allocates from heap */
+	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString(iniStrOk, mapValues));
+	TEST_ASSERT_EQUAL_size_t(0, IniParser::parseString(iniStrOk, strlen(iniStrOk), mapValues));
+	TEST_ASSERT_EQUAL_size_t(0, iniParseString<8>(iniStrOk, mapValues));
+	TEST_ASSERT_EQUAL_size_t(0, iniParseFn<8>(StringProvider(iniStrOk), mapValues));
+	TEST_ASSERT_EQUAL_size_t(0, iniParseFn<8>(ChunkProvider(iniStrOk), mapValues));
+	TEST_ASSERT_EQUAL_size_t(0, iniParseBlock<8>(iniStrOk, strlen(iniStrOk), mapValues));
+	TEST_ASSERT_EQUAL_size_t(newStart, newCount);
+}
+
+
 class MapNum123 {
 private:
 	uint32_t num;
@@ -1182,6 +1382,81 @@ void test_custom_value_verification() {
 }
 
 
+struct KeyMapValues {
+	char str[8];
+	uint32_t u32;
+	int32_t i32;
+	uint32_t hexU32;
+	int32_t hexI32;
+
+	bool checkStr() const noexcept {
+		return strcmp(this->str, "bad") != 0;
+	}
+};
+
+
+void test_key_map() {
+	typedef IniParser::Mapping<KeyMapValues> M;
+	static constexpr M mappings[] = {
+		M::string("group", "str", offsetof(KeyMapValues, str), sizeof(KeyMapValues::str), 0x01, &KeyMapValues::checkStr),
+		M::u32("group", "u32", offsetof(KeyMapValues, u32), 0, 100),
+		M::i32("group", "i32", offsetof(KeyMapValues, i32), -10, 10, 0x02),
+		M::hexU32("other", "u32", offsetof(KeyMapValues, hexU32)),
+		M::hexI32("other", "i32", offsetof(KeyMapValues, hexI32))
+	};
+	static_assert(mappings[0].hash == IniParser::hashKey("group", "str"), "compile-time hash");
+	static const IniParser::KeyMap<KeyMapValues> keys(mappings);
+	KeyMapValues values, other;
+	uint32_t found;
+	/* lookup */
+	TEST_ASSERT_EQUAL_size_t(5, keys.size());
+	TEST_ASSERT_EQUAL_UINT32(0x1F, keys.all());
+	TEST_ASSERT_EQUAL_UINT32(0x05, keys.select(0x03));
+	TEST_ASSERT_EQUAL_INT(0, keys.find("group", "str"));
+	TEST_ASSERT_EQUAL_INT(3, keys.find("other", "u32"));
+	TEST_ASSERT_EQUAL_INT(4, keys.find("other", "i32"));
+	TEST_ASSERT_EQUAL_INT(-1, keys.find("other", "str"));
+	TEST_ASSERT_EQUAL_INT(-1, keys.find("group", ""));
+	TEST_ASSERT_EQUAL_UINT32(IniParser::hashKey("a", "b"), IniParser::hashString("a.b"));
+	/* mapping */
+	memset(&values, 0, sizeof(values));
+	found = 0;
+	TEST_ASSERT_EQUAL_size_t(0, iniParseString<8>("[group]\nstr = 'abc'\nu32 = 42\nunknown = 1\n[other]\ni32 = -10\n", keys.mapper(values, found)));
+	TEST_ASSERT_EQUAL_UINT32(0x13, found);
+	TEST_ASSERT_EQUAL_STRING("abc", values.str);
+	TEST_ASSERT_EQUAL_UINT32(42, values.u32);
+	TEST_ASSERT_EQUAL_INT32(-16, values.hexI32);
+	found = 0;
+	TEST_ASSERT_EQUAL_size_t(0, iniParseString<8>("[group]\ni32 = -10\n[other]\nu32 = FF\n", keys.mapper(values, found)));
+	TEST_ASSERT_EQUAL_UINT32(0x0C, found);
+	TEST_ASSERT_EQUAL_INT32(-10, values.i32);
+	TEST_ASSERT_EQUAL_UINT32(0xFF, values.hexU32);
+	/* range and checker */
+	found = 0;
+	TEST_ASSERT_EQUAL_size_t(2, iniParseString<8>("[group]\nu32 = 101", keys.mapper(values, found)));
+	TEST_ASSERT_EQUAL_size_t(2, iniParseString<8>("[group]\ni32 = -11", keys.mapper(values, found)));
+	TEST_ASSERT_EQUAL_size_t(2, iniParseString<8>("[group]\nstr = 'bad'", keys.mapper(values, found)));
+	/* masked keys are ignored */
+	memset(&values, 0, sizeof(values));
+	found = 0;
+	TEST_ASSERT_EQUAL_size_t(0, iniParseString<8>("[group]\nstr = 'bad'\nu32 = 1", keys.mapper(values, found, 0x02)));
+	TEST_ASSERT_EQUAL_UINT32(0x02, found);
+	TEST_ASSERT_EQUAL_STRING("", values.str);
+	TEST_ASSERT_EQUAL_UINT32(1, values.u32);
+	/* assignment */
+	memset(&other, 0, sizeof(other));
+	strcpy(values.str, "xyz");
+	TEST_ASSERT_FALSE(keys.equal(other, values, 0));
+	TEST_ASSERT_TRUE(keys.assign(other, values, 0));
+	TEST_ASSERT_TRUE(keys.equal(other, values, 0));
+	TEST_ASSERT_FALSE(keys.assign(other, values, 0));
+	TEST_ASSERT_EQUAL_STRING("xyz", other.str);
+	TEST_ASSERT_TRUE(keys.assign(other, values, 1));
+	TEST_ASSERT_FALSE(keys.assign(other, values, 2));
+	TEST_ASSERT_EQUAL_UINT32(1, other.u32);
+}
+
+
 /**
  * Main entry point for all unit tests.
  */
@@ -1197,11 +1472,14 @@ int main() {
 	RUN_TEST(test_signed_number_values);
 	RUN_TEST(test_size_limits);
 	RUN_TEST(test_data_function);
+	RUN_TEST(test_chunk_data_function);
 	RUN_TEST(test_sized_string_input);
 	RUN_TEST(test_special_errors);
 	RUN_TEST(test_string_helper);
 	RUN_TEST(test_template_sized_parser);
+	RUN_TEST(test_reset);
 	RUN_TEST(test_custom_value_verification);
+	RUN_TEST(test_key_map);
 
 	UNITY_END();
 	return 0;
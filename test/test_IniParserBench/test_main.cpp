@@ -0,0 +1,451 @@
+/**
+ * @file test_main.cpp
+ * @author Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Copyright (c) 2026 Daniel Starke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <unity.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "IniParser.hpp"
+
+
+#ifndef INI_BENCH_SIZE
+/** Number of bytes in the synthetic INI input. */
+#define INI_BENCH_SIZE (2UL * 1024UL * 1024UL)
+#endif /* INI_BENCH_SIZE */
+
+
+#ifndef INI_BENCH_RUNS
+/** Number of runs per variant. The fastest one is reported. */
+#define INI_BENCH_RUNS 5
+#endif /* INI_BENCH_RUNS */
+
+
+/** Maximum number of characters for group and key strings including null-terminator. */
+#define INI_BENCH_MAX_ID 16
+
+
+
+/** Synthetic INI input and the expected parsing results. */
+static char * input = NULL;
+static size_t inputLen = 0;
+static size_t inputKeys = 0;
+static uint32_t inputHash = 0;
+
+
+/** Values receiving the parsed data. */
+struct BenchValues {
+	char str[64];
+	uint32_t u32;
+	int32_t i32;
+	uint32_t hex;
+	size_t keys;   /**< Number of mapped keys. */
+	size_t values; /**< Number of parsed values. */
+	uint32_t hash; /**< Hash over all parsed values. */
+};
+
+
+/**
+ * Mapping function for the synthetic INI input. The first character of the key
+ * selects the value type. All parsed values are combined into a single hash to
+ * verify that every variant yields the same result.
+ */
+class BenchMapping {
+private:
+	BenchValues * values;
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param[out] v - values to map to
+	 */
+	explicit inline BenchMapping(BenchValues & v) noexcept:
+		values(&v)
+	{}
+
+	/**
+	 * Maps the current key and hashes its value once parsed.
+	 *
+	 * @param[in,out] ctx - parsing context
+	 * @param[in] parsed - true if the value has been parsed, false if it needs to be mapped
+	 * @return true on success, else false
+	 */
+	bool operator() (IniParser::Context & ctx, const bool parsed) noexcept {
+		const char type = static_cast<const char *>(ctx.key)[0];
+		if ( ! parsed ) {
+			this->values->keys++;
+			switch (type) {
+			case 's': ctx.mapString(this->values->str); break;
+			case 'u': ctx.mapNumber(this->values->u32); break;
+			case 'i': ctx.mapNumber(this->values->i32); break;
+			case 'h': ctx.mapHexNumber(this->values->hex); break;
+			default: break; /* ignore value */
+			}
+			return true;
+		}
+		uint32_t value;
+		switch (type) {
+		case 's': value = IniParser::hashString(this->values->str); break;
+		case 'u': value = this->values->u32; break;
+		case 'i': value = uint32_t(this->values->i32); break;
+		default: value = this->values->hex; break;
+		}
+		this->values->values++;
+		this->values->hash = (this->values->hash ^ value) * 16777619UL;
+		return true;
+	}
+};
+
+
+/**
+ * Used by IniParser to iterate over all characters in a string.
+ */
+class StringProvider {
+private:
+	const char * ptr;
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param[in] str - pointer to the input string
+	 */
+	explicit inline StringProvider(const char * str):
+		ptr(str)
+	{}
+	/**
+	 * Function operator which provides a character at a time.
+	 *
+	 * @return next character or -1 on end of input
+	 */
+	int operator() () {
+		if (*ptr == 0) {
+			return -1;
+		}
+		return int(*ptr++);
+	}
+};
+
+
+/**
+ * Used by IniParser to read a string in chunks.
+ */
+class ChunkProvider {
+private:
+	const char * ptr;
+	const char * end;
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param[in] str - pointer to the input string
+	 * @param[in] len - length of the input string
+	 */
+	explicit inline ChunkProvider(const char * str, const size_t len):
+		ptr(str),
+		end(str + len)
+	{}
+	/**
+	 * Function operator which provides the next chunk of data.
+	 *
+	 * @param[out] buf - buffer to write to
+	 * @param[in] size - size of `buf` in bytes
+	 * @return number of bytes written or 0 on end of input
+	 */
+	size_t operator() (char * buf, const size_t size) {
+		size_t len = size_t(this->end - this->ptr);
+		if (len > size) {
+			len = size;
+		}
+		memcpy(buf, this->ptr, len);
+		this->ptr += len;
+		return len;
+	}
+};
+
+
+/**
+ * Returns the next pseudo random number. This is a linear congruential generator
+ * to keep the generated input identical on all platforms.
+ *
+ * @param[in,out] state - generator state
+ * @return pseudo random number
+ */
+static inline uint32_t nextRandom(uint32_t & state) noexcept {
+	state = uint32_t((state * 1664525UL) + 1013904223UL);
+	return state >> 8;
+}
+
+
+/**
+ * Generates a synthetic INI input with groups, comments, quoted and unquoted
+ * strings, decimal and hexadecimal numbers, ignored keys and mixed line endings.
+ *
+ * @param[in] size - approximate number of bytes to generate
+ * @param[out] len - number of bytes generated
+ * @param[out] keys - number of keys generated
+ * @return generated null-terminated string (free with `free()`)
+ */
+static char * generateIni(const size_t size, size_t & len, size_t & keys) {
+	static const char * const words[] = {"clock", "pass", "fail", "color", "server", "time", "zone", "value"};
+	char * str = static_cast<char *>(malloc(size + 256));
+	if (str == NULL) {
+		return NULL;
+	}
+	uint32_t state = 0x494E4921UL;
+	len = 0;
+	keys = 0;
+	while (len < size) {
+		char * out = str + len;
+		const size_t avail = size + 256 - len;
+		const uint32_t rnd = nextRandom(state);
+		const unsigned id = unsigned(keys % 100000);
+		const char * word = words[rnd % 8];
+		int n;
+		if ((keys % 32) == 0 && (rnd & 0x100) == 0) {
+			n = snprintf(out, avail, "\n[%s%u]\n", word, unsigned(keys / 32));
+			keys--; /* not a key */
+		} else switch ((rnd >> 9) % 8) {
+		case 0: n = snprintf(out, avail, "# %s %s comment line\n", word, words[(rnd >> 12) % 8]); keys--; break;
+		case 1: n = snprintf(out, avail, "s%u = %s %s\n", id, word, words[(rnd >> 12) % 8]); break;
+		case 2: n = snprintf(out, avail, "s%u = \"%s = %u # quoted\" # comment\n", id, word, unsigned(rnd)); break;
+		case 3: n = snprintf(out, avail, "s%u='%s'\r\n", id, word); break;
+		case 4: n = snprintf(out, avail, "u%u = %u\n", id, unsigned(rnd)); break;
+		case 5: n = snprintf(out, avail, "i%u\t= -%u\n", id, unsigned(rnd & 0xFFFF)); break;
+		case 6: n = snprintf(out, avail, "h%u = %X # RGB565\n", id, unsigned(rnd & 0xFFFF)); break;
+		default: n = snprintf(out, avail, "x%u = ignored %s value\n", id, word); break;
+		}
+		len += size_t(n);
+		keys++;
+	}
+	return str;
+}
+
+
+/**
+ * Runs the given function multiple times and returns the fastest run.
+ *
+ * @param[in] fn - function to measure
+ * @return nanoseconds of the fastest run
+ * @tparam Fn - function object with the signature `void function(void)`
+ */
+template <typename Fn>
+static int64_t measure(Fn fn) {
+	int64_t best = INT64_MAX;
+	for (int run = 0; run < INI_BENCH_RUNS; run++) {
+		const auto start = std::chrono::steady_clock::now();
+		fn();
+		const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		if (ns < best) {
+			best = ns;
+		}
+	}
+	return best;
+}
+
+
+/**
+ * Prints the throughput of a single variant.
+ *
+ * @param[in] name - variant name
+ * @param[in] ns - nanoseconds for parsing the whole input
+ * @param[in] bytes - number of bytes parsed
+ * @param[in] keys - number of keys parsed
+ */
+static void report(const char * name, const int64_t ns, const size_t bytes, const size_t keys) {
+	const double sec = double(ns) / 1e9;
+	printf("%-36s %8.1f MB/s %8.1f ns/key\n", name, (double(bytes) / (1024.0 * 1024.0)) / sec, double(ns) / double(keys));
+}
+
+
+/**
+ * Measures the given parse function against the synthetic input and verifies its result.
+ *
+ * @param[in] name - variant name
+ * @param[in] fn - parse function
+ * @tparam Fn - function object with the signature `size_t function(BenchValues &)` returning the error line or 0
+ */
+template <typename Fn>
+static void benchmark(const char * name, Fn fn) {
+	BenchValues values;
+	size_t res = 0;
+	const int64_t ns = measure([&] () {
+		memset(&values, 0, sizeof(values));
+		res = fn(values);
+	});
+	TEST_ASSERT_EQUAL_size_t_MESSAGE(0, res, name);
+	TEST_ASSERT_EQUAL_size_t_MESSAGE(inputKeys, values.keys, name);
+	TEST_ASSERT_EQUAL_UINT32_MESSAGE(inputHash, values.hash, name);
+	report(name, ns, inputLen, values.keys);
+}
+
+
+void setUp(void) {
+	/* test setup */
+}
+
+
+void tearDown(void) {
+	/* test clean-up */
+}
+
+
+void test_input() {
+	TEST_ASSERT_TRUE(input != NULL);
+	TEST_ASSERT_EQUAL_size_t(inputLen, strlen(input));
+	/* reference result for all other variants */
+	BenchValues values;
+	memset(&values, 0, sizeof(values));
+	TEST_ASSERT_EQUAL_size_t(0, iniParseBlock<INI_BENCH_MAX_ID>(input, inputLen, BenchMapping(values)));
+	TEST_ASSERT_EQUAL_size_t(inputKeys, values.keys);
+	TEST_ASSERT_TRUE(values.values > ((inputKeys * 3) / 4));
+	inputHash = values.hash;
+	printf("input: %zu bytes, %zu keys, %zu values\n", inputLen, inputKeys, values.values);
+}
+
+
+void test_string() {
+	benchmark("iniParseString()", [] (BenchValues & values) {
+		return iniParseString<INI_BENCH_MAX_ID>(input, BenchMapping(values));
+	});
+	benchmark("iniParseString(len)", [] (BenchValues & values) {
+		return iniParseString<INI_BENCH_MAX_ID>(input, inputLen, BenchMapping(values));
+	});
+	benchmark("iniParseBlock()", [] (BenchValues & values) {
+		return iniParseBlock<INI_BENCH_MAX_ID>(input, inputLen, BenchMapping(values));
+	});
+}
+
+
+void test_data_function() {
+	benchmark("iniParseFn(int ())", [] (BenchValues & values) {
+		return iniParseFn<INI_BENCH_MAX_ID>(StringProvider(input), BenchMapping(values));
+	});
+	benchmark("iniParseFn(size_t (char *, size_t))", [] (BenchValues & values) {
+		return iniParseFn<INI_BENCH_MAX_ID>(ChunkProvider(input, inputLen), BenchMapping(values));
+	});
+}
+
+
+void test_sized_parser() {
+	benchmark("IniParserSized::parse(int)", [] (BenchValues & values) -> size_t {
+		IniParserSized<INI_BENCH_MAX_ID, sizeof(BenchMapping)> ini{BenchMapping(values)};
+		const unsigned char * ptr = reinterpret_cast<const unsigned char *>(input);
+		const unsigned char * end = ptr + inputLen;
+		for (; ptr < end; ptr++) {
+			if ( ! ini.parse(int(*ptr)) ) {
+				return ini.getLine();
+			}
+		}
+		return ini.parse(-1) ? 0 : ini.getLine();
+	});
+	benchmark("IniParserSized::parse(data, len)", [] (BenchValues & values) -> size_t {
+		IniParserSized<INI_BENCH_MAX_ID, sizeof(BenchMapping)> ini{BenchMapping(values)};
+		if (( ! ini.parse(input, inputLen) ) || ( ! ini.parse(-1) )) {
+			return ini.getLine();
+		}
+		return 0;
+	});
+	benchmark("IniParser::parseString()", [] (BenchValues & values) {
+		return IniParser::parseString<INI_BENCH_MAX_ID>(input, BenchMapping(values));
+	});
+}
+
+
+/** Configuration similar to the one in `main.cpp`. */
+struct BenchConfig {
+	char ssid[33];
+	char pass[64];
+	char host[64];
+	char server[128];
+	uint32_t timeout;
+	uint32_t passColor;
+	uint32_t failColor;
+	uint32_t fps;
+};
+
+
+void test_key_map() {
+	typedef IniParser::Mapping<BenchConfig> M;
+	static constexpr M mappings[] = {
+		M::string("WIFI", "SSID", offsetof(BenchConfig, ssid), sizeof(BenchConfig::ssid)),
+		M::string("WIFI", "PASS", offsetof(BenchConfig, pass), sizeof(BenchConfig::pass)),
+		M::string("MDNS", "HOST", offsetof(BenchConfig, host), sizeof(BenchConfig::host)),
+		M::u32("NTP", "TIMEOUT", offsetof(BenchConfig, timeout), 1, 60000),
+		M::string("NTP", "SERVER", offsetof(BenchConfig, server), sizeof(BenchConfig::server)),
+		M::u32("CLOCK", "PASS_COLOR", offsetof(BenchConfig, passColor), 0, 0xFFFF),
+		M::u32("CLOCK", "FAIL_COLOR", offsetof(BenchConfig, failColor), 0, 0xFFFF),
+		M::u32("CLOCK", "FPS", offsetof(BenchConfig, fps), 1, 30)
+	};
+	static const IniParser::KeyMap<BenchConfig> keys(mappings);
+	static const char block[] =
+		"[WIFI]\n\nSSID = \"my network\"\nPASS = \"secret password\"\n\n"
+		"[MDNS]\n\n# host name for domain .local\nHOST = \"clock\"\n\n"
+		"[NTP]\n\n# milliseconds\nTIMEOUT = 1000\nSERVER = \"pool.ntp.org,192.168.1.1\"\nTZ = \"CET-1CEST,M3.5.0,M10.5.0/3\"\n\n"
+		"[CLOCK]\n\n# RGB565\nPASS_COLOR = 0x07FF\n# RGB565\nFAIL_COLOR = 0xA082\nTYPE = \"digital\"\nFPS = 10\n\n";
+	const size_t blockKeys = 10;
+	const size_t count = INI_BENCH_SIZE / (sizeof(block) - 1);
+	const size_t len = count * (sizeof(block) - 1);
+	char * str = static_cast<char *>(malloc(len + 1));
+	TEST_ASSERT_TRUE(str != NULL);
+	for (size_t i = 0; i < count; i++) {
+		memcpy(str + (i * (sizeof(block) - 1)), block, sizeof(block) - 1);
+	}
+	str[len] = 0;
+	BenchConfig config;
+	uint32_t found = 0;
+	size_t res = 0;
+	const int64_t ns = measure([&] () {
+		memset(&config, 0, sizeof(config));
+		found = 0;
+		res = iniParseBlock<INI_BENCH_MAX_ID>(str, len, keys.mapper(config, found));
+	});
+	free(str);
+	TEST_ASSERT_EQUAL_size_t(0, res);
+	TEST_ASSERT_EQUAL_UINT32(keys.all(), found);
+	TEST_ASSERT_EQUAL_STRING("pool.ntp.org,192.168.1.1", config.server);
+	TEST_ASSERT_EQUAL_UINT32(0xA082, config.failColor);
+	report("KeyMap::mapper()", ns, len, count * blockKeys);
+}
+
+
+int main() {
+	input = generateIni(INI_BENCH_SIZE, inputLen, inputKeys);
+
+	UNITY_BEGIN();
+
+	RUN_TEST(test_input);
+	RUN_TEST(test_string);
+	RUN_TEST(test_data_function);
+	RUN_TEST(test_sized_parser);
+	RUN_TEST(test_key_map);
+
+	UNITY_END();
+	free(input);
+	return 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file test_main.cpp
+ * @author Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Copyright (c) 2026 Daniel Starke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <unity.h>
+#include <cstdio>
+#include <cstring>
+#include "JsonWriter.hpp"
+
+
+/**
+ * Writes the example document used by the tests.
+ *
+ * @param[in,out] json - JSON writer to use
+ */
+static void writeExample(JsonWriter & json) {
+	json.beginObject();
+	json.key("str").value("a\"b\\c\n\x01\xC3\xA4");
+	json.key("num").value(uint32_t(4294967295UL));
+	json.key("neg").value(int32_t(-2147483647L - 1));
+	json.key("obj").beginObject();
+	json.key("color").hexValue(0x07FF, 6, "#");
+	json.key("empty").beginArray().endArray();
+	json.endObject();
+	json.key("list").beginArray().value(true).value(false).value(uint32_t(0)).beginObject().endObject().endArray();
+	json.endObject();
+}
+
+
+static const char * example = "{\"str\":\"a\\\"b\\\\c\\n\\u0001\xC3\xA4\",\"num\":4294967295,\"neg\":-2147483648,"
+	"\"obj\":{\"color\":\"#0007FF\",\"empty\":[]},\"list\":[true,false,0,{}]}";
+
+
+void setUp(void) {
+	/* test setup */
+}
+
+
+void tearDown(void) {
+	/* test clean-up */
+}
+
+
+void test_document() {
+	char buf[256];
+	memset(buf, 0, sizeof(buf));
+	JsonWriter json(buf, sizeof(buf));
+	writeExample(json);
+	TEST_ASSERT_EQUAL_size_t(strlen(example), json.length());
+	TEST_ASSERT_EQUAL_size_t(strlen(example), json.total());
+	TEST_ASSERT_EQUAL_STRING(example, buf);
+}
+
+
+void test_length_only() {
+	JsonWriter json(NULL, 0);
+	writeExample(json);
+	TEST_ASSERT_EQUAL_size_t(0, json.length());
+	TEST_ASSERT_EQUAL_size_t(strlen(example), json.total());
+}
+
+
+void test_chunked() {
+	static const size_t chunkSizes[] = {1, 2, 3, 7, 64, 1024};
+	const size_t len = strlen(example);
+	for (const size_t chunkSize : chunkSizes) {
+		char buf[1024];
+		char out[256];
+		size_t index = 0;
+		memset(out, 0, sizeof(out));
+		for (;;) {
+			JsonWriter json(buf, chunkSize, index);
+			writeExample(json);
+			TEST_ASSERT_EQUAL_size_t(len, json.total());
+			if (json.length() == 0) {
+				break;
+			}
+			memcpy(out + index, buf, json.length());
+			index += json.length();
+		}
+		TEST_ASSERT_EQUAL_size_t(len, index);
+		TEST_ASSERT_EQUAL_STRING(example, out);
+	}
+}
+
+
+/**
+ * Main entry point for all unit tests.
+ */
+int main() {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_document);
+	RUN_TEST(test_length_only);
+	RUN_TEST(test_chunked);
+
+	UNITY_END();
+	return 0;
+}
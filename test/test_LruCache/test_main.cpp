@@ -0,0 +1,145 @@
+/**
+ * @file test_main.cpp
+ * @author Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Copyright (c) 2026 Daniel Starke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <unity.h>
+#include <cstdio>
+#include <cstring>
+#include "LruCache.hpp"
+
+
+/** Number of live `Item` objects. */
+static int itemsAlive = 0;
+
+
+/**
+ * Cached test object which counts its instances.
+ */
+struct Item {
+	int value;
+
+	Item() noexcept:
+		value(0)
+	{
+		itemsAlive++;
+	}
+
+	~Item() noexcept {
+		itemsAlive--;
+	}
+};
+
+
+void setUp(void) {
+	/* test setup */
+}
+
+
+void tearDown(void) {
+	/* test clean-up */
+}
+
+
+void test_empty() {
+	LruCache<Item, 2, 4> cache;
+	TEST_ASSERT_EQUAL_size_t(0, cache.size());
+	TEST_ASSERT_TRUE(cache.get("a") == NULL);
+	TEST_ASSERT_TRUE(cache.get("") == NULL);
+	TEST_ASSERT_FALSE(cache.remove("a"));
+	TEST_ASSERT_EQUAL_INT(2, itemsAlive);
+}
+
+
+void test_add() {
+	LruCache<Item, 2, 4> cache;
+	TEST_ASSERT_TRUE(cache.add("") == NULL);
+	TEST_ASSERT_TRUE(cache.add("abcde") == NULL);
+	Item * a = cache.add("abcd");
+	TEST_ASSERT_TRUE(a != NULL);
+	a->value = 1;
+	TEST_ASSERT_EQUAL_size_t(1, cache.size());
+	TEST_ASSERT_TRUE(cache.get("abcd") == a);
+	TEST_ASSERT_TRUE(cache.get("abc") == NULL);
+	/* adding the same key again replaces the object */
+	TEST_ASSERT_TRUE(cache.add("abcd") == a);
+	TEST_ASSERT_EQUAL_INT(0, a->value);
+	TEST_ASSERT_EQUAL_size_t(1, cache.size());
+	TEST_ASSERT_EQUAL_INT(2, itemsAlive);
+}
+
+
+void test_evict() {
+	LruCache<Item, 3, 8> cache;
+	cache.add("a")->value = 1;
+	cache.add("b")->value = 2;
+	cache.add("c")->value = 3;
+	TEST_ASSERT_EQUAL_size_t(3, cache.size());
+	/* "a" becomes the most recently used one */
+	TEST_ASSERT_EQUAL_INT(1, cache.get("a")->value);
+	Item * d = cache.add("d");
+	TEST_ASSERT_EQUAL_INT(0, d->value);
+	d->value = 4;
+	TEST_ASSERT_TRUE(cache.get("b") == NULL);
+	TEST_ASSERT_EQUAL_INT(1, cache.get("a")->value);
+	TEST_ASSERT_EQUAL_INT(3, cache.get("c")->value);
+	TEST_ASSERT_EQUAL_INT(4, cache.get("d")->value);
+	/* "a" is the least recently used one now */
+	cache.add("e");
+	TEST_ASSERT_TRUE(cache.get("a") == NULL);
+	TEST_ASSERT_EQUAL_size_t(3, cache.size());
+	TEST_ASSERT_EQUAL_INT(3, itemsAlive);
+}
+
+
+void test_remove() {
+	LruCache<Item, 2, 8> cache;
+	cache.add("a")->value = 1;
+	cache.add("b")->value = 2;
+	TEST_ASSERT_TRUE(cache.remove("a"));
+	TEST_ASSERT_FALSE(cache.remove("a"));
+	TEST_ASSERT_EQUAL_size_t(1, cache.size());
+	/* the removed entry is reused before the least recently used one is replaced */
+	cache.add("c")->value = 3;
+	TEST_ASSERT_EQUAL_INT(2, cache.get("b")->value);
+	TEST_ASSERT_EQUAL_INT(3, cache.get("c")->value);
+	TEST_ASSERT_EQUAL_INT(2, itemsAlive);
+}
+
+
+/**
+ * Main entry point for all unit tests.
+ */
+int main() {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_empty);
+	RUN_TEST(test_add);
+	RUN_TEST(test_evict);
+	RUN_TEST(test_remove);
+
+	UNITY_END();
+	return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file test_main.cpp
+ * @author Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Copyright (c) 2026 Daniel Starke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <unity.h>
+#include <cstdio>
+#include <cstring>
+#include "Metrics.hpp"
+
+
+void setUp(void) {
+	/* test setup */
+}
+
+
+void tearDown(void) {
+	/* test clean-up */
+}
+
+
+void test_empty() {
+	Metric<4, 8> metric;
+	TEST_ASSERT_EQUAL_UINT32(0, metric.count());
+	TEST_ASSERT_EQUAL_UINT32(0, metric.min());
+	TEST_ASSERT_EQUAL_UINT32(0, metric.avg());
+	TEST_ASSERT_EQUAL_UINT32(0, metric.max());
+	TEST_ASSERT_EQUAL_size_t(0, metric.recentCount());
+	TEST_ASSERT_EQUAL_UINT32(0, metric.recentMin());
+	TEST_ASSERT_EQUAL_UINT32(0, metric.recentAvg());
+	TEST_ASSERT_EQUAL_UINT32(0, metric.recentMax());
+	for (size_t i = 0; i < 8; i++) {
+		TEST_ASSERT_EQUAL_UINT32(0, metric.bucket(i));
+	}
+}
+
+
+void test_samples() {
+	Metric<4, 8> metric;
+	static const uint32_t samples[] = {10, 2, 30, 4, 5, 6};
+	for (const uint32_t val : samples) {
+		metric.add(val);
+	}
+	TEST_ASSERT_EQUAL_UINT32(6, metric.count());
+	TEST_ASSERT_EQUAL_UINT32(2, metric.min());
+	TEST_ASSERT_EQUAL_UINT32(9, metric.avg());
+	TEST_ASSERT_EQUAL_UINT32(30, metric.max());
+	/* ring holds 30, 4, 5, 6 */
+	TEST_ASSERT_EQUAL_size_t(4, metric.recentCount());
+	TEST_ASSERT_EQUAL_UINT32(4, metric.recentMin());
+	TEST_ASSERT_EQUAL_UINT32(11, metric.recentAvg());
+	TEST_ASSERT_EQUAL_UINT32(30, metric.recentMax());
+	metric.reset();
+	TEST_ASSERT_EQUAL_UINT32(0, metric.count());
+	TEST_ASSERT_EQUAL_size_t(0, metric.recentCount());
+	TEST_ASSERT_EQUAL_UINT32(0, metric.bucket(4));
+}
+
+
+void test_histogram() {
+	Metric<4, 8> metric;
+	TEST_ASSERT_EQUAL_size_t(0, metric.bucketOf(0));
+	TEST_ASSERT_EQUAL_size_t(1, metric.bucketOf(1));
+	TEST_ASSERT_EQUAL_size_t(2, metric.bucketOf(2));
+	TEST_ASSERT_EQUAL_size_t(2, metric.bucketOf(3));
+	TEST_ASSERT_EQUAL_size_t(3, metric.bucketOf(4));
+	TEST_ASSERT_EQUAL_size_t(7, metric.bucketOf(64));
+	TEST_ASSERT_EQUAL_size_t(7, metric.bucketOf(4294967295UL));
+	metric.add(0);
+	metric.add(3);
+	metric.add(3);
+	metric.add(1000);
+	TEST_ASSERT_EQUAL_UINT32(1, metric.bucket(0));
+	TEST_ASSERT_EQUAL_UINT32(0, metric.bucket(1));
+	TEST_ASSERT_EQUAL_UINT32(2, metric.bucket(2));
+	TEST_ASSERT_EQUAL_UINT32(1, metric.bucket(7));
+	TEST_ASSERT_EQUAL_UINT32(0, metric.bucket(8));
+}
+
+
+void test_json() {
+	Metric<2, 4> metric;
+	metric.add(1);
+	metric.add(5);
+	metric.add(3);
+	char buf[256];
+	memset(buf, 0, sizeof(buf));
+	JsonWriter json(buf, sizeof(buf));
+	metric.toJson(json);
+	TEST_ASSERT_EQUAL_STRING("{\"count\":3,\"min\":1,\"avg\":3,\"max\":5,"
+		"\"recent\":{\"min\":3,\"avg\":4,\"max\":5},\"histogram\":[0,1,1,1]}", buf);
+}
+
+
+/**
+ * Main entry point for all unit tests.
+ */
+int main() {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_empty);
+	RUN_TEST(test_samples);
+	RUN_TEST(test_histogram);
+	RUN_TEST(test_json);
+
+	UNITY_END();
+	return 0;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file test_main.cpp
+ * @author Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Copyright (c) 2026 Daniel Starke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <unity.h>
+#include <cstdio>
+#include <cstring>
+#include "NtpManager.hpp"
+
+
+void setUp(void) {
+	/* test setup */
+}
+
+
+void tearDown(void) {
+	/* test clean-up */
+}
+
+
+void test_servers() {
+	NtpManager ntp;
+	TEST_ASSERT_EQUAL_size_t(0, ntp.servers());
+	TEST_ASSERT_EQUAL_STRING("", ntp.server());
+	TEST_ASSERT_EQUAL_size_t(1, ntp.begin("pool.ntp.org"));
+	TEST_ASSERT_EQUAL_STRING("pool.ntp.org", ntp.server());
+	TEST_ASSERT_EQUAL_size_t(3, ntp.begin("a.example,,b.example,10.0.0.1,c.example"));
+	TEST_ASSERT_EQUAL_STRING("a.example", ntp.server());
+	TEST_ASSERT_EQUAL_size_t(2, ntp.begin(" a.example ,\t, b.example"));
+	TEST_ASSERT_EQUAL_STRING("a.example", ntp.server());
+	TEST_ASSERT_EQUAL_size_t(0, ntp.begin(""));
+	TEST_ASSERT_EQUAL_STRING("", ntp.server());
+}
+
+
+void test_backoff() {
+	NtpManager ntp;
+	ntp.begin("a.example");
+	TEST_ASSERT_EQUAL_UINT32(NtpManager::MIN_INTERVAL, ntp.interval());
+	/* the first synchronization corrects the boot time */
+	ntp.synced(-1700000000, 20000);
+	TEST_ASSERT_EQUAL_UINT32(NtpManager::MIN_INTERVAL, ntp.interval());
+	/* stable synchronizations double the interval up to the maximum */
+	uint32_t expected = NtpManager::MIN_INTERVAL;
+	for (int i = 0; i < 10; i++) {
+		for (int n = 0; n < NtpManager::STABLE_SYNCS; n++) {
+			TEST_ASSERT_EQUAL_UINT32(expected, ntp.interval());
+			ntp.synced((n % 2) ? 1000 : -1000, 20000);
+		}
+		expected = (expected * 2 > NtpManager::MAX_INTERVAL) ? uint32_t(NtpManager::MAX_INTERVAL) : expected * 2;
+	}
+	TEST_ASSERT_EQUAL_UINT32(NtpManager::MAX_INTERVAL, ntp.interval());
+	/* drift halves it */
+	ntp.synced(NtpManager::DRIFT_US, 20000);
+	TEST_ASSERT_EQUAL_UINT32(NtpManager::MAX_INTERVAL / 2, ntp.interval());
+	ntp.synced(-NtpManager::DRIFT_US, 20000);
+	TEST_ASSERT_EQUAL_UINT32(NtpManager::MAX_INTERVAL / 4, ntp.interval());
+	/* a failure resets it */
+	ntp.failed();
+	TEST_ASSERT_EQUAL_UINT32(NtpManager::MIN_INTERVAL, ntp.interval());
+	TEST_ASSERT_EQUAL_UINT32(1 + (10 * NtpManager::STABLE_SYNCS) + 2, ntp.syncs());
+	TEST_ASSERT_EQUAL_UINT32(1, ntp.failures());
+	/* jitter follows the offset changes */
+	TEST_ASSERT_TRUE(ntp.jitter() > 2000);
+	for (int i = 0; i < 64; i++) {
+		ntp.synced(500, 20000);
+	}
+	TEST_ASSERT_EQUAL_UINT32(0, ntp.jitter());
+}
+
+
+void test_failover() {
+	NtpManager ntp;
+	ntp.begin("a.example,b.example");
+	for (int i = 1; i < NtpManager::FAILOVER; i++) {
+		ntp.failed();
+		TEST_ASSERT_EQUAL_STRING("a.example", ntp.server());
+	}
+	ntp.failed();
+	TEST_ASSERT_EQUAL_STRING("b.example", ntp.server());
+	/* a successful synchronization resets the failure streak */
+	for (int i = 1; i < NtpManager::FAILOVER; i++) {
+		ntp.failed();
+	}
+	ntp.synced(0, 1000);
+	ntp.failed();
+	TEST_ASSERT_EQUAL_STRING("b.example", ntp.server());
+	for (int i = 1; i < NtpManager::FAILOVER; i++) {
+		ntp.failed();
+	}
+	TEST_ASSERT_EQUAL_STRING("a.example", ntp.server());
+	/* restarting keeps the statistics */
+	ntp.begin("a.example,b.example");
+	TEST_ASSERT_EQUAL_STRING("a.example", ntp.server());
+	TEST_ASSERT_EQUAL_UINT32((3 * NtpManager::FAILOVER) - 1, ntp.failures());
+	/* a single server is kept */
+	NtpManager single;
+	single.begin("a.example");
+	for (int i = 0; i < (2 * NtpManager::FAILOVER); i++) {
+		single.failed();
+	}
+	TEST_ASSERT_EQUAL_STRING("a.example", single.server());
+}
+
+
+void test_json() {
+	NtpManager ntp;
+	ntp.begin("a.example,b.example");
+	ntp.synced(-3000, 12000);
+	ntp.synced(1000, 10000);
+	ntp.failed();
+	char buf[1024];
+	memset(buf, 0, sizeof(buf));
+	JsonWriter json(buf, sizeof(buf));
+	ntp.toJson(json);
+	TEST_ASSERT_EQUAL_STRING("{\"server\":\"a.example\",\"intervalS\":64,\"syncs\":2,\"failures\":1,\"failovers\":0,"
+		"\"lastOffsetUs\":1000,\"jitterUs\":1000,"
+		"\"offsetUs\":{\"count\":2,\"min\":1000,\"avg\":2000,\"max\":3000,"
+		"\"recent\":{\"min\":1000,\"avg\":2000,\"max\":3000},\"histogram\":[0,0,0,0,0,0,0,0,0,0,1,0,1,0,0,0]},"
+		"\"delayUs\":{\"count\":2,\"min\":10000,\"avg\":11000,\"max\":12000,"
+		"\"recent\":{\"min\":10000,\"avg\":11000,\"max\":12000},\"histogram\":[0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,0]},"
+		"\"servers\":[{\"name\":\"a.example\",\"failures\":1},{\"name\":\"b.example\",\"failures\":0}]}", buf);
+}
+
+
+/**
+ * Main entry point for all unit tests.
+ */
+int main() {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_servers);
+	RUN_TEST(test_backoff);
+	RUN_TEST(test_failover);
+	RUN_TEST(test_json);
+
+	UNITY_END();
+	return 0;
+}